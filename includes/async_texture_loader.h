@@ -0,0 +1,515 @@
+#ifndef ASYNC_TEXTURE_LOADER_H
+#define ASYNC_TEXTURE_LOADER_H
+
+#include <glad/glad.h>
+
+#include <../includes/texture_cache.h>
+#include <../includes/pixel_upload_ring.h>
+#include <../includes/texture_array.h>
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+// Loads textures without stalling the GL thread. load() returns at once with a texture holding a
+// 1x1 placeholder; a pool of worker threads decodes the files and builds their mip chains in parallel
+// (includes/mip_chain.h), and update(), called once
+// per frame on the GL thread, uploads the finished images into the textures they were requested for.
+// The texture name never changes, so whatever bound the placeholder draws the real image from the
+// frame it is uploaded on.
+//
+// update() uploads at most uploadBudget bytes per frame (always at least one image, however large),
+// so a burst of finished decodes is spread over several frames instead of making one of them long.
+// Textures go through the TextureCache: a file that is resident, or already being loaded, is shared.
+// A file that fails to decode keeps its placeholder.
+//
+// With a staging size and GL 4.4 / ARB_buffer_storage the workers build each mip chain in a
+// PixelUploadRing, and the uploads read from there: the GL thread never touches pixel memory and the
+// driver doesn't copy it. A worker whose image doesn't fit waits for the ring to drain, images larger
+// than the whole ring are uploaded from client memory.
+//
+// KTX2 files (see TextureCache) are read by the workers too, straight into staging memory, and uploaded
+// compressed - or decoded to RGBA8 on the worker when the GL lacks their format. Texture files (.gltex)
+// are mapped by the workers, which only copy them into staging memory.
+//
+// Files can be loaded into TextureArrays too: the region is placed from the file's header when it is
+// requested, shows the placeholder color, and update() uploads the image into it like into a texture.
+class AsyncTextureLoader
+{
+public:
+    // counters since the loader was created
+    struct Stats
+    {
+        unsigned int requested = 0; // files handed to the workers
+        unsigned int uploaded = 0;  // images uploaded by update()
+        unsigned int failed = 0;    // files that could not be decoded
+        unsigned int stalls = 0;    // decoded images that had to wait for staging memory
+    };
+    // what the last update() did
+    struct FrameStats
+    {
+        unsigned int uploads = 0;
+        size_t bytes = 0;
+        unsigned int stalls = 0;    // decoded images that had to wait for staging memory since the update before
+        double milliseconds = 0.0;  // time spent in update()
+    };
+
+    // workers = 0 uses one thread per core but one, leaving a core for the GL thread.
+    // stagingSize = 0 uploads from client memory
+    AsyncTextureLoader(TextureCache &cache, unsigned int workers = 0, size_t uploadBudget = 8 * 1024 * 1024,
+                       size_t stagingSize = 32 * 1024 * 1024)
+        : cache(cache), uploadBudget(uploadBudget)
+    {
+        if (stagingSize > 0 && PixelUploadRing::supported())
+            ring.reset(new PixelUploadRing(stagingSize));
+        if (workers == 0)
+        {
+            // one core is left to the GL thread. hardware_concurrency() is 0 when it can't be told
+            unsigned int cores = std::thread::hardware_concurrency();
+            workers = cores > 1 ? cores - 1 : 1;
+        }
+        for (unsigned int i = 0; i < workers; i++)
+            threads.emplace_back(&AsyncTextureLoader::work, this);
+    }
+    // stops after the decodes in progress, files still queued are dropped
+    ~AsyncTextureLoader()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            jobs.clear();
+        }
+        wake.notify_all();
+        space.notify_all();
+        for (std::thread &thread : threads)
+            thread.join();
+    }
+    AsyncTextureLoader(const AsyncTextureLoader&) = delete;
+    AsyncTextureLoader& operator=(const AsyncTextureLoader&) = delete;
+
+    // ------------------------------------------------------------------------
+    std::shared_ptr<Texture> load(const std::string &path, TextureOptions options = TextureOptions())
+    {
+        std::shared_ptr<Texture> texture = cache.find(path, options);
+        if (texture)
+            return texture;
+        texture = std::make_shared<Texture>();
+        texture->upload(placeholder, MipChain(1, 1, 4));
+        texture->channels = 0; // not loaded() until the real image is in
+        cache.insert(path, options, texture);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.push_back({ path, options, texture, nullptr, TextureRegion(), false });
+            counters.requested++;
+            inFlight++;
+        }
+        wake.notify_one();
+        return texture;
+    }
+    // the same into a layer of a texture array or onto an atlas page (includes/texture_array.h). the region
+    // is empty if the file's header can't be read. arrays must outlive the loader
+    // ------------------------------------------------------------------------
+    TextureRegion load(const std::string &path, TextureOptions options, TextureArrays &arrays)
+    {
+        TextureRegion region = arrays.find(path, options);
+        if (region.loaded())
+            return region;
+        TextureShape shape;
+        if (!arrays.probe(path, options, shape))
+        {
+            std::cout << "Texture failed to load at path: " << path << std::endl;
+            std::lock_guard<std::mutex> lock(mutex);
+            counters.failed++;
+            return region;
+        }
+        region = arrays.allocate(path, options, shape);
+        arrays.fill(region, placeholder);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.push_back({ path, options, std::weak_ptr<Texture>(), &arrays, region, shape.atlas });
+            counters.requested++;
+            inFlight++;
+        }
+        wake.notify_one();
+        return region;
+    }
+    // upload finished decodes within the per-frame budget. call once per frame on the GL thread,
+    // returns the number of textures that got their image
+    // ------------------------------------------------------------------------
+    unsigned int update()
+    {
+        auto start = std::chrono::steady_clock::now();
+        FrameStats frame;
+        if (ring && ring->retire() > 0)
+            space.notify_all();
+        std::vector<Decoded> ready;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            frame.stalls = stalls;
+            stalls = 0;
+            size_t bytes = 0;
+            while (!decoded.empty() && (ready.empty() || bytes + decoded.front().bytes() <= uploadBudget))
+            {
+                bytes += decoded.front().bytes();
+                ready.push_back(std::move(decoded.front()));
+                decoded.pop_front();
+            }
+        }
+        unsigned int uploaded = 0;
+        for (Decoded &image : ready)
+        {
+            std::shared_ptr<Texture> texture = image.texture.lock();
+            if (texture || image.arrays) // nobody may want a texture anymore, array regions stay
+            {
+                const unsigned char *levels = image.mapped ? image.mapped->data() : image.pixels.data();
+                if (image.arrays)
+                    uploadRegion(image, levels);
+                else if (!image.blocks.empty() && image.staging)
+                    ring->upload(*texture, image.staging, image.format, image.blocks);
+                else if (!image.blocks.empty())
+                    texture->upload(levels, image.format, image.blocks);
+                else if (image.staging)
+                    ring->upload(*texture, image.staging, image.chain, image.rowAlignment);
+                else
+                    texture->upload(levels, image.chain, image.rowAlignment);
+                uploaded++;
+                frame.bytes += image.bytes();
+            }
+            else if (image.staging)
+                ring->discard(image.staging);
+        }
+        if (!ready.empty())
+            glBindTexture(GL_TEXTURE_2D, 0);
+        frame.uploads = uploaded;
+        frame.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::lock_guard<std::mutex> lock(mutex);
+        counters.uploaded += uploaded;
+        inFlight -= (unsigned int)ready.size();
+        lastFrameStats = frame;
+        return uploaded;
+    }
+    // files queued, being decoded or waiting for their upload
+    // ------------------------------------------------------------------------
+    unsigned int pending()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return inFlight;
+    }
+    bool idle()
+    {
+        return pending() == 0;
+    }
+    // block until every requested file is uploaded (or failed), ignoring the budget. for loading screens
+    // ------------------------------------------------------------------------
+    void finish()
+    {
+        size_t budget = uploadBudget;
+        uploadBudget = (size_t)-1;
+        while (!idle())
+        {
+            if (update() == 0)
+                std::this_thread::yield();
+        }
+        uploadBudget = budget;
+    }
+    Stats stats()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return counters;
+    }
+    FrameStats lastFrame()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return lastFrameStats;
+    }
+    // the staging ring, null when uploads come from client memory. its stats() has the upload throughput
+    PixelUploadRing* stagingRing()
+    {
+        return ring.get();
+    }
+    void setUploadBudget(size_t bytes)
+    {
+        uploadBudget = bytes;
+    }
+    // the color textures show until they are loaded, RGBA8
+    void setPlaceholder(unsigned char r, unsigned char g, unsigned char b, unsigned char a = 255)
+    {
+        placeholder[0] = r;
+        placeholder[1] = g;
+        placeholder[2] = b;
+        placeholder[3] = a;
+    }
+
+private:
+    struct Job
+    {
+        std::string path;
+        TextureOptions options;
+        std::weak_ptr<Texture> texture;
+        TextureArrays *arrays = nullptr; // or a region of these
+        TextureRegion region;
+        bool atlas = false;              // the region is on an atlas page, the image is padded for it
+
+        // whether anybody still wants the image
+        bool wanted() const
+        {
+            return arrays || !texture.expired();
+        }
+    };
+    struct Decoded
+    {
+        std::weak_ptr<Texture> texture;
+        TextureArrays *arrays = nullptr;
+        TextureRegion region;
+        MipChain chain;
+        BlockFormat format = BLOCK_BC1;
+        std::vector<MipLevel> blocks;      // the levels of a file uploaded compressed, chain is unused then
+        int rowAlignment = 1;
+        PixelUploadRing::Staging staging;
+        std::vector<unsigned char> pixels; // the levels, when they are not in staging
+        std::shared_ptr<TextureFile> mapped; // or in a mapped texture file
+
+        size_t bytes() const
+        {
+            return blocks.empty() ? chain.size : blocks.back().offset + blocks.back().size;
+        }
+    };
+
+    TextureCache &cache;
+    size_t uploadBudget;
+    std::unique_ptr<PixelUploadRing> ring;
+    unsigned char placeholder[4] = { 128, 128, 128, 255 };
+
+    // guarded by mutex
+    std::deque<Job> jobs;
+    std::deque<Decoded> decoded;
+    unsigned int inFlight = 0;
+    bool stopping = false;
+    unsigned int stalls = 0;
+    Stats counters;
+    FrameStats lastFrameStats;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable space; // the ring handed blocks back
+    std::vector<std::thread> threads;
+
+    // ------------------------------------------------------------------------
+    void work()
+    {
+        for (;;)
+        {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this] { return stopping || !jobs.empty(); });
+                if (stopping)
+                    return;
+                job = jobs.front();
+                jobs.pop_front();
+            }
+            Decoded image;
+            image.texture = job.texture;
+            image.arrays = job.arrays;
+            image.region = job.region;
+            bool stop = false;
+            bool done = false;
+            if (job.wanted()) // released before its turn came, don't bother
+            {
+                if (TextureCache::compressed(job.path))
+                    done = readCompressed(job, image, stop);
+                else if (TextureCache::packed(job.path))
+                    done = readPacked(job, image, stop);
+                else
+                    done = decode(job, image, stop);
+            }
+            if (stop)
+                return;
+            if (done)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                decoded.push_back(std::move(image));
+                continue;
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (job.wanted())
+            {
+                std::cout << "Texture failed to load at path: " << job.path << std::endl;
+                counters.failed++;
+            }
+            inFlight--;
+        }
+    }
+    // decode an image file and build its mip chain, straight into staging memory when there is room.
+    // stop is set if the loader is stopping
+    // ------------------------------------------------------------------------
+    bool decode(const Job &job, Decoded &image, bool &stop)
+    {
+        // every request sets the flip flag of its own thread, so concurrent decodes don't race on it
+        stbi_set_flip_vertically_on_load_thread(job.options.flip);
+        int width = 0, height = 0, nrComponents = 0;
+        unsigned char *data = stbi_load(job.path.c_str(), &width, &height, &nrComponents, job.options.channels);
+        if (!data)
+            return false;
+        int channels = job.options.channels ? job.options.channels : nrComponents;
+        image.chain = job.atlas ? TextureArrays::atlasChain(width, height, channels) : MipChain(width, height, channels);
+        // an image for an atlas page is mipmapped with its padding
+        std::vector<unsigned char> padded;
+        if (job.atlas)
+        {
+            padded.resize(image.chain.levels[0].size);
+            TextureArrays::pad(data, width, height, channels, padded.data());
+            stbi_image_free(data);
+            data = nullptr;
+        }
+        if (!stage(image.chain.size, image.staging))
+        {
+            stbi_image_free(data);
+            stop = true;
+            return false;
+        }
+        if (!image.staging)
+            image.pixels.resize(image.chain.size);
+        image.chain.build(job.atlas ? padded.data() : data, image.staging ? image.staging.pixels : image.pixels.data(),
+                          TextureCache::mipOptions(job.options));
+        stbi_image_free(data);
+        return true;
+    }
+    // read a KTX2 file: its blocks go to the GPU as they are, or are decoded here to RGBA8 if the GL
+    // lacks the format
+    // ------------------------------------------------------------------------
+    bool readCompressed(const Job &job, Decoded &image, bool &stop)
+    {
+        Ktx2File file;
+        if (!TextureCache::openCompressed(file, job.path, job.options))
+            return false;
+        std::vector<unsigned char> blocks;
+        size_t bytes = file.size;
+        if (Texture::compressedSupported(file.format))
+        {
+            image.format = file.format;
+            image.blocks = file.levels;
+        }
+        else
+        {
+            image.chain = TextureCache::decodedChain(file.levels);
+            bytes = image.chain.size;
+            blocks.resize(file.size);
+            if (!file.read(blocks.data()))
+                return false;
+        }
+        if (!stage(bytes, image.staging))
+        {
+            stop = true;
+            return false;
+        }
+        unsigned char *out = image.staging.pixels;
+        if (!image.staging)
+        {
+            image.pixels.resize(bytes);
+            out = image.pixels.data();
+        }
+        if (blocks.empty())
+        {
+            if (file.read(out))
+                return true;
+            if (image.staging)
+                ring->discard(image.staging);
+            return false;
+        }
+        TextureCache::decodeLevels(file.format, file.levels, blocks.data(), out);
+        return true;
+    }
+    // map a texture file (includes/texture_file.h). its texels are copied from the mapping to staging
+    // memory here, or uploaded from the mapping itself when there is no ring
+    // ------------------------------------------------------------------------
+    bool readPacked(const Job &job, Decoded &image, bool &stop)
+    {
+        std::shared_ptr<TextureFile> file = std::make_shared<TextureFile>();
+        if (!TextureCache::openPacked(*file, job.path, job.options))
+            return false;
+        bool decode = file->compressed && !Texture::compressedSupported(file->format);
+        if (decode)
+            image.chain = TextureCache::decodedChain(file->layout.levels);
+        else if (file->compressed)
+        {
+            image.format = file->format;
+            image.blocks = file->layout.levels;
+        }
+        else
+        {
+            image.chain = file->layout;
+            image.rowAlignment = TextureFile::ROW_ALIGNMENT;
+        }
+        size_t bytes = decode ? image.chain.size : file->layout.size;
+        if (!stage(bytes, image.staging))
+        {
+            stop = true;
+            return false;
+        }
+        if (!image.staging && !decode)
+        {
+            image.mapped = file;
+            return true;
+        }
+        unsigned char *out = image.staging.pixels;
+        if (!image.staging)
+        {
+            image.pixels.resize(bytes);
+            out = image.pixels.data();
+        }
+        if (decode)
+            TextureCache::decodeLevels(file->format, file->layout.levels, file->data(), out);
+        else
+            std::memcpy(out, file->data(), bytes);
+        return true;
+    }
+    // upload a finished image into its texture array region, from staging memory or levels
+    // ------------------------------------------------------------------------
+    void uploadRegion(const Decoded &image, const unsigned char *levels)
+    {
+        auto define = [&](const unsigned char *pixels) {
+            if (image.blocks.empty())
+                image.arrays->upload(image.region, pixels, image.chain, image.rowAlignment);
+            else
+                image.arrays->upload(image.region, pixels, image.blocks);
+        };
+        if (image.staging)
+            ring->issue(image.staging, define);
+        else
+            define(levels);
+    }
+    // reserve staging memory, waiting for space if the ring is full. leaves staging empty when there is
+    // no ring or the bytes can never fit, returns false if the loader is stopping
+    // ------------------------------------------------------------------------
+    bool stage(size_t bytes, PixelUploadRing::Staging &staging)
+    {
+        if (!ring || !ring->fits(bytes))
+            return true;
+        bool waited = false;
+        while (!(staging = ring->reserve(bytes)))
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (stopping)
+                return false;
+            if (!waited)
+            {
+                stalls++;
+                counters.stalls++;
+            }
+            waited = true;
+            // update() retires blocks once a frame, the timeout covers a notify that came before the wait
+            space.wait_for(lock, std::chrono::milliseconds(5));
+        }
+        return true;
+    }
+};
+#endif
@@ -0,0 +1,171 @@
+#ifndef AUTOTUNER_H
+#define AUTOTUNER_H
+
+#include <glad/glad.h>
+
+#include <string>
+#include <vector>
+#include <map>
+#include <utility>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <functional>
+#include <cstdio>
+#include <cstdlib>
+
+// Picks between alternative implementations of the same thing (shader variants, compute work-group
+// sizes, ...) by timing them on the GPU the program runs on. The first run on a device benchmarks
+// every alternative of a decision with GL_TIME_ELAPSED queries and remembers the fastest; later runs
+// on a device with the same GL_RENDERER string reuse that choice without measuring anything.
+//
+// Winners are stored as "renderer<TAB>decision<TAB>alternative" lines in AUTOTUNE_FILE (autotune.txt
+// by default, an empty string keeps them in memory only), so one file can serve several machines.
+// Delete a line, or the file, to benchmark again.
+class Autotuner
+{
+public:
+    Autotuner()
+        : path(filePath()), device(renderer())
+    {
+        load();
+    }
+    // index of the alternative to use for a decision. workload(i) must issue the GPU work of
+    // alternative i; it is run once untimed and then rounds times timed, and must not start
+    // GL_TIME_ELAPSED queries of its own. alternatives are named so the stored choice survives
+    // reordering, a stored name that is no longer offered is benchmarked again
+    // ------------------------------------------------------------------------
+    int choose(const std::string &decision, const std::vector<std::string> &alternatives,
+               const std::function<void(int)> &workload, unsigned int rounds = 5)
+    {
+        timings.clear();
+        if (alternatives.empty())
+            return -1;
+        auto stored = winners.find({ device, decision });
+        if (stored != winners.end())
+        {
+            auto found = std::find(alternatives.begin(), alternatives.end(), stored->second);
+            if (found != alternatives.end())
+                return (int)(found - alternatives.begin());
+        }
+        if (alternatives.size() == 1)
+            return 0;
+
+        timings = measure((int)alternatives.size(), workload, rounds > 0 ? rounds : 1);
+        int best = (int)(std::min_element(timings.begin(), timings.end()) - timings.begin());
+        winners[{ device, decision }] = alternatives[best];
+        save();
+        return best;
+    }
+    // the stored alternative for a decision on this device, empty if it hasn't been tuned yet
+    // ------------------------------------------------------------------------
+    std::string winner(const std::string &decision) const
+    {
+        auto found = winners.find({ device, decision });
+        return found == winners.end() ? std::string() : found->second;
+    }
+    // drop the stored choice so the next choose() measures again
+    void forget(const std::string &decision)
+    {
+        winners.erase({ device, decision });
+        save();
+    }
+    // median GPU time in milliseconds of every alternative in the last choose() that had to
+    // benchmark, empty when the choice came from the file
+    const std::vector<double>& lastTimings() const
+    {
+        return timings;
+    }
+    // ------------------------------------------------------------------------
+    static std::string renderer()
+    {
+        const char *name = reinterpret_cast<const char *>(glGetString(GL_RENDERER));
+        return name ? std::string(name) : std::string("unknown");
+    }
+
+private:
+    std::string path;
+    std::string device;
+    // (renderer, decision) -> alternative, every device in the file so saving keeps the others
+    std::map<std::pair<std::string, std::string>, std::string> winners;
+    std::vector<double> timings;
+
+    // ------------------------------------------------------------------------
+    static std::string filePath()
+    {
+        const char *file = std::getenv("AUTOTUNE_FILE");
+        return file ? std::string(file) : std::string("autotune.txt");
+    }
+    // time every alternative, interleaved round by round so clock changes hit all of them alike
+    // ------------------------------------------------------------------------
+    static std::vector<double> measure(int count, const std::function<void(int)> &workload, unsigned int rounds)
+    {
+        // the first run pays for compiling, linking and first-use uploads, none of which should count
+        for (int i = 0; i < count; i++)
+            workload(i);
+        glFinish();
+
+        std::vector<GLuint> queries(count * rounds);
+        glGenQueries((GLsizei)queries.size(), queries.data());
+        for (unsigned int round = 0; round < rounds; round++)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                glBeginQuery(GL_TIME_ELAPSED, queries[round * count + i]);
+                workload(i);
+                glEndQuery(GL_TIME_ELAPSED);
+            }
+        }
+        std::vector<double> medians;
+        for (int i = 0; i < count; i++)
+        {
+            std::vector<double> samples;
+            for (unsigned int round = 0; round < rounds; round++)
+            {
+                GLuint64 elapsed = 0;
+                glGetQueryObjectui64v(queries[round * count + i], GL_QUERY_RESULT, &elapsed); // waits for the GPU
+                samples.push_back(elapsed / 1.0e6);
+            }
+            std::sort(samples.begin(), samples.end());
+            medians.push_back(samples[samples.size() / 2]);
+        }
+        glDeleteQueries((GLsizei)queries.size(), queries.data());
+        return medians;
+    }
+    // ------------------------------------------------------------------------
+    void load()
+    {
+        if (path.empty())
+            return;
+        std::ifstream file(path);
+        std::string line;
+        while (std::getline(file, line))
+        {
+            size_t first = line.find('\t');
+            size_t second = first == std::string::npos ? first : line.find('\t', first + 1);
+            if (second == std::string::npos)
+                continue;
+            winners[{ line.substr(0, first), line.substr(first + 1, second - first - 1) }] = line.substr(second + 1);
+        }
+    }
+    // write to a temporary name first so a concurrent launch never reads half a file
+    // ------------------------------------------------------------------------
+    void save() const
+    {
+        if (path.empty())
+            return;
+        std::string tempPath = path + ".tmp";
+        {
+            std::ofstream file(tempPath, std::ios::trunc);
+            if (!file)
+            {
+                std::cout << "ERROR::AUTOTUNER::FILE_NOT_WRITTEN: " << path << std::endl;
+                return;
+            }
+            for (const auto &entry : winners)
+                file << entry.first.first << '\t' << entry.first.second << '\t' << entry.second << '\n';
+        }
+        std::rename(tempPath.c_str(), path.c_str());
+    }
+};
+#endif
@@ -0,0 +1,780 @@
+#ifndef BLOCK_COMPRESSION_H
+#define BLOCK_COMPRESSION_H
+
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define BLOCK_COMPRESSION_SSE2
+#include <emmintrin.h>
+#endif
+
+// the block compressed formats the encoder writes and the fallback decoder reads. every format stores
+// 4x4 texel blocks; which channels they hold matches the uncompressed upload they replace
+enum BlockFormat
+{
+    BLOCK_BC1, // RGB, 8 bytes per block - GL_RGB textures
+    BLOCK_BC3, // RGBA, 16 bytes: BC1 color plus a BC4 style alpha block - GL_RGBA textures
+    BLOCK_BC4, // R, 8 bytes - GL_RED textures
+    BLOCK_BC5, // RG, 16 bytes: two BC4 blocks - GL_RG textures
+    BLOCK_BC7  // RGBA, 16 bytes, higher quality than BC3. written as mode 6 blocks only
+};
+
+// Encodes and decodes 4x4 blocks of the BCn formats. Encoding is what tools/texture_compress.cpp runs
+// offline; decoding is the runtime fallback for a GPU without the format, so both live here.
+//
+// Blocks are encoded from 16 RGBA texels (missing channels as GL fills them: 0 for color, 255 for
+// alpha). The endpoints of a block are fitted along the principal axis of its colors, refined by a
+// least squares pass for BC1, and every texel takes the nearest palette entry - 4 texels at a time with
+// SSE2 where the CPU has it, the scalar loop gives the same indices.
+//
+// BC7 is encoded as mode 6 (one subset, RGBA endpoints with a p-bit, 4-bit indices). Decoding takes
+// every mode, so KTX2 files from other encoders fall back to RGBA8 as well.
+class BlockCodec
+{
+public:
+    static int blockBytes(BlockFormat format)
+    {
+        return format == BLOCK_BC1 || format == BLOCK_BC4 ? 8 : 16;
+    }
+    // channels of the uncompressed texture the format stands in for
+    static int channels(BlockFormat format)
+    {
+        switch (format)
+        {
+        case BLOCK_BC1:
+            return 3;
+        case BLOCK_BC4:
+            return 1;
+        case BLOCK_BC5:
+            return 2;
+        default:
+            return 4;
+        }
+    }
+    static const char* name(BlockFormat format)
+    {
+        static const char *names[] = { "bc1", "bc3", "bc4", "bc5", "bc7" };
+        return names[format];
+    }
+    static size_t imageBytes(BlockFormat format, int width, int height)
+    {
+        return (size_t)((width + 3) / 4) * ((height + 3) / 4) * blockBytes(format);
+    }
+
+    // ------------------------------------------------------------------------
+    static void encodeBlock(BlockFormat format, const unsigned char *rgba, unsigned char *out)
+    {
+        switch (format)
+        {
+        case BLOCK_BC1:
+            encodeColor(rgba, out);
+            break;
+        case BLOCK_BC3:
+            encodeSingle(rgba, 3, out);
+            encodeColor(rgba, out + 8);
+            break;
+        case BLOCK_BC4:
+            encodeSingle(rgba, 0, out);
+            break;
+        case BLOCK_BC5:
+            encodeSingle(rgba, 0, out);
+            encodeSingle(rgba, 1, out + 8);
+            break;
+        case BLOCK_BC7:
+            encodeMode6(rgba, out);
+            break;
+        }
+    }
+    // 16 RGBA texels out. false for a BC7 block in the reserved mode
+    // ------------------------------------------------------------------------
+    static bool decodeBlock(BlockFormat format, const unsigned char *block, unsigned char *rgba)
+    {
+        for (int i = 0; i < 16; i++)
+        {
+            rgba[i * 4 + 0] = rgba[i * 4 + 1] = rgba[i * 4 + 2] = 0;
+            rgba[i * 4 + 3] = 255;
+        }
+        switch (format)
+        {
+        case BLOCK_BC1:
+            decodeColor(block, rgba, false);
+            return true;
+        case BLOCK_BC3:
+            decodeColor(block + 8, rgba, true);
+            decodeSingle(block, 3, rgba);
+            return true;
+        case BLOCK_BC4:
+            decodeSingle(block, 0, rgba);
+            return true;
+        case BLOCK_BC5:
+            decodeSingle(block, 0, rgba);
+            decodeSingle(block + 8, 1, rgba);
+            return true;
+        case BLOCK_BC7:
+            return decodeBc7(block, rgba);
+        }
+        return false;
+    }
+
+    // compress a tightly packed image of 1..4 channels. blocks over the edge repeat the last row and
+    // column. the rows of blocks are shared out between threads (0 = one per core)
+    // ------------------------------------------------------------------------
+    static void encodeImage(BlockFormat format, const unsigned char *pixels, int width, int height, int channels,
+                            unsigned char *out, unsigned int threads = 0)
+    {
+        int blocksWide = (width + 3) / 4;
+        int blocksHigh = (height + 3) / 4;
+        auto encodeRows = [=](int firstRow, int lastRow) {
+            unsigned char rgba[64];
+            for (int by = firstRow; by < lastRow; by++)
+            {
+                for (int bx = 0; bx < blocksWide; bx++)
+                {
+                    for (int i = 0; i < 16; i++)
+                    {
+                        int x = std::min(bx * 4 + i % 4, width - 1);
+                        int y = std::min(by * 4 + i / 4, height - 1);
+                        const unsigned char *texel = pixels + ((size_t)y * width + x) * channels;
+                        unsigned char *slot = rgba + i * 4;
+                        slot[0] = slot[1] = slot[2] = 0;
+                        slot[3] = 255;
+                        for (int c = 0; c < channels; c++)
+                            slot[c] = texel[c];
+                    }
+                    encodeBlock(format, rgba, out + ((size_t)by * blocksWide + bx) * blockBytes(format));
+                }
+            }
+        };
+        if (threads == 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        threads = std::min<unsigned int>(threads, (unsigned int)blocksHigh);
+        if (threads <= 1)
+        {
+            encodeRows(0, blocksHigh);
+            return;
+        }
+        std::vector<std::thread> workers;
+        for (unsigned int t = 0; t < threads; t++)
+            workers.emplace_back(encodeRows, (int)(blocksHigh * t / threads), (int)(blocksHigh * (t + 1) / threads));
+        for (std::thread &worker : workers)
+            worker.join();
+    }
+    // decompress into a tightly packed RGBA8 image, channels the format lacks as GL would sample them.
+    // false if a block couldn't be decoded
+    // ------------------------------------------------------------------------
+    static bool decodeImage(BlockFormat format, const unsigned char *blocks, int width, int height, unsigned char *out)
+    {
+        int blocksWide = (width + 3) / 4;
+        int blocksHigh = (height + 3) / 4;
+        bool decoded = true;
+        unsigned char rgba[64];
+        for (int by = 0; by < blocksHigh; by++)
+        {
+            for (int bx = 0; bx < blocksWide; bx++)
+            {
+                decoded &= decodeBlock(format, blocks + ((size_t)by * blocksWide + bx) * blockBytes(format), rgba);
+                for (int i = 0; i < 16; i++)
+                {
+                    int x = bx * 4 + i % 4;
+                    int y = by * 4 + i / 4;
+                    if (x < width && y < height)
+                        std::memcpy(out + ((size_t)y * width + x) * 4, rgba + i * 4, 4);
+                }
+            }
+        }
+        return decoded;
+    }
+
+private:
+    // ------------------------------------------------------------------------
+    // BC1 color: two RGB565 endpoints and a 2-bit index per texel
+    // ------------------------------------------------------------------------
+    static int expand5(int value)
+    {
+        return (value << 3) | (value >> 2);
+    }
+    static int expand6(int value)
+    {
+        return (value << 2) | (value >> 4);
+    }
+    static std::uint16_t pack565(const float *color)
+    {
+        int r = (int)std::lround(std::min(std::max(color[0], 0.0f), 255.0f) * 31.0f / 255.0f);
+        int g = (int)std::lround(std::min(std::max(color[1], 0.0f), 255.0f) * 63.0f / 255.0f);
+        int b = (int)std::lround(std::min(std::max(color[2], 0.0f), 255.0f) * 31.0f / 255.0f);
+        return (std::uint16_t)((r << 11) | (g << 5) | b);
+    }
+    static void unpack565(std::uint16_t packed, int *color)
+    {
+        color[0] = expand5(packed >> 11);
+        color[1] = expand6((packed >> 5) & 63);
+        color[2] = expand5(packed & 31);
+    }
+    // the four colors of a 4 color block, palette[i * 4 + c]
+    static void colorPalette(std::uint16_t c0, std::uint16_t c1, int *palette)
+    {
+        unpack565(c0, palette);
+        unpack565(c1, palette + 4);
+        for (int c = 0; c < 3; c++)
+        {
+            palette[8 + c] = (2 * palette[c] + palette[4 + c]) / 3;
+            palette[12 + c] = (palette[c] + 2 * palette[4 + c]) / 3;
+        }
+    }
+    // the principal axis of n-channel texels by power iteration, and their mean
+    static void principalAxis(const unsigned char *rgba, int n, float *mean, float *axis)
+    {
+        float covariance[16] = {};
+        for (int c = 0; c < n; c++)
+        {
+            mean[c] = 0.0f;
+            for (int i = 0; i < 16; i++)
+                mean[c] += rgba[i * 4 + c];
+            mean[c] /= 16.0f;
+        }
+        for (int i = 0; i < 16; i++)
+            for (int a = 0; a < n; a++)
+                for (int b = 0; b < n; b++)
+                    covariance[a * 4 + b] += (rgba[i * 4 + a] - mean[a]) * (rgba[i * 4 + b] - mean[b]);
+        for (int c = 0; c < n; c++)
+            axis[c] = 1.0f;
+        for (int iteration = 0; iteration < 8; iteration++)
+        {
+            float next[4] = {};
+            float length = 0.0f;
+            for (int a = 0; a < n; a++)
+            {
+                for (int b = 0; b < n; b++)
+                    next[a] += covariance[a * 4 + b] * axis[b];
+                length = std::max(length, std::fabs(next[a]));
+            }
+            if (length == 0.0f)
+                return; // a flat block, any axis will do
+            for (int c = 0; c < n; c++)
+                axis[c] = next[c] / length;
+        }
+    }
+    // endpoints spanning the texels' projections on the axis
+    static void fitEndpoints(const unsigned char *rgba, int n, float *high, float *low)
+    {
+        float mean[4], axis[4];
+        principalAxis(rgba, n, mean, axis);
+        float lengthSquared = 0.0f;
+        for (int c = 0; c < n; c++)
+            lengthSquared += axis[c] * axis[c];
+        float lowest = 0.0f, highest = 0.0f;
+        for (int i = 0; i < 16; i++)
+        {
+            float t = 0.0f;
+            for (int c = 0; c < n; c++)
+                t += (rgba[i * 4 + c] - mean[c]) * axis[c];
+            t /= lengthSquared;
+            lowest = std::min(lowest, t);
+            highest = std::max(highest, t);
+        }
+        for (int c = 0; c < n; c++)
+        {
+            high[c] = mean[c] + axis[c] * highest;
+            low[c] = mean[c] + axis[c] * lowest;
+        }
+    }
+#ifdef BLOCK_COMPRESSION_SSE2
+    static __m128i absolute(__m128i value)
+    {
+        __m128i sign = _mm_srai_epi32(value, 31);
+        return _mm_sub_epi32(_mm_xor_si128(value, sign), sign);
+    }
+#endif
+    // nearest palette entry for every texel, comparing the first channels (3 or 4) of the texels and of
+    // palette[entry * 4 + c]. returns the summed squared error
+    static int chooseIndices(const unsigned char *rgba, const int *palette, int entries, int channels, int *indices)
+    {
+#ifdef BLOCK_COMPRESSION_SSE2
+        int error = 0;
+        for (int group = 0; group < 4; group++)
+        {
+            // 4 texels at once, the channels in separate registers
+            const unsigned char *t = rgba + group * 16;
+            __m128i texels[4];
+            for (int c = 0; c < channels; c++)
+                texels[c] = _mm_setr_epi32(t[c], t[4 + c], t[8 + c], t[12 + c]);
+            __m128i best = _mm_set1_epi32(0x7fffffff);
+            __m128i bestIndex = _mm_setzero_si128();
+            for (int entry = 0; entry < entries; entry++)
+            {
+                __m128i distance = _mm_setzero_si128();
+                for (int c = 0; c < channels; c++)
+                {
+                    // below 256 with a zero upper half, so madd squares it exactly
+                    __m128i d = absolute(_mm_sub_epi32(texels[c], _mm_set1_epi32(palette[entry * 4 + c])));
+                    distance = _mm_add_epi32(distance, _mm_madd_epi16(d, d));
+                }
+                __m128i closer = _mm_cmplt_epi32(distance, best);
+                best = _mm_or_si128(_mm_and_si128(closer, distance), _mm_andnot_si128(closer, best));
+                bestIndex = _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi32(entry)), _mm_andnot_si128(closer, bestIndex));
+            }
+            int distances[4];
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(distances), best);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(indices + group * 4), bestIndex);
+            error += distances[0] + distances[1] + distances[2] + distances[3];
+        }
+        return error;
+#else
+        return chooseIndicesScalar(rgba, palette, entries, channels, indices);
+#endif
+    }
+    static int chooseIndicesScalar(const unsigned char *rgba, const int *palette, int entries, int channels, int *indices)
+    {
+        int error = 0;
+        for (int i = 0; i < 16; i++)
+        {
+            int best = 0x7fffffff;
+            for (int entry = 0; entry < entries; entry++)
+            {
+                int distance = 0;
+                for (int c = 0; c < channels; c++)
+                {
+                    int d = rgba[i * 4 + c] - palette[entry * 4 + c];
+                    distance += d * d;
+                }
+                if (distance < best)
+                {
+                    best = distance;
+                    indices[i] = entry;
+                }
+            }
+            error += best;
+        }
+        return error;
+    }
+    // least squares endpoints for fixed indices, false if the indices don't constrain them
+    static bool refitColor(const unsigned char *rgba, const int *indices, float *high, float *low)
+    {
+        static const float weights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+        float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+        float ax[3] = {}, bx[3] = {};
+        for (int i = 0; i < 16; i++)
+        {
+            float a = weights[indices[i]];
+            float b = 1.0f - a;
+            aa += a * a;
+            ab += a * b;
+            bb += b * b;
+            for (int c = 0; c < 3; c++)
+            {
+                ax[c] += a * rgba[i * 4 + c];
+                bx[c] += b * rgba[i * 4 + c];
+            }
+        }
+        float determinant = aa * bb - ab * ab;
+        if (std::fabs(determinant) < 1e-6f)
+            return false;
+        for (int c = 0; c < 3; c++)
+        {
+            high[c] = (ax[c] * bb - bx[c] * ab) / determinant;
+            low[c] = (bx[c] * aa - ax[c] * ab) / determinant;
+        }
+        return true;
+    }
+    static int tryColorEndpoints(const unsigned char *rgba, const float *high, const float *low,
+                                 std::uint16_t &c0, std::uint16_t &c1, int *indices)
+    {
+        c0 = pack565(high);
+        c1 = pack565(low);
+        int palette[16];
+        colorPalette(c0, c1, palette);
+        return chooseIndices(rgba, palette, 4, 3, indices);
+    }
+    static void encodeColor(const unsigned char *rgba, unsigned char *out)
+    {
+        float high[3], low[3];
+        fitEndpoints(rgba, 3, high, low);
+        std::uint16_t c0, c1;
+        int indices[16];
+        int error = tryColorEndpoints(rgba, high, low, c0, c1, indices);
+        if (error > 0 && refitColor(rgba, indices, high, low))
+        {
+            std::uint16_t r0, r1;
+            int refined[16];
+            if (tryColorEndpoints(rgba, high, low, r0, r1, refined) < error)
+            {
+                c0 = r0;
+                c1 = r1;
+                std::memcpy(indices, refined, sizeof(refined));
+            }
+        }
+        // c0 > c1 selects the 4 color mode, the one the palette was made for
+        if (c0 < c1)
+        {
+            std::swap(c0, c1);
+            static const int swapped[4] = { 1, 0, 3, 2 };
+            for (int &index : indices)
+                index = swapped[index];
+        }
+        else if (c0 == c1)
+            std::fill(indices, indices + 16, 0);
+
+        std::uint32_t bits = 0;
+        for (int i = 0; i < 16; i++)
+            bits |= (std::uint32_t)indices[i] << (2 * i);
+        out[0] = (unsigned char)(c0 & 0xff);
+        out[1] = (unsigned char)(c0 >> 8);
+        out[2] = (unsigned char)(c1 & 0xff);
+        out[3] = (unsigned char)(c1 >> 8);
+        for (int i = 0; i < 4; i++)
+            out[4 + i] = (unsigned char)(bits >> (8 * i));
+    }
+    // alwaysFourColors: the color half of a BC3 block ignores the endpoint order
+    static void decodeColor(const unsigned char *block, unsigned char *rgba, bool alwaysFourColors)
+    {
+        std::uint16_t c0 = (std::uint16_t)(block[0] | (block[1] << 8));
+        std::uint16_t c1 = (std::uint16_t)(block[2] | (block[3] << 8));
+        int palette[16];
+        colorPalette(c0, c1, palette);
+        palette[3] = palette[7] = palette[11] = palette[15] = 255;
+        if (c0 <= c1 && !alwaysFourColors)
+        {
+            for (int c = 0; c < 3; c++)
+            {
+                palette[8 + c] = (palette[c] + palette[4 + c]) / 2;
+                palette[12 + c] = 0;
+            }
+            palette[15] = 0; // transparent black
+        }
+        std::uint32_t bits = block[4] | (block[5] << 8) | (block[6] << 16) | ((std::uint32_t)block[7] << 24);
+        for (int i = 0; i < 16; i++)
+        {
+            int index = (bits >> (2 * i)) & 3;
+            for (int c = 0; c < 3; c++)
+                rgba[i * 4 + c] = (unsigned char)palette[index * 4 + c];
+            if (!alwaysFourColors)
+                rgba[i * 4 + 3] = (unsigned char)palette[index * 4 + 3];
+        }
+    }
+
+    // ------------------------------------------------------------------------
+    // BC4: one channel, two 8-bit endpoints and a 3-bit index per texel
+    // ------------------------------------------------------------------------
+    static void singlePalette(int e0, int e1, int *palette)
+    {
+        palette[0] = e0;
+        palette[1] = e1;
+        if (e0 > e1)
+        {
+            for (int i = 1; i < 7; i++)
+                palette[i + 1] = ((7 - i) * e0 + i * e1 + 3) / 7;
+        }
+        else
+        {
+            for (int i = 1; i < 5; i++)
+                palette[i + 1] = ((5 - i) * e0 + i * e1 + 2) / 5;
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+    }
+    static void encodeSingle(const unsigned char *rgba, int channel, unsigned char *out)
+    {
+        int lowest = 255, highest = 0;
+        for (int i = 0; i < 16; i++)
+        {
+            lowest = std::min(lowest, (int)rgba[i * 4 + channel]);
+            highest = std::max(highest, (int)rgba[i * 4 + channel]);
+        }
+        int palette[8];
+        singlePalette(highest, lowest, palette);
+        std::uint64_t bits = 0;
+        for (int i = 0; i < 16; i++)
+        {
+            int value = rgba[i * 4 + channel];
+            int index = 0;
+            int best = 256;
+            for (int entry = 0; entry < 8 && highest != lowest; entry++)
+            {
+                int distance = std::abs(value - palette[entry]);
+                if (distance < best)
+                {
+                    best = distance;
+                    index = entry;
+                }
+            }
+            bits |= (std::uint64_t)index << (3 * i);
+        }
+        out[0] = (unsigned char)highest;
+        out[1] = (unsigned char)lowest;
+        for (int i = 0; i < 6; i++)
+            out[2 + i] = (unsigned char)(bits >> (8 * i));
+    }
+    static void decodeSingle(const unsigned char *block, int channel, unsigned char *rgba)
+    {
+        int palette[8];
+        singlePalette(block[0], block[1], palette);
+        std::uint64_t bits = 0;
+        for (int i = 0; i < 6; i++)
+            bits |= (std::uint64_t)block[2 + i] << (8 * i);
+        for (int i = 0; i < 16; i++)
+            rgba[i * 4 + channel] = (unsigned char)palette[(bits >> (3 * i)) & 7];
+    }
+
+    // ------------------------------------------------------------------------
+    // BC7 mode 6: RGBA endpoints of 7 bits plus a shared low bit (p-bit) each, 4-bit indices
+    // ------------------------------------------------------------------------
+    static int mode6Weight(int index)
+    {
+        static const int weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+        return weights[index];
+    }
+    // the 7-bit values and p-bit closest to an endpoint
+    static void quantizeMode6(const float *endpoint, int *values, int &pbit)
+    {
+        float bestError = 1e30f;
+        for (int p = 0; p < 2; p++)
+        {
+            int candidate[4];
+            float error = 0.0f;
+            for (int c = 0; c < 4; c++)
+            {
+                float value = std::min(std::max(endpoint[c], 0.0f), 255.0f);
+                candidate[c] = std::min(127, std::max(0, (int)std::lround((value - p) / 2.0f)));
+                float d = value - (candidate[c] * 2 + p);
+                error += d * d;
+            }
+            if (error < bestError)
+            {
+                bestError = error;
+                pbit = p;
+                std::memcpy(values, candidate, sizeof(candidate));
+            }
+        }
+    }
+    // writes bits LSB first, the way BC7 blocks are laid out
+    struct BitWriter
+    {
+        unsigned char *out;
+        int position = 0;
+
+        void write(std::uint32_t value, int count)
+        {
+            for (int i = 0; i < count; i++, position++)
+                if (value & (1u << i))
+                    out[position / 8] |= (unsigned char)(1 << (position % 8));
+        }
+    };
+    struct BitReader
+    {
+        const unsigned char *in;
+        int position = 0;
+
+        std::uint32_t read(int count)
+        {
+            std::uint32_t value = 0;
+            for (int i = 0; i < count; i++, position++)
+                value |= (std::uint32_t)((in[position / 8] >> (position % 8)) & 1) << i;
+            return value;
+        }
+    };
+    static void encodeMode6(const unsigned char *rgba, unsigned char *out)
+    {
+        float high[4], low[4];
+        fitEndpoints(rgba, 4, high, low);
+        int values[2][4];
+        int pbits[2] = { 0, 0 };
+        quantizeMode6(high, values[0], pbits[0]);
+        quantizeMode6(low, values[1], pbits[1]);
+        int endpoints[2][4];
+        for (int e = 0; e < 2; e++)
+            for (int c = 0; c < 4; c++)
+                endpoints[e][c] = values[e][c] * 2 + pbits[e];
+
+        int palette[64];
+        for (int index = 0; index < 16; index++)
+        {
+            int w = mode6Weight(index);
+            for (int c = 0; c < 4; c++)
+                palette[index * 4 + c] = ((64 - w) * endpoints[0][c] + w * endpoints[1][c] + 32) >> 6;
+        }
+        int indices[16];
+        chooseIndices(rgba, palette, 16, 4, indices);
+        // the first index is stored without its top bit, so it has to be below 8
+        if (indices[0] >= 8)
+        {
+            std::swap(values[0], values[1]);
+            std::swap(pbits[0], pbits[1]);
+            for (int &index : indices)
+                index = 15 - index;
+        }
+
+        std::memset(out, 0, 16);
+        BitWriter bits = { out };
+        bits.write(1 << 6, 7); // mode 6
+        for (int c = 0; c < 4; c++)
+        {
+            bits.write(values[0][c], 7);
+            bits.write(values[1][c], 7);
+        }
+        bits.write(pbits[0], 1);
+        bits.write(pbits[1], 1);
+        bits.write(indices[0], 3);
+        for (int i = 1; i < 16; i++)
+            bits.write(indices[i], 4);
+    }
+    // ------------------------------------------------------------------------
+    // BC7 decoding, every mode: what the mode byte selects, per mode 0..7 - subsets, partition bits,
+    // rotation bits, index selection bits, color and alpha bits per endpoint, p-bits per endpoint or
+    // per subset, and the bits of the two index sets
+    // ------------------------------------------------------------------------
+    struct Bc7Mode
+    {
+        int subsets, partitionBits, rotationBits, selectionBits, colorBits, alphaBits, endpointPBits, sharedPBits,
+            indexBits, secondaryIndexBits;
+    };
+    static const Bc7Mode &bc7Mode(int mode)
+    {
+        static const Bc7Mode modes[8] = {
+            { 3, 4, 0, 0, 4, 0, 1, 0, 3, 0 }, { 2, 6, 0, 0, 6, 0, 0, 1, 3, 0 }, { 3, 6, 0, 0, 5, 0, 0, 0, 2, 0 },
+            { 2, 6, 0, 0, 7, 0, 1, 0, 2, 0 }, { 1, 0, 2, 1, 5, 6, 0, 0, 2, 3 }, { 1, 0, 2, 0, 7, 8, 0, 0, 2, 2 },
+            { 1, 0, 0, 0, 7, 7, 1, 0, 4, 0 }, { 2, 6, 0, 0, 5, 5, 1, 0, 2, 0 }
+        };
+        return modes[mode];
+    }
+    // the subset a texel belongs to in a partition of 2 or 3 subsets. the 2 subset table has a bit per
+    // texel, the 3 subset one two
+    static int bc7Subset(int subsets, int partition, int texel)
+    {
+        static const std::uint16_t two[64] = {
+            0xCCCC, 0x8888, 0xEEEE, 0xECC8, 0xC880, 0xFEEC, 0xFEC8, 0xEC80, 0xC800, 0xFFEC, 0xFE80, 0xE800, 0xFFE8,
+            0xFF00, 0xFFF0, 0xF000, 0xF710, 0x008E, 0x7100, 0x08CE, 0x008C, 0x7310, 0x3100, 0x8CCE, 0x088C, 0x3110,
+            0x6666, 0x366C, 0x17E8, 0x0FF0, 0x718E, 0x399C, 0xAAAA, 0xF0F0, 0x5A5A, 0x33CC, 0x3C3C, 0x55AA, 0x9696,
+            0xA55A, 0x73CE, 0x13C8, 0x324C, 0x3BDC, 0x6996, 0xC33C, 0x9966, 0x0660, 0x0272, 0x04E4, 0x4E40, 0x2720,
+            0xC936, 0x936C, 0x39C6, 0x639C, 0x9336, 0x9CC6, 0x817E, 0xE718, 0xCCF0, 0x0FCC, 0x7744, 0xEE22
+        };
+        static const std::uint32_t three[64] = {
+            0xAA685050, 0x6A5A5040, 0x5A5A4200, 0x5450A0A8, 0xA5A50000, 0xA0A05050, 0x5555A0A0, 0x5A5A5050,
+            0xAA550000, 0xAA555500, 0xAAAA5500, 0x90909090, 0x94949494, 0xA4A4A4A4, 0xA9A59450, 0x2A0A4250,
+            0xA5945040, 0x0A425054, 0xA5A5A500, 0x55A0A0A0, 0xA8A85454, 0x6A6A4040, 0xA4A45000, 0x1A1A0500,
+            0x0050A4A4, 0xAAA59090, 0x14696914, 0x69691400, 0xA08585A0, 0xAA821414, 0x50A4A450, 0x6A5A0200,
+            0xA9A58000, 0x5090A0A8, 0xA8A09050, 0x24242424, 0x00AA5500, 0x24924924, 0x24499224, 0x50A50A50,
+            0x500AA550, 0xAAAA4444, 0x66660000, 0xA5A0A5A0, 0x50A050A0, 0x69286928, 0x44AAAA44, 0x66666600,
+            0xAA444444, 0x54A854A8, 0x95809580, 0x96969600, 0xA85454A8, 0x80959580, 0xAA141414, 0x96960000,
+            0xAAAA1414, 0xA05050A0, 0xA0A5A5A0, 0x96000000, 0x40804080, 0xA9A8A9A8, 0xAAAAAA44, 0x2A4A5254
+        };
+        if (subsets == 2)
+            return (two[partition] >> texel) & 1;
+        if (subsets == 3)
+            return (three[partition] >> (2 * texel)) & 3;
+        return 0;
+    }
+    // the texel whose index is stored a bit short: texel 0 for the first subset, a table entry for the others
+    static int bc7Anchor(int subsets, int partition, int subset)
+    {
+        static const unsigned char second[64] = {
+            15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 2, 8, 2, 2, 8, 8, 15, 2, 8, 2, 2, 8, 8, 2, 2,
+            15, 15, 6, 8, 2, 8, 15, 15, 2, 8, 2, 2, 2, 15, 15, 6, 6, 2, 6, 8, 15, 15, 2, 2, 15, 15, 15, 15, 15, 2, 2, 15
+        };
+        static const unsigned char threeSecond[64] = {
+            3, 3, 15, 15, 8, 3, 15, 15, 8, 8, 6, 6, 6, 5, 3, 3, 3, 3, 8, 15, 3, 3, 6, 10, 5, 8, 8, 6, 8, 5, 15, 15,
+            8, 15, 3, 5, 6, 10, 8, 15, 15, 3, 15, 5, 15, 15, 15, 15, 3, 15, 5, 5, 5, 8, 5, 10, 5, 10, 8, 13, 15, 12, 3, 3
+        };
+        static const unsigned char threeThird[64] = {
+            15, 8, 8, 3, 15, 15, 3, 8, 15, 15, 15, 15, 15, 15, 15, 8, 15, 8, 15, 3, 15, 8, 15, 8, 3, 15, 6, 10, 15, 15, 10, 8,
+            15, 3, 15, 10, 10, 8, 9, 10, 6, 15, 8, 15, 3, 6, 6, 8, 15, 3, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 3, 15, 15, 8
+        };
+        if (subset == 0)
+            return 0;
+        if (subsets == 2)
+            return second[partition];
+        return subset == 1 ? threeSecond[partition] : threeThird[partition];
+    }
+    static int bc7Weight(int bits, int index)
+    {
+        static const int weights2[4] = { 0, 21, 43, 64 };
+        static const int weights3[8] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+        if (bits == 2)
+            return weights2[index];
+        if (bits == 3)
+            return weights3[index];
+        return mode6Weight(index);
+    }
+    // an endpoint channel of some bits (p-bit included) widened to 8 by repeating its top bits
+    static int bc7Expand(int value, int bits)
+    {
+        value <<= 8 - bits;
+        return value | (value >> bits);
+    }
+    // the reserved mode (no bit set in the first byte) decodes to transparent black, as GPUs do, and
+    // makes decode return false
+    static bool decodeBc7(const unsigned char *block, unsigned char *rgba)
+    {
+        int mode = 0;
+        while (mode < 8 && !(block[0] & (1 << mode)))
+            mode++;
+        if (mode == 8)
+        {
+            std::memset(rgba, 0, 64);
+            return false;
+        }
+        const Bc7Mode &m = bc7Mode(mode);
+        BitReader bits = { block, mode + 1 };
+        int partition = (int)bits.read(m.partitionBits);
+        int rotation = (int)bits.read(m.rotationBits);
+        int selection = (int)bits.read(m.selectionBits);
+
+        // endpoints[subset * 2 + end][channel], stored channel by channel
+        int endpoints[6][4];
+        int channelBits[4] = { m.colorBits, m.colorBits, m.colorBits, m.alphaBits };
+        for (int c = 0; c < 4; c++)
+            for (int e = 0; e < m.subsets * 2; e++)
+                endpoints[e][c] = channelBits[c] ? (int)bits.read(channelBits[c]) : 255;
+        int pbits[6] = { 0, 0, 0, 0, 0, 0 };
+        if (m.endpointPBits)
+            for (int e = 0; e < m.subsets * 2; e++)
+                pbits[e] = (int)bits.read(1);
+        if (m.sharedPBits)
+            for (int s = 0; s < m.subsets; s++)
+                pbits[s * 2] = pbits[s * 2 + 1] = (int)bits.read(1);
+        int hasPBit = m.endpointPBits | m.sharedPBits;
+        for (int e = 0; e < m.subsets * 2; e++)
+            for (int c = 0; c < 4; c++)
+                if (channelBits[c])
+                    endpoints[e][c] = bc7Expand((endpoints[e][c] << hasPBit) | pbits[e], channelBits[c] + hasPBit);
+
+        int indices[16], secondary[16] = { 0 };
+        for (int i = 0; i < 16; i++)
+        {
+            int subset = bc7Subset(m.subsets, partition, i);
+            indices[i] = (int)bits.read(m.indexBits - (i == bc7Anchor(m.subsets, partition, subset) ? 1 : 0));
+        }
+        if (m.secondaryIndexBits)
+            for (int i = 0; i < 16; i++)
+                secondary[i] = (int)bits.read(m.secondaryIndexBits - (i == 0 ? 1 : 0));
+
+        for (int i = 0; i < 16; i++)
+        {
+            const int *low = endpoints[bc7Subset(m.subsets, partition, i) * 2];
+            const int *high = low + 4;
+            // modes 4 and 5 weight color and alpha with separate index sets, which selection swaps
+            int colorWeight = bc7Weight(m.indexBits, indices[i]);
+            int alphaWeight = colorWeight;
+            if (m.secondaryIndexBits)
+            {
+                alphaWeight = bc7Weight(m.secondaryIndexBits, secondary[i]);
+                if (selection)
+                    std::swap(colorWeight, alphaWeight);
+            }
+            unsigned char *texel = rgba + i * 4;
+            for (int c = 0; c < 4; c++)
+            {
+                int w = c == 3 ? alphaWeight : colorWeight;
+                texel[c] = (unsigned char)(((64 - w) * low[c] + w * high[c] + 32) >> 6);
+            }
+            if (rotation)
+                std::swap(texel[3], texel[rotation - 1]);
+        }
+        return true;
+    }
+};
+#endif
@@ -0,0 +1,49 @@
+#ifndef CAMERA_BUFFER_H
+#define CAMERA_BUFFER_H
+
+#include <glad/glad.h>
+#include <../includes/glm/glm/glm.hpp>
+#include <../includes/glm/glm/gtc/matrix_transform.hpp>
+#include <../includes/camera.h>
+#include <../includes/shader_s.h>
+#include <../includes/shader_uniforms_data.h>
+
+// CPU mirror of the std140 Camera block in src/common/camera.glsl, generated by tools/uniform_structs.cpp
+typedef CameraUniformBlock CameraBlock;
+
+// One uniform buffer holding the camera matrices for every program. It is filled once per frame and
+// stays bound to CAMERA_BLOCK_BINDING, so the per-frame camera cost doesn't grow with the number of programs.
+class CameraBuffer
+{
+public:
+    unsigned int ID;
+
+    CameraBuffer()
+    {
+        glGenBuffers(1, &ID);
+        glBindBuffer(GL_UNIFORM_BUFFER, ID);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(CameraBlock), NULL, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferBase(GL_UNIFORM_BUFFER, CAMERA_BLOCK_BINDING, ID);
+    }
+    ~CameraBuffer()
+    {
+        glDeleteBuffers(1, &ID);
+    }
+    CameraBuffer(const CameraBuffer&) = delete;
+    CameraBuffer& operator=(const CameraBuffer&) = delete;
+
+    // upload this frame's view and projection
+    // ------------------------------------------------------------------------
+    void update(Camera &camera, float aspect, float nearPlane = 0.1f, float farPlane = 100.0f)
+    {
+        CameraBlock block = {};
+        block.projection = glm::perspective(glm::radians(camera.Zoom), aspect, nearPlane, farPlane);
+        block.view = camera.GetViewMatrix();
+        block.viewPos = camera.Position;
+        glBindBuffer(GL_UNIFORM_BUFFER, ID);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(CameraBlock), &block);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+};
+#endif
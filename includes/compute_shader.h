@@ -0,0 +1,232 @@
+#ifndef COMPUTE_SHADER_H
+#define COMPUTE_SHADER_H
+
+#include <glad/glad.h>
+
+#include <../includes/shader_s.h>
+#include <../includes/memory_barriers.h>
+
+#include <vector>
+#include <iostream>
+
+// A compute program (GL 4.3 / ARB_compute_shader) with the resources it reads and writes.
+// Storage buffers, images and textures are bound through the ComputeShader so it knows what each
+// dispatch touches: before a dispatch it asks the shared MemoryBarriers for the bits its reads need,
+// after it every written resource is marked, and whoever consumes the results later asks again
+// for the bit matching how it reads them.
+//
+// Work-group counts are checked against the device limits before anything is dispatched; the local
+// size comes from the program (layout(local_size_x = ...) in) and is checked when it is first used.
+class ComputeShader : public Shader
+{
+public:
+    ComputeShader(const char* path, MemoryBarriers &barriers, const std::vector<std::string> &defines = {})
+        : Shader(GL_COMPUTE_SHADER, path, defines), barriers(barriers)
+    {
+    }
+    ComputeShader(ShaderPackId id, MemoryBarriers &barriers, const std::vector<std::string> &defines = {})
+        : Shader(GL_COMPUTE_SHADER, id, defines), barriers(barriers)
+    {
+    }
+
+    static bool supported()
+    {
+        return GLAD_GL_VERSION_4_3 || GLAD_GL_ARB_compute_shader;
+    }
+    // bind a shader storage buffer (layout(std430, binding = N) buffer). access says whether the
+    // program reads it, writes it or both: GL_READ_ONLY, GL_WRITE_ONLY or GL_READ_WRITE
+    // ------------------------------------------------------------------------
+    void bindStorageBuffer(GLuint binding, GLuint buffer, GLenum access = GL_READ_WRITE)
+    {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, buffer);
+        track(STORAGE_SLOT, binding, bufferResource(buffer), GL_SHADER_STORAGE_BARRIER_BIT, access);
+    }
+    // bind one level of a texture as an image (layout(rgba8, binding = N) uniform image2D)
+    // ------------------------------------------------------------------------
+    void bindImage(GLuint unit, GLuint texture, GLenum access, GLenum format, GLint level = 0)
+    {
+        glBindImageTexture(unit, texture, level, GL_TRUE, 0, access, format);
+        track(IMAGE_SLOT, unit, textureResource(texture), GL_SHADER_IMAGE_ACCESS_BARRIER_BIT, access);
+    }
+    // bind a texture the program samples through a sampler uniform
+    // ------------------------------------------------------------------------
+    void bindTexture(GLuint unit, GLenum target, GLuint texture)
+    {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(target, texture);
+        track(TEXTURE_SLOT, unit, textureResource(texture), GL_TEXTURE_FETCH_BARRIER_BIT, GL_READ_ONLY);
+    }
+    // number of work groups needed to cover count invocations along an axis (0, 1 or 2)
+    // ------------------------------------------------------------------------
+    GLuint groupsFor(GLuint count, int axis = 0)
+    {
+        GLuint size = (GLuint)localSize()[axis];
+        return (count + size - 1) / size;
+    }
+    // layout(local_size_x/y/z) of the linked program, 1 x 1 x 1 if it failed to link
+    // ------------------------------------------------------------------------
+    const GLint* localSize()
+    {
+        resolve();
+        if (localSizeProgram != ID)
+        {
+            // a reload or specialization swaps ID, and the new source may declare another size
+            localSizeProgram = ID;
+            GLint status = GL_FALSE;
+            glGetProgramiv(ID, GL_LINK_STATUS, &status);
+            linked = status == GL_TRUE;
+            for (int axis = 0; axis < 3; axis++)
+                workGroupSize[axis] = 1;
+            if (linked)
+            {
+                glGetProgramiv(ID, GL_COMPUTE_WORK_GROUP_SIZE, workGroupSize);
+                validateLocalSize();
+            }
+        }
+        return workGroupSize;
+    }
+    // run x * y * z work groups. returns false, without dispatching, if a count exceeds the device limit
+    // ------------------------------------------------------------------------
+    bool dispatch(GLuint x, GLuint y = 1, GLuint z = 1)
+    {
+        if (!begin())
+            return false;
+        const Limits &limits = deviceLimits();
+        GLuint counts[3] = { x, y, z };
+        for (int axis = 0; axis < 3; axis++)
+        {
+            if (counts[axis] > (GLuint)limits.groupCount[axis])
+            {
+                std::cout << "ERROR::COMPUTE::WORK_GROUP_COUNT: " << counts[axis] << " groups along axis " << axis
+                          << ", the device allows " << limits.groupCount[axis] << std::endl;
+                return false;
+            }
+        }
+        if (x == 0 || y == 0 || z == 0)
+            return true;
+        glDispatchCompute(x, y, z);
+        end();
+        return true;
+    }
+    // run the group counts stored as three GLuints at offset in buffer, typically written by an earlier
+    // dispatch. counts over the device limit are undefined behaviour here, they can't be checked on the CPU
+    // ------------------------------------------------------------------------
+    bool dispatchIndirect(GLuint buffer, GLintptr offset = 0)
+    {
+        if (offset % 4 != 0)
+        {
+            std::cout << "ERROR::COMPUTE::INDIRECT_OFFSET_NOT_ALIGNED: " << offset << std::endl;
+            return false;
+        }
+        if (!begin())
+            return false;
+        barriers.read(bufferResource(buffer), GL_COMMAND_BARRIER_BIT);
+        glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, buffer);
+        glDispatchComputeIndirect(offset);
+        end();
+        return true;
+    }
+    MemoryBarriers& memoryBarriers()
+    {
+        return barriers;
+    }
+
+private:
+    enum SlotType
+    {
+        STORAGE_SLOT,
+        IMAGE_SLOT,
+        TEXTURE_SLOT
+    };
+    // what is bound at one binding point and how the program uses it
+    struct Binding
+    {
+        SlotType type;
+        GLuint slot;
+        GpuResource resource;
+        GLbitfield readBarrier; // the barrier bit that makes earlier shader writes visible to this binding
+        GLenum access;
+    };
+    struct Limits
+    {
+        GLint groupCount[3];
+        GLint groupSize[3];
+        GLint invocations;
+    };
+
+    MemoryBarriers &barriers;
+    std::vector<Binding> bindings;
+    GLint workGroupSize[3] = { 1, 1, 1 };
+    unsigned int localSizeProgram = 0;
+    bool linked = false;
+
+    // ------------------------------------------------------------------------
+    void track(SlotType type, GLuint slot, GpuResource resource, GLbitfield readBarrier, GLenum access)
+    {
+        for (Binding &binding : bindings)
+        {
+            if (binding.type == type && binding.slot == slot)
+            {
+                binding = { type, slot, resource, readBarrier, access };
+                return;
+            }
+        }
+        bindings.push_back({ type, slot, resource, readBarrier, access });
+    }
+    // make the program current and the writes of earlier dispatches visible to this one. a resource this
+    // dispatch only writes still gets the barrier, so earlier writes can't land after the new ones
+    // ------------------------------------------------------------------------
+    bool begin()
+    {
+        if (!supported())
+        {
+            std::cout << "ERROR::COMPUTE::NOT_SUPPORTED: needs GL 4.3 or ARB_compute_shader" << std::endl;
+            return false;
+        }
+        localSize();
+        if (!linked)
+            return false; // the compile/link errors were reported by resolve()
+        use();
+        for (const Binding &binding : bindings)
+            barriers.read(binding.resource, binding.readBarrier);
+        return true;
+    }
+    void end()
+    {
+        for (const Binding &binding : bindings)
+            if (binding.access != GL_READ_ONLY)
+                barriers.written(binding.resource);
+    }
+    // ------------------------------------------------------------------------
+    void validateLocalSize() const
+    {
+        const Limits &limits = deviceLimits();
+        for (int axis = 0; axis < 3; axis++)
+            if (workGroupSize[axis] > limits.groupSize[axis])
+                std::cout << "ERROR::COMPUTE::LOCAL_SIZE: " << workGroupSize[axis] << " invocations along axis " << axis
+                          << ", the device allows " << limits.groupSize[axis] << std::endl;
+        GLint invocations = workGroupSize[0] * workGroupSize[1] * workGroupSize[2];
+        if (invocations > limits.invocations)
+            std::cout << "ERROR::COMPUTE::LOCAL_SIZE: " << invocations << " invocations per group, the device allows "
+                      << limits.invocations << std::endl;
+    }
+    // queried once, they can't change for the lifetime of the context
+    // ------------------------------------------------------------------------
+    static const Limits& deviceLimits()
+    {
+        static Limits limits = queryLimits();
+        return limits;
+    }
+    static Limits queryLimits()
+    {
+        Limits limits = {};
+        for (GLuint axis = 0; axis < 3; axis++)
+        {
+            glGetIntegeri_v(GL_MAX_COMPUTE_WORK_GROUP_COUNT, axis, &limits.groupCount[axis]);
+            glGetIntegeri_v(GL_MAX_COMPUTE_WORK_GROUP_SIZE, axis, &limits.groupSize[axis]);
+        }
+        glGetIntegerv(GL_MAX_COMPUTE_WORK_GROUP_INVOCATIONS, &limits.invocations);
+        return limits;
+    }
+};
+#endif
@@ -0,0 +1,40 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+// 64-bit FNV-1a, usable at compile time so tables of names can be hashed ahead of time
+// ------------------------------------------------------------------------
+constexpr std::uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+constexpr std::uint64_t FNV_PRIME        = 1099511628211ull;
+
+constexpr std::uint64_t hashBytes(const char* data, std::size_t size, std::uint64_t seed = FNV_OFFSET_BASIS)
+{
+    std::uint64_t hash = seed;
+    for (std::size_t i = 0; i < size; i++)
+    {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+constexpr std::uint64_t hashString(const char* str, std::uint64_t seed = FNV_OFFSET_BASIS)
+{
+    std::uint64_t hash = seed;
+    for (; *str; str++)
+    {
+        hash ^= static_cast<unsigned char>(*str);
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+inline std::uint64_t hashString(const std::string& str, std::uint64_t seed = FNV_OFFSET_BASIS)
+{
+    return hashBytes(str.data(), str.size(), seed);
+}
+
+#endif
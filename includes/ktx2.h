@@ -0,0 +1,336 @@
+#ifndef KTX2_H
+#define KTX2_H
+
+#include <../includes/block_compression.h>
+#include <../includes/mip_chain.h>
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+// Reads and writes KTX2 files (https://registry.khronos.org/KTX/specs/2.0/ktxspec.v2.html) holding one
+// block compressed 2D texture with its mip chain - what tools/texture_compress.cpp writes. Not a general
+// KTX2 reader: arrays, cube maps, 3D textures, supercompression and uncompressed formats are refused.
+//
+// In memory the levels are packed level 0 first, each at MipLevel::offset like a MipChain, so the
+// data can be read straight into staging memory and uploaded level by level. The file stores them
+// smallest first, as the format wants.
+class Ktx2File
+{
+public:
+    BlockFormat format = BLOCK_BC1;
+    bool srgb = false;         // the vkFormat is an _SRGB one
+    bool bottomUp = false;     // KTXorientation "ru": the first row is the bottom one, as GL expects
+    int width = 0;
+    int height = 0;
+    std::vector<MipLevel> levels;
+    size_t size = 0;           // bytes of all levels
+
+    // read the header and level index; false if the file is missing or not one this class reads.
+    // the levels stay on disk until read()
+    // ------------------------------------------------------------------------
+    bool open(const std::string &path)
+    {
+        file.close();
+        file.clear();
+        file.open(path, std::ios::binary);
+        if (!file)
+            return false;
+        unsigned char identifier[12];
+        std::uint32_t header[9];
+        if (!file.read(reinterpret_cast<char *>(identifier), 12) || std::memcmp(identifier, IDENTIFIER, 12) != 0 ||
+            !readWords(header, 9))
+        {
+            std::cout << "ERROR::KTX2::NOT_KTX2: " << path << std::endl;
+            return false;
+        }
+        std::uint32_t vkFormat = header[0];
+        width = (int)header[2];
+        height = (int)header[3];
+        std::uint32_t levelCount = std::max<std::uint32_t>(header[7], 1);
+        if (!blockFormat(vkFormat, format, srgb) || header[4] != 0 || header[5] > 1 || header[6] != 1 || header[8] != 0 ||
+            width <= 0 || height <= 0 || levelCount > 32)
+        {
+            std::cout << "ERROR::KTX2::UNSUPPORTED: " << path << " (vkFormat " << vkFormat
+                      << ", only 2D BC1/3/4/5/7 textures without supercompression)" << std::endl;
+            return false;
+        }
+        std::uint32_t index[4];
+        std::uint64_t supercompression[2];
+        std::vector<std::uint64_t> levelIndex(levelCount * 3);
+        if (!readWords(index, 4) || !readLongs(supercompression, 2) || !readLongs(levelIndex.data(), levelIndex.size()))
+        {
+            std::cout << "ERROR::KTX2::TRUNCATED: " << path << std::endl;
+            return false;
+        }
+
+        levels = layout(format, width, height, (int)levelCount, size);
+        fileOffsets.resize(levelCount);
+        for (std::uint32_t level = 0; level < levelCount; level++)
+        {
+            fileOffsets[level] = levelIndex[level * 3];
+            if (levelIndex[level * 3 + 1] != levels[level].size)
+            {
+                std::cout << "ERROR::KTX2::LEVEL_SIZE: " << path << " level " << level << std::endl;
+                return false;
+            }
+        }
+        bottomUp = readOrientation(index[2], index[3]) == "ru";
+        return true;
+    }
+    // read every level into out, which holds size bytes
+    // ------------------------------------------------------------------------
+    bool read(unsigned char *out)
+    {
+        for (size_t level = 0; level < levels.size(); level++)
+        {
+            file.seekg((std::streamoff)fileOffsets[level]);
+            if (!file.read(reinterpret_cast<char *>(out + levels[level].offset), (std::streamsize)levels[level].size))
+            {
+                std::cout << "ERROR::KTX2::TRUNCATED: level " << level << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // write levels packed as layout() lays them out. writer names the tool in the KTXwriter key
+    // ------------------------------------------------------------------------
+    static bool write(const std::string &path, BlockFormat format, bool srgb, bool bottomUp, int width, int height,
+                      const std::vector<MipLevel> &levels, const unsigned char *data, const std::string &writer)
+    {
+        std::vector<unsigned char> dfd = descriptor(format, srgb);
+        std::vector<unsigned char> kvd;
+        // keys sorted by their bytes, as the spec requires
+        keyValue(kvd, "KTXorientation", bottomUp ? "ru" : "rd");
+        keyValue(kvd, "KTXwriter", writer);
+
+        size_t levelCount = levels.size();
+        size_t dfdOffset = 12 + 9 * 4 + 4 * 4 + 2 * 8 + levelCount * 3 * 8;
+        size_t kvdOffset = dfdOffset + dfd.size();
+        // every level starts on a multiple of the block size (which is also a multiple of 4)
+        size_t blockBytes = (size_t)BlockCodec::blockBytes(format);
+        std::vector<std::uint64_t> offsets(levelCount);
+        size_t end = kvdOffset + kvd.size();
+        for (size_t level = levelCount; level-- > 0;)
+        {
+            end = (end + blockBytes - 1) / blockBytes * blockBytes;
+            offsets[level] = end;
+            end += levels[level].size;
+        }
+
+        std::vector<unsigned char> out;
+        out.insert(out.end(), IDENTIFIER, IDENTIFIER + 12);
+        std::uint32_t header[9] = { vkFormat(format, srgb), 1, (std::uint32_t)width, (std::uint32_t)height, 0, 0, 1,
+                                    (std::uint32_t)levelCount, 0 };
+        for (std::uint32_t word : header)
+            put(out, word, 4);
+        put(out, dfdOffset, 4);
+        put(out, dfd.size(), 4);
+        put(out, kvdOffset, 4);
+        put(out, kvd.size(), 4);
+        put(out, 0, 8); // no supercompression global data
+        put(out, 0, 8);
+        for (size_t level = 0; level < levelCount; level++)
+        {
+            put(out, offsets[level], 8);
+            put(out, levels[level].size, 8);
+            put(out, levels[level].size, 8);
+        }
+        out.insert(out.end(), dfd.begin(), dfd.end());
+        out.insert(out.end(), kvd.begin(), kvd.end());
+        for (size_t level = levelCount; level-- > 0;)
+        {
+            out.resize(offsets[level], 0);
+            out.insert(out.end(), data + levels[level].offset, data + levels[level].offset + levels[level].size);
+        }
+
+        std::ofstream file(path, std::ios::binary);
+        if (!file.write(reinterpret_cast<const char *>(out.data()), (std::streamsize)out.size()))
+        {
+            std::cout << "ERROR::KTX2::WRITE_FAILED: " << path << std::endl;
+            return false;
+        }
+        return true;
+    }
+    // the block data of each level of a width x height image, level 0 first. levelCount 0 means a full chain
+    // ------------------------------------------------------------------------
+    static std::vector<MipLevel> layout(BlockFormat format, int width, int height, int levelCount, size_t &size)
+    {
+        std::vector<MipLevel> levels;
+        size = 0;
+        for (int level = 0; levelCount == 0 || level < levelCount; level++)
+        {
+            MipLevel mip;
+            mip.width = std::max(1, width >> level);
+            mip.height = std::max(1, height >> level);
+            mip.offset = size;
+            mip.size = BlockCodec::imageBytes(format, mip.width, mip.height);
+            levels.push_back(mip);
+            size += mip.size;
+            if (levelCount == 0 && mip.width == 1 && mip.height == 1)
+                break;
+        }
+        return levels;
+    }
+    // VkFormat values of the formats, from the Vulkan spec
+    // ------------------------------------------------------------------------
+    static std::uint32_t vkFormat(BlockFormat format, bool srgb)
+    {
+        switch (format)
+        {
+        case BLOCK_BC1:
+            return srgb ? 132 : 131; // VK_FORMAT_BC1_RGB_SRGB_BLOCK / _UNORM_BLOCK
+        case BLOCK_BC3:
+            return srgb ? 138 : 137; // VK_FORMAT_BC3_*
+        case BLOCK_BC4:
+            return 139;              // VK_FORMAT_BC4_UNORM_BLOCK
+        case BLOCK_BC5:
+            return 141;              // VK_FORMAT_BC5_UNORM_BLOCK
+        case BLOCK_BC7:
+            return srgb ? 146 : 145; // VK_FORMAT_BC7_*
+        }
+        return 0;
+    }
+    static bool blockFormat(std::uint32_t vkFormat, BlockFormat &format, bool &srgb)
+    {
+        BlockFormat formats[] = { BLOCK_BC1, BLOCK_BC3, BLOCK_BC4, BLOCK_BC5, BLOCK_BC7 };
+        for (BlockFormat candidate : formats)
+        {
+            for (int isSrgb = 0; isSrgb < 2; isSrgb++)
+            {
+                if (Ktx2File::vkFormat(candidate, isSrgb != 0) == vkFormat)
+                {
+                    format = candidate;
+                    srgb = isSrgb != 0 && (candidate != BLOCK_BC4 && candidate != BLOCK_BC5);
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+private:
+    static constexpr unsigned char IDENTIFIER[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+
+    std::ifstream file;
+    std::vector<std::uint64_t> fileOffsets;
+
+    // ------------------------------------------------------------------------
+    bool readWords(std::uint32_t *words, size_t count)
+    {
+        unsigned char bytes[4];
+        for (size_t i = 0; i < count; i++)
+        {
+            if (!file.read(reinterpret_cast<char *>(bytes), 4))
+                return false;
+            words[i] = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((std::uint32_t)bytes[3] << 24);
+        }
+        return true;
+    }
+    bool readLongs(std::uint64_t *longs, size_t count)
+    {
+        std::uint32_t words[2];
+        for (size_t i = 0; i < count; i++)
+        {
+            if (!readWords(words, 2))
+                return false;
+            longs[i] = words[0] | ((std::uint64_t)words[1] << 32);
+        }
+        return true;
+    }
+    // the KTXorientation value, "rd" (top row first) when the key is missing
+    std::string readOrientation(std::uint32_t offset, std::uint32_t length)
+    {
+        std::vector<char> kvd(length);
+        file.seekg(offset);
+        if (length == 0 || !file.read(kvd.data(), length))
+            return "rd";
+        for (size_t at = 0; at + 4 <= kvd.size();)
+        {
+            const unsigned char *bytes = reinterpret_cast<const unsigned char *>(kvd.data() + at);
+            size_t pair = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((size_t)bytes[3] << 24);
+            if (pair > kvd.size() - at - 4)
+                break;
+            std::string key(kvd.data() + at + 4, strnlen(kvd.data() + at + 4, pair));
+            if (key == "KTXorientation" && key.size() + 1 < pair)
+                return std::string(kvd.data() + at + 4 + key.size() + 1, strnlen(kvd.data() + at + 4 + key.size() + 1, pair - key.size() - 1));
+            at += 4 + (pair + 3) / 4 * 4;
+        }
+        return "rd";
+    }
+    static void put(std::vector<unsigned char> &out, std::uint64_t value, int bytes)
+    {
+        for (int i = 0; i < bytes; i++)
+            out.push_back((unsigned char)(value >> (8 * i)));
+    }
+    static void keyValue(std::vector<unsigned char> &kvd, const std::string &key, const std::string &value)
+    {
+        put(kvd, key.size() + 1 + value.size() + 1, 4);
+        kvd.insert(kvd.end(), key.begin(), key.end());
+        kvd.push_back(0);
+        kvd.insert(kvd.end(), value.begin(), value.end());
+        kvd.push_back(0);
+        kvd.resize((kvd.size() + 3) / 4 * 4, 0);
+    }
+    // the Khronos data format descriptor: one basic block with a sample per compressed plane
+    // ------------------------------------------------------------------------
+    static std::vector<unsigned char> descriptor(BlockFormat format, bool srgb)
+    {
+        // KHR_DF_MODEL_BC1A.. values, and the channel ids of the samples (color, alpha = 15, red, green)
+        struct Sample
+        {
+            std::uint32_t channel;
+            std::uint32_t bitOffset;
+        };
+        std::uint32_t model = 0;
+        std::vector<Sample> samples;
+        switch (format)
+        {
+        case BLOCK_BC1:
+            model = 128;
+            samples = { { 0, 0 } };
+            break;
+        case BLOCK_BC3:
+            model = 130;
+            samples = { { 15, 0 }, { 0, 64 } };
+            break;
+        case BLOCK_BC4:
+            model = 131;
+            samples = { { 0, 0 } };
+            break;
+        case BLOCK_BC5:
+            model = 132;
+            samples = { { 0, 0 }, { 1, 64 } };
+            break;
+        case BLOCK_BC7:
+            model = 134;
+            samples = { { 0, 0 } };
+            break;
+        }
+        std::uint32_t blockBytes = (std::uint32_t)BlockCodec::blockBytes(format);
+        std::uint32_t sampleBits = blockBytes * 8 / (std::uint32_t)samples.size();
+        std::uint32_t blockSize = 24 + 16 * (std::uint32_t)samples.size();
+
+        std::vector<unsigned char> dfd;
+        put(dfd, 4 + blockSize, 4);                          // dfdTotalSize
+        put(dfd, 0, 4);                                      // vendor Khronos, descriptor type basic
+        put(dfd, 2 | (blockSize << 16), 4);                  // version 1.3, block size
+        put(dfd, model | (1 << 8) | ((srgb ? 2u : 1u) << 16), 4); // BT.709 primaries, sRGB or linear transfer
+        put(dfd, 3 | (3 << 8), 4);                           // 4x4x1x1 texel blocks, stored as size - 1
+        put(dfd, blockBytes, 4);                             // bytes per plane
+        put(dfd, 0, 4);
+        for (const Sample &sample : samples)
+        {
+            put(dfd, sample.bitOffset | ((sampleBits - 1) << 16) | (sample.channel << 24), 4);
+            put(dfd, 0, 4);                                  // sample position
+            put(dfd, 0, 4);                                  // lower
+            put(dfd, 0xFFFFFFFFu, 4);                        // upper
+        }
+        return dfd;
+    }
+};
+#endif
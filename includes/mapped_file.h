@@ -0,0 +1,107 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <cstddef>
+#include <iostream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// A whole file mapped read-only into memory, unmapped when the object goes. Pages are read in as they
+// are touched, so copying out of the mapping costs the disk reads and no more; the kernel is told the
+// file will be read front to back so it reads ahead.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string &path)
+    {
+        open(path);
+    }
+    ~MappedFile()
+    {
+        close();
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // false if the file doesn't exist or can't be mapped. an empty file maps to nothing and fails too
+    // ------------------------------------------------------------------------
+    bool open(const std::string &path)
+    {
+        close();
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+        LARGE_INTEGER fileSize;
+        if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+        {
+            HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+            if (mapping)
+            {
+                bytes = static_cast<const unsigned char *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+                CloseHandle(mapping); // the view keeps the mapping alive
+            }
+            length = bytes ? (size_t)fileSize.QuadPart : 0;
+        }
+        CloseHandle(file);
+#else
+        int file = ::open(path.c_str(), O_RDONLY);
+        if (file < 0)
+            return false;
+        struct stat status;
+        if (fstat(file, &status) == 0 && status.st_size > 0)
+        {
+            void *mapped = mmap(NULL, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+            if (mapped != MAP_FAILED)
+            {
+                bytes = static_cast<const unsigned char *>(mapped);
+                length = (size_t)status.st_size;
+                madvise(mapped, length, MADV_SEQUENTIAL);
+                madvise(mapped, length, MADV_WILLNEED);
+            }
+            else
+                std::cout << "ERROR::MAPPED_FILE::MMAP_FAILED: " << path << std::endl;
+        }
+        ::close(file); // the mapping keeps the file open
+#endif
+        return bytes != nullptr;
+    }
+    // ------------------------------------------------------------------------
+    void close()
+    {
+        if (!bytes)
+            return;
+#ifdef _WIN32
+        UnmapViewOfFile(bytes);
+#else
+        munmap(const_cast<unsigned char *>(bytes), length);
+#endif
+        bytes = nullptr;
+        length = 0;
+    }
+    const unsigned char* data() const
+    {
+        return bytes;
+    }
+    size_t size() const
+    {
+        return length;
+    }
+
+private:
+    const unsigned char *bytes = nullptr;
+    size_t length = 0;
+};
+#endif
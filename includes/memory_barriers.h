@@ -0,0 +1,94 @@
+#ifndef MEMORY_BARRIERS_H
+#define MEMORY_BARRIERS_H
+
+#include <glad/glad.h>
+
+#include <map>
+#include <utility>
+
+// a buffer or texture written by shaders. buffer and texture names come from separate namespaces,
+// so the kind is part of the identity
+enum GpuResourceKind
+{
+    GPU_BUFFER,
+    GPU_TEXTURE
+};
+
+struct GpuResource
+{
+    GpuResourceKind kind;
+    GLuint id;
+};
+
+inline GpuResource bufferResource(GLuint buffer)
+{
+    return { GPU_BUFFER, buffer };
+}
+inline GpuResource textureResource(GLuint texture)
+{
+    return { GPU_TEXTURE, texture };
+}
+
+// Shader writes through image stores, storage buffers and atomic counters are incoherent: whatever
+// reads the data next needs a glMemoryBarrier with the bit for the way it reads it. This tracks
+// which resources have such writes outstanding and issues only the bits that are still missing
+// when one of them is about to be read, instead of GL_ALL_BARRIER_BITS after every dispatch.
+//
+// A barrier orders every earlier write, so once a bit has been issued it covers all resources
+// written before it. Resources nobody wrote from a shader never cost a barrier.
+class MemoryBarriers
+{
+public:
+    // a dispatch or draw that writes to the resource from a shader has been issued
+    // ------------------------------------------------------------------------
+    void written(GpuResource resource)
+    {
+        pending[key(resource)] = 0;
+    }
+    // the resource is about to be read the way barrierBits describes (GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT
+    // to draw from it, GL_COMMAND_BARRIER_BIT for indirect arguments, GL_BUFFER_UPDATE_BARRIER_BIT to read
+    // it back, ...). issues a barrier if shader writes to it aren't visible that way yet
+    // ------------------------------------------------------------------------
+    void read(GpuResource resource, GLbitfield barrierBits)
+    {
+        auto found = pending.find(key(resource));
+        if (found == pending.end())
+            return;
+        GLbitfield missing = barrierBits & ~found->second;
+        if (missing == 0)
+            return;
+        glMemoryBarrier(missing);
+        issued++;
+        lastBits = missing;
+        for (auto &entry : pending)
+            entry.second |= missing;
+    }
+    // the resource is written by something other than a shader (glBufferSubData, a new glTexImage2D, ...)
+    // or deleted, earlier shader writes no longer need ordering against its readers
+    // ------------------------------------------------------------------------
+    void forget(GpuResource resource)
+    {
+        pending.erase(key(resource));
+    }
+    // number of glMemoryBarrier calls so far, and the bits of the latest one
+    unsigned int barrierCount() const
+    {
+        return issued;
+    }
+    GLbitfield lastBarrierBits() const
+    {
+        return lastBits;
+    }
+
+private:
+    // per resource with outstanding shader writes: the barrier bits issued since its last write
+    std::map<std::pair<int, GLuint>, GLbitfield> pending;
+    unsigned int issued = 0;
+    GLbitfield lastBits = 0;
+
+    static std::pair<int, GLuint> key(GpuResource resource)
+    {
+        return { (int)resource.kind, resource.id };
+    }
+};
+#endif
@@ -0,0 +1,420 @@
+#ifndef MIP_CHAIN_H
+#define MIP_CHAIN_H
+
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define MIP_CHAIN_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// gcc and clang only emit AVX2 code in functions marked for it, msvc takes the intrinsics anywhere
+#if defined(MIP_CHAIN_X86) && (defined(__GNUC__) || defined(__clang__))
+#define MIP_CHAIN_AVX2 __attribute__((target("avx2")))
+#else
+#define MIP_CHAIN_AVX2
+#endif
+
+// one level of a mip chain: its size and where its pixels start in the chain's block
+struct MipLevel
+{
+    int width;
+    int height;
+    size_t offset;
+    size_t size;
+};
+
+// the filter that built a mip chain. every kernel gives the same bytes, AUTO takes the fastest the CPU has
+enum MipKernel
+{
+    MIP_KERNEL_AUTO,
+    MIP_KERNEL_SCALAR,
+    MIP_KERNEL_SSE2,
+    MIP_KERNEL_AVX2
+};
+
+struct MipOptions
+{
+    bool srgb = true;          // colors are sRGB encoded. false for data like specular or normal maps
+    bool alphaWeighted = true; // weight colors by alpha, 4 channel images only
+    MipKernel kernel = MIP_KERNEL_AUTO;
+};
+
+// The full mip chain of an 8-bit image, made on the CPU so it can be built on a loader thread and
+// uploaded level by level instead of leaving glGenerateMipmap to the GL thread. All levels live in one
+// block of tightly packed rows (no row padding), level 0 first; the constructor lays the block out and
+// build() fills it.
+//
+// Each level is a box filter of the one above it: 2x2 texels, 3 along an odd edge so no row or column
+// is dropped. Colors are averaged in linear light (sRGB decoded, filtered, encoded again) - averaging
+// the encoded values darkens every edge between light and dark. With 4 channels the colors are
+// weighted by alpha (premultiplied while filtering, straight again in the result), so the invisible
+// color of fully transparent texels, like the background of awesomeface.png, doesn't bleed into the
+// visible ones. Levels are filtered from the float result of the previous level, not from its bytes.
+//
+// The filter runs on AVX2 or SSE2 when the CPU has them, plain C++ otherwise.
+class MipChain
+{
+public:
+    int channels = 0;
+    std::vector<MipLevel> levels;
+    size_t size = 0; // bytes of every level together
+
+    MipChain() = default;
+    // mipmapped = false lays out level 0 only
+    MipChain(int width, int height, int channels, bool mipmapped = true)
+        : channels(channels)
+    {
+        for (;;)
+        {
+            size_t bytes = (size_t)width * height * channels;
+            levels.push_back({ width, height, size, bytes });
+            size += bytes;
+            if (!mipmapped || (width == 1 && height == 1))
+                break;
+            width = std::max(1, width / 2);
+            height = std::max(1, height / 2);
+        }
+    }
+
+    // fill out (size bytes) with every level of image, whose layout is levels[0]
+    // ------------------------------------------------------------------------
+    void build(const unsigned char *image, unsigned char *out, const MipOptions &options = MipOptions()) const
+    {
+        if (levels.empty())
+            return;
+        std::memcpy(out + levels[0].offset, image, levels[0].size);
+        if (levels.size() == 1)
+            return;
+        MipKernel kernel = options.kernel == MIP_KERNEL_AUTO || !supported(options.kernel) ? bestKernel() : options.kernel;
+        bool weighted = options.alphaWeighted && channels == 4;
+
+        // texels are held as 4 floats whatever the channel count, so every kernel works on whole texels
+        std::vector<float> previous, current;
+        std::vector<float> rows[3];
+        for (std::vector<float> &row : rows)
+            row.resize((size_t)levels[0].width * 4);
+        std::vector<float> sum((size_t)levels[0].width * 4);
+        // how each channel's bytes decode: sRGB colors, or plain numbers for alpha and data
+        float decode[4 * 256];
+        int colors = channels == 4 || channels == 2 ? channels - 1 : channels; // the last of 2 or 4 is alpha
+        for (int c = 0; c < 4; c++)
+            std::memcpy(decode + c * 256, options.srgb && c < colors ? tables().toLinear : tables().toUnorm, 256 * sizeof(float));
+        for (size_t level = 1; level < levels.size(); level++)
+        {
+            const MipLevel &source = levels[level - 1];
+            const MipLevel &target = levels[level];
+            current.resize((size_t)target.width * target.height * 4);
+            for (int y = 0; y < target.height; y++)
+            {
+                int first = source.height == 1 ? 0 : 2 * y;
+                int count = source.height == 1 ? 1 : (y == target.height - 1 && source.height % 2 ? 3 : 2);
+                const float *taps[3];
+                for (int tap = 0; tap < count; tap++)
+                {
+                    if (level == 1)
+                    {
+                        // level 0 is only ever read here, so it is converted a row at a time
+                        toLinear(kernel, image + (size_t)(first + tap) * source.width * channels, source.width, rows[tap].data(), decode, weighted);
+                        taps[tap] = rows[tap].data();
+                    }
+                    else
+                        taps[tap] = previous.data() + (size_t)(first + tap) * source.width * 4;
+                }
+                filterRow(kernel, taps, count, source.width, sum.data(), current.data() + (size_t)y * target.width * 4, target.width);
+            }
+            toBytes(current.data(), target.width * target.height, out + target.offset, options.srgb, weighted);
+            std::swap(previous, current);
+        }
+    }
+
+    // ------------------------------------------------------------------------
+    static MipKernel bestKernel()
+    {
+        static MipKernel best = detect();
+        return best;
+    }
+    static bool supported(MipKernel kernel)
+    {
+        switch (kernel)
+        {
+        case MIP_KERNEL_AUTO:
+        case MIP_KERNEL_SCALAR:
+            return true;
+        case MIP_KERNEL_SSE2:
+            return bestKernel() >= MIP_KERNEL_SSE2;
+        case MIP_KERNEL_AVX2:
+            return bestKernel() >= MIP_KERNEL_AVX2;
+        }
+        return false;
+    }
+    static const char* kernelName(MipKernel kernel)
+    {
+        switch (kernel)
+        {
+        case MIP_KERNEL_AUTO:
+            return "auto";
+        case MIP_KERNEL_SCALAR:
+            return "scalar";
+        case MIP_KERNEL_SSE2:
+            return "sse2";
+        case MIP_KERNEL_AVX2:
+            return "avx2";
+        }
+        return "unknown";
+    }
+
+private:
+    // ------------------------------------------------------------------------
+    static MipKernel detect()
+    {
+#if defined(MIP_CHAIN_X86) && (defined(__GNUC__) || defined(__clang__))
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") ? MIP_KERNEL_AVX2 : MIP_KERNEL_SSE2;
+#elif defined(MIP_CHAIN_X86) && defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 1);
+        bool osSavesAvx = (info[2] & (1 << 27)) && (_xgetbv(0) & 6) == 6;
+        __cpuidex(info, 7, 0);
+        return osSavesAvx && (info[1] & (1 << 5)) ? MIP_KERNEL_AVX2 : MIP_KERNEL_SSE2;
+#else
+        return MIP_KERNEL_SCALAR;
+#endif
+    }
+    // sRGB decoding of every byte value, and the linear values halfway between neighbouring bytes
+    // for encoding: a linear value encodes to the number of midpoints at or below it. the guesses give
+    // that number for 4096 evenly spaced linear values, so encoding a value starts at most a few
+    // midpoints short of the answer instead of searching all 255
+    // ------------------------------------------------------------------------
+    static const int ENCODE_STEPS = 4096;
+    struct Tables
+    {
+        float toLinear[256];
+        float toUnorm[256];
+        float midpoints[256]; // the last one is past 1.0 and stops every search
+        unsigned char guesses[ENCODE_STEPS + 1];
+    };
+    static const Tables& tables()
+    {
+        static Tables tables = makeTables();
+        return tables;
+    }
+    static float decodeSrgb(double value)
+    {
+        return (float)(value <= 0.04045 ? value / 12.92 : std::pow((value + 0.055) / 1.055, 2.4));
+    }
+    static Tables makeTables()
+    {
+        Tables tables;
+        for (int i = 0; i < 256; i++)
+        {
+            tables.toLinear[i] = decodeSrgb(i / 255.0);
+            tables.toUnorm[i] = i / 255.0f;
+        }
+        for (int i = 0; i < 255; i++)
+            tables.midpoints[i] = decodeSrgb((i + 0.5) / 255.0);
+        tables.midpoints[255] = 2.0f;
+        int byte = 0;
+        for (int i = 0; i <= ENCODE_STEPS; i++)
+        {
+            float value = (float)i / ENCODE_STEPS;
+            while (value >= tables.midpoints[byte])
+                byte++;
+            tables.guesses[i] = (unsigned char)byte;
+        }
+        return tables;
+    }
+    static unsigned char encodeSrgb(float value, const Tables &tables)
+    {
+        value = std::min(std::max(value, 0.0f), 1.0f);
+        int byte = tables.guesses[(int)(value * ENCODE_STEPS)];
+        while (value >= tables.midpoints[byte])
+            byte++;
+        return (unsigned char)byte;
+    }
+    // ------------------------------------------------------------------------
+    // a row of bytes to 4 float texels through the per-channel decode tables
+    void toLinear(MipKernel kernel, const unsigned char *pixels, int count, float *out, const float *decode, bool weighted) const
+    {
+        int i = 0;
+#ifdef MIP_CHAIN_X86
+        if (kernel == MIP_KERNEL_AVX2 && channels == 4)
+            i = toLinearAvx2(pixels, count, out, decode, weighted);
+#endif
+        pixels += (size_t)i * channels;
+        out += (size_t)i * 4;
+        for (; i < count; i++, pixels += channels, out += 4)
+        {
+            out[0] = out[1] = out[2] = 0.0f;
+            out[3] = 1.0f;
+            for (int c = 0; c < channels; c++)
+                out[c] = decode[c * 256 + pixels[c]];
+            if (weighted)
+            {
+                out[0] *= out[3];
+                out[1] *= out[3];
+                out[2] *= out[3];
+            }
+        }
+    }
+    void toBytes(const float *texels, int count, unsigned char *out, bool srgb, bool weighted) const
+    {
+        const Tables &encode = tables();
+        int colors = channels == 4 || channels == 2 ? channels - 1 : channels;
+        bool encoded[4];
+        for (int c = 0; c < 4; c++)
+            encoded[c] = srgb && c < colors;
+        for (int i = 0; i < count; i++, texels += 4, out += channels)
+        {
+            // back from premultiplied. a texel nobody can see keeps black, it won't be blended in
+            float unweight = 1.0f;
+            if (weighted)
+                unweight = texels[3] > 0.0f ? 1.0f / texels[3] : 0.0f;
+            for (int c = 0; c < channels; c++)
+            {
+                float value = c < 3 ? texels[c] * unweight : texels[c];
+                if (encoded[c])
+                    out[c] = encodeSrgb(value, encode);
+                else
+                    out[c] = (unsigned char)(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+            }
+        }
+    }
+    // one row of the next level: the source rows are summed into sum, then neighbouring texels of the sum
+    // are averaged. a tap count of 3 only ever happens at the last row or column of an odd edge
+    // ------------------------------------------------------------------------
+    static void filterRow(MipKernel kernel, const float *const *taps, int count, int sourceWidth, float *sum, float *out, int width)
+    {
+        const float scale = count == 1 ? 1.0f : count == 2 ? 0.5f : 1.0f / 3.0f;
+        int floats = sourceWidth * 4;
+        int pairs = sourceWidth == 1 ? 0 : (sourceWidth % 2 ? width - 1 : width);
+#ifdef MIP_CHAIN_X86
+        if (kernel == MIP_KERNEL_AVX2)
+        {
+            sumRowsAvx2(taps, count, scale, floats, sum);
+            averagePairsAvx2(sum, pairs, out);
+        }
+        else if (kernel == MIP_KERNEL_SSE2)
+        {
+            sumRowsSse2(taps, count, scale, floats, sum);
+            averagePairsSse2(sum, pairs, out);
+        }
+        else
+#endif
+        {
+            sumRows(taps, count, scale, 0, floats, sum);
+            averagePairs(sum, 0, pairs, out);
+        }
+        if (sourceWidth == 1)
+            std::memcpy(out, sum, 4 * sizeof(float));
+        else if (sourceWidth % 2)
+        {
+            // the last texel also takes the odd column
+            const float *last = sum + (size_t)(width - 1) * 8;
+            float *texel = out + (size_t)(width - 1) * 4;
+            for (int c = 0; c < 4; c++)
+                texel[c] = (last[c] + last[c + 4] + last[c + 8]) * (1.0f / 3.0f);
+        }
+    }
+    // the plain versions also finish the rows the vector versions leave over
+    static void sumRows(const float *const *taps, int count, float scale, int from, int floats, float *sum)
+    {
+        for (int i = from; i < floats; i++)
+        {
+            float value = taps[0][i];
+            for (int tap = 1; tap < count; tap++)
+                value += taps[tap][i];
+            sum[i] = value * scale;
+        }
+    }
+    static void averagePairs(const float *sum, int from, int pairs, float *out)
+    {
+        for (int x = from; x < pairs; x++)
+            for (int c = 0; c < 4; c++)
+                out[x * 4 + c] = (sum[x * 8 + c] + sum[x * 8 + 4 + c]) * 0.5f;
+    }
+#ifdef MIP_CHAIN_X86
+    // ------------------------------------------------------------------------
+    static void sumRowsSse2(const float *const *taps, int count, float scale, int floats, float *sum)
+    {
+        __m128 factor = _mm_set1_ps(scale);
+        int i = 0;
+        for (; i + 4 <= floats; i += 4)
+        {
+            __m128 value = _mm_loadu_ps(taps[0] + i);
+            for (int tap = 1; tap < count; tap++)
+                value = _mm_add_ps(value, _mm_loadu_ps(taps[tap] + i));
+            _mm_storeu_ps(sum + i, _mm_mul_ps(value, factor));
+        }
+        sumRows(taps, count, scale, i, floats, sum);
+    }
+    static void averagePairsSse2(const float *sum, int pairs, float *out)
+    {
+        __m128 half = _mm_set1_ps(0.5f);
+        for (int x = 0; x < pairs; x++)
+        {
+            __m128 left = _mm_loadu_ps(sum + x * 8);
+            __m128 right = _mm_loadu_ps(sum + x * 8 + 4);
+            _mm_storeu_ps(out + x * 4, _mm_mul_ps(_mm_add_ps(left, right), half));
+        }
+    }
+    // ------------------------------------------------------------------------
+    MIP_CHAIN_AVX2 static void sumRowsAvx2(const float *const *taps, int count, float scale, int floats, float *sum)
+    {
+        __m256 factor = _mm256_set1_ps(scale);
+        int i = 0;
+        for (; i + 8 <= floats; i += 8)
+        {
+            __m256 value = _mm256_loadu_ps(taps[0] + i);
+            for (int tap = 1; tap < count; tap++)
+                value = _mm256_add_ps(value, _mm256_loadu_ps(taps[tap] + i));
+            _mm256_storeu_ps(sum + i, _mm256_mul_ps(value, factor));
+        }
+        sumRows(taps, count, scale, i, floats, sum);
+    }
+    // two output texels per step: texels 0 1 2 3 of the sum become (0 + 1) and (2 + 3)
+    MIP_CHAIN_AVX2 static void averagePairsAvx2(const float *sum, int pairs, float *out)
+    {
+        __m256 half = _mm256_set1_ps(0.5f);
+        int x = 0;
+        for (; x + 2 <= pairs; x += 2)
+        {
+            __m256 first = _mm256_loadu_ps(sum + x * 8);
+            __m256 second = _mm256_loadu_ps(sum + x * 8 + 8);
+            __m256 left = _mm256_permute2f128_ps(first, second, 0x20);
+            __m256 right = _mm256_permute2f128_ps(first, second, 0x31);
+            _mm256_storeu_ps(out + x * 4, _mm256_mul_ps(_mm256_add_ps(left, right), half));
+        }
+        averagePairs(sum, x, pairs, out);
+    }
+    // two RGBA texels per step, the four channel tables looked up with one gather. returns the texels done
+    MIP_CHAIN_AVX2 static int toLinearAvx2(const unsigned char *pixels, int count, float *out, const float *decode, bool weighted)
+    {
+        const __m256i tables = _mm256_setr_epi32(0, 256, 512, 768, 0, 256, 512, 768);
+        const __m256 ones = _mm256_set1_ps(1.0f);
+        int i = 0;
+        for (; i + 2 <= count; i += 2)
+        {
+            __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(pixels + (size_t)i * 4));
+            __m256i index = _mm256_add_epi32(_mm256_cvtepu8_epi32(bytes), tables);
+            __m256 texels = _mm256_i32gather_ps(decode, index, 4);
+            if (weighted)
+            {
+                // every channel times its texel's alpha, alpha itself times 1
+                __m256 alpha = _mm256_blend_ps(_mm256_permute_ps(texels, 0xFF), ones, 0x88);
+                texels = _mm256_mul_ps(texels, alpha);
+            }
+            _mm256_storeu_ps(out + (size_t)i * 4, texels);
+        }
+        return i;
+    }
+#endif
+};
+#endif
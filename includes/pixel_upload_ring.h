@@ -0,0 +1,321 @@
+#ifndef PIXEL_UPLOAD_RING_H
+#define PIXEL_UPLOAD_RING_H
+
+#include <glad/glad.h>
+
+#include <../includes/texture_cache.h>
+
+#include <deque>
+#include <vector>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+
+// Staging memory for texture uploads: one persistently mapped GL_PIXEL_UNPACK_BUFFER used as a ring.
+// Any thread can reserve() a block and write pixels into it through the mapping; the GL thread then
+// upload()s the block, which makes glTexImage2D read from the buffer offset instead of client memory,
+// so the driver neither copies the pixels nor waits for the GPU to take them. Every upload is fenced,
+// and retire() - once per frame on the GL thread - hands blocks back only after their fence has
+// signaled, so pixels the GPU may still be reading are never overwritten.
+//
+// Blocks are handed back in the order they were reserved. A reservation that doesn't fit fails
+// instead of waiting, the caller tries again after the next retire(). Needs GL 4.4 / ARB_buffer_storage,
+// supported() tells whether the ring can be created.
+class PixelUploadRing
+{
+public:
+    unsigned int ID = 0;
+
+    // a block of mapped memory to write pixels into, empty if the reservation failed
+    struct Staging
+    {
+        size_t offset = 0;
+        size_t size = 0;
+        unsigned char *pixels = nullptr;
+
+        explicit operator bool() const
+        {
+            return pixels != nullptr;
+        }
+    };
+    // counters since the ring was created
+    struct Stats
+    {
+        std::uint64_t bytes = 0;        // pixels uploaded from the ring
+        unsigned int uploads = 0;
+        unsigned int refused = 0;       // reservations that found the ring full
+        double cpuMilliseconds = 0.0;   // GL thread time spent issuing the uploads
+        double gpuMilliseconds = 0.0;   // GPU time of the uploads whose timer query has come back
+        std::uint64_t timedBytes = 0;   // the bytes gpuMilliseconds covers
+
+        // transfer rate on the GPU side, 0 until a timer query has come back
+        double megabytesPerSecond() const
+        {
+            return gpuMilliseconds > 0.0 ? timedBytes / (1024.0 * 1024.0) / (gpuMilliseconds / 1000.0) : 0.0;
+        }
+    };
+
+    PixelUploadRing(size_t capacity = 32 * 1024 * 1024)
+        : size(align(capacity))
+    {
+        if (!supported())
+        {
+            std::cout << "ERROR::PIXEL_UPLOAD_RING::NOT_SUPPORTED: needs GL 4.4 or ARB_buffer_storage" << std::endl;
+            return;
+        }
+        glGenBuffers(1, &ID);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ID);
+        // coherent: pixels written through the mapping are visible to the GPU without an explicit flush
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_PIXEL_UNPACK_BUFFER, (GLsizeiptr)size, NULL, flags);
+        mapped = static_cast<unsigned char *>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, (GLsizeiptr)size, flags));
+        if (!mapped)
+            std::cout << "ERROR::PIXEL_UPLOAD_RING::MAP_FAILED" << std::endl;
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+    ~PixelUploadRing()
+    {
+        for (Block &block : blocks)
+            if (block.fence)
+                glDeleteSync(block.fence);
+        for (Timing &timing : timings)
+            glDeleteQueries(1, &timing.query);
+        if (mapped)
+        {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ID);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        }
+        if (ID)
+            glDeleteBuffers(1, &ID);
+    }
+    PixelUploadRing(const PixelUploadRing&) = delete;
+    PixelUploadRing& operator=(const PixelUploadRing&) = delete;
+
+    static bool supported()
+    {
+        return GLAD_GL_VERSION_4_4 || GLAD_GL_ARB_buffer_storage;
+    }
+    // false if the buffer could not be created or mapped, reserve() then always fails
+    bool persistent() const
+    {
+        return mapped != nullptr;
+    }
+    size_t capacity() const
+    {
+        return size;
+    }
+    // claim bytes of staging memory, from any thread. fails if the ring is full right now, or if bytes
+    // is more than it can ever hold (fits() tells the two apart)
+    // ------------------------------------------------------------------------
+    Staging reserve(size_t bytes)
+    {
+        Staging staging;
+        if (!mapped || bytes == 0)
+            return staging;
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t at;
+        if (!place(align(bytes), at))
+        {
+            counters.refused++;
+            return staging;
+        }
+        blocks.push_back({ at, align(bytes), RESERVED, 0 });
+        staging.offset = at;
+        staging.size = bytes;
+        staging.pixels = mapped + at;
+        return staging;
+    }
+    bool fits(size_t bytes) const
+    {
+        return mapped && align(bytes) <= size;
+    }
+    // define a texture from the mip chain written to a block, on the GL thread. the block is fenced and
+    // returns to the ring once the GPU has consumed it
+    // ------------------------------------------------------------------------
+    void upload(Texture &texture, const Staging &staging, const MipChain &chain, int rowAlignment = 1)
+    {
+        issue(staging, [&](const unsigned char *levels) { texture.upload(levels, chain, rowAlignment); });
+    }
+    // the same for block compressed levels (includes/ktx2.h)
+    // ------------------------------------------------------------------------
+    void upload(Texture &texture, const Staging &staging, BlockFormat format, const std::vector<MipLevel> &levels)
+    {
+        issue(staging, [&](const unsigned char *blocks) { texture.upload(blocks, format, levels); });
+    }
+    // run any uploads reading a block, define() gets the block's offset as its pointer, and fence them.
+    // for targets other than a Texture, like the layers of a TextureArray (includes/texture_array.h)
+    // ------------------------------------------------------------------------
+    template <typename Define>
+    void issue(const Staging &staging, Define define)
+    {
+        auto start = std::chrono::steady_clock::now();
+        Timing timing = { 0, staging.size };
+        glGenQueries(1, &timing.query);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ID);
+        glBeginQuery(GL_TIME_ELAPSED, timing.query);
+        define(reinterpret_cast<const unsigned char *>(staging.offset));
+        glEndQuery(GL_TIME_ELAPSED);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        double issued = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        timings.push_back(timing);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        Block *block = find(staging);
+        if (block)
+        {
+            block->state = UPLOADED;
+            block->fence = fence;
+        }
+        else
+            glDeleteSync(fence);
+        counters.bytes += staging.size;
+        counters.uploads++;
+        counters.cpuMilliseconds += issued;
+    }
+    // give back a block that will not be uploaded after all
+    // ------------------------------------------------------------------------
+    void discard(const Staging &staging)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Block *block = find(staging);
+        if (block)
+            block->state = DISCARDED;
+    }
+    // hand back the blocks whose uploads have completed and collect finished timer queries, without
+    // waiting for the GPU. call once per frame on the GL thread; returns the number of bytes freed
+    // ------------------------------------------------------------------------
+    size_t retire()
+    {
+        while (!timings.empty())
+        {
+            GLint available = GL_FALSE;
+            glGetQueryObjectiv(timings.front().query, GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available)
+                break;
+            GLuint64 elapsed = 0;
+            glGetQueryObjectui64v(timings.front().query, GL_QUERY_RESULT, &elapsed);
+            glDeleteQueries(1, &timings.front().query);
+            std::lock_guard<std::mutex> lock(mutex);
+            counters.gpuMilliseconds += elapsed / 1.0e6;
+            counters.timedBytes += timings.front().bytes;
+            timings.pop_front();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t freed = 0;
+        while (!blocks.empty())
+        {
+            Block &block = blocks.front();
+            if (block.state == RESERVED)
+                break; // still being written or waiting for its upload, everything after it waits too
+            if (block.state == UPLOADED)
+            {
+                if (glClientWaitSync(block.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0) == GL_TIMEOUT_EXPIRED)
+                    break;
+                glDeleteSync(block.fence);
+            }
+            freed += block.size;
+            blocks.pop_front();
+        }
+        return freed;
+    }
+    // bytes reserved and not yet handed back
+    // ------------------------------------------------------------------------
+    size_t used()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t bytes = 0;
+        for (const Block &block : blocks)
+            bytes += block.size;
+        return bytes;
+    }
+    Stats stats()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return counters;
+    }
+
+private:
+    enum BlockState
+    {
+        RESERVED,
+        UPLOADED,
+        DISCARDED
+    };
+    struct Block
+    {
+        size_t offset;
+        size_t size;
+        BlockState state;
+        GLsync fence;
+    };
+    struct Timing
+    {
+        GLuint query;
+        size_t bytes;
+    };
+    // blocks start on 256 byte boundaries, plenty for any pixel or SIMD store alignment
+    static const size_t alignment = 256;
+
+    size_t size;
+    unsigned char *mapped = nullptr;
+    std::deque<Timing> timings; // GL thread only
+
+    // guarded by mutex
+    std::deque<Block> blocks; // oldest first, in address order modulo one wrap
+    Stats counters;
+    std::mutex mutex;
+
+    // ------------------------------------------------------------------------
+    static size_t align(size_t value)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+    // where a block of bytes can go: after the newest block, or at the start of the buffer if the
+    // space up to the end is too short and the oldest block has moved past it
+    // ------------------------------------------------------------------------
+    bool place(size_t bytes, size_t &at) const
+    {
+        if (bytes > size)
+            return false;
+        if (blocks.empty())
+        {
+            at = 0;
+            return true;
+        }
+        size_t tail = blocks.front().offset;
+        size_t head = blocks.back().offset + blocks.back().size;
+        bool wrapped = blocks.back().offset < tail;
+        if (!wrapped)
+        {
+            if (head + bytes <= size)
+            {
+                at = head;
+                return true;
+            }
+            if (bytes <= tail)
+            {
+                at = 0;
+                return true;
+            }
+            return false;
+        }
+        if (head + bytes <= tail)
+        {
+            at = head;
+            return true;
+        }
+        return false;
+    }
+    Block* find(const Staging &staging)
+    {
+        for (Block &block : blocks)
+            if (block.offset == staging.offset && block.state == RESERVED)
+                return &block;
+        return nullptr;
+    }
+};
+#endif
@@ -0,0 +1,144 @@
+#ifndef PROCEDURAL_ANIMATION_H
+#define PROCEDURAL_ANIMATION_H
+
+#include <glad/glad.h>
+
+#include <../includes/glm/glm/glm.hpp>
+#include <../includes/glm/glm/gtc/matrix_transform.hpp>
+#include <../includes/shader_s.h>
+#include <../includes/uniform_ring.h>
+#include <../includes/shader_uniforms_data.h>
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+// static parameters of one animated object, laid out as the two vec4 instance attributes of
+// src/common/animation.glsl
+struct AnimatedInstance
+{
+    glm::vec3 position;
+    float angularSpeed; // degrees per second
+    glm::vec3 axis;
+    float startAngle;   // degrees
+};
+
+// Objects that spin in place, animated on the GPU. The parameters are uploaded once into an
+// instance buffer and a single time uniform drives the rotation in the vertex shader, so a frame
+// costs one uniform and one instanced draw however many objects there are. The program must be
+// built with PROCEDURAL_ANIMATION (src/cubes.vs).
+//
+// drawOnCpu() is the reference path: it builds the same matrices with modelMatrix() and draws every
+// object with its own Object block, for validating the shader against it. modelMatrixError() checks
+// modelMatrix() itself against glm::translate/glm::rotate.
+class ProceduralAnimation
+{
+public:
+    unsigned int ID;
+
+    ProceduralAnimation()
+    {
+        glGenBuffers(1, &ID);
+    }
+    ~ProceduralAnimation()
+    {
+        glDeleteBuffers(1, &ID);
+    }
+    ProceduralAnimation(const ProceduralAnimation&) = delete;
+    ProceduralAnimation& operator=(const ProceduralAnimation&) = delete;
+
+    // upload the parameters of every object, rotation axes are normalized here like glm::rotate does
+    // ------------------------------------------------------------------------
+    void setInstances(const std::vector<AnimatedInstance> &instances)
+    {
+        this->instances = instances;
+        for (AnimatedInstance &instance : this->instances)
+            instance.axis = glm::normalize(instance.axis);
+        glBindBuffer(GL_ARRAY_BUFFER, ID);
+        glBufferData(GL_ARRAY_BUFFER, this->instances.size() * sizeof(AnimatedInstance), this->instances.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+    // add the instance attributes (locations 2 and 3) to a mesh's vertex array
+    // ------------------------------------------------------------------------
+    void attach(unsigned int VAO) const
+    {
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, ID);
+        glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(AnimatedInstance), (void*)0);
+        glEnableVertexAttribArray(2);
+        glVertexAttribDivisor(2, 1);
+        glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(AnimatedInstance), (void*)(4 * sizeof(float)));
+        glEnableVertexAttribArray(3);
+        glVertexAttribDivisor(3, 1);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+    // draw every object with the attached mesh bound and the animated program in use. timeUniform is
+    // the program's "time", resolved once with shader.uniform<float>("time")
+    // ------------------------------------------------------------------------
+    void draw(Shader &shader, Uniform<float> timeUniform, float time, GLenum mode, GLsizei vertexCount) const
+    {
+        shader.set(timeUniform, time);
+        glDrawArraysInstanced(mode, 0, vertexCount, (GLsizei)instances.size());
+    }
+    // the same frame built on the CPU, one draw per object with a program reading the Object block.
+    // the ring region must hold an Object block for every instance
+    // ------------------------------------------------------------------------
+    void drawOnCpu(UniformRing &ring, float time, GLenum mode, GLsizei vertexCount) const
+    {
+        ObjectUniformBlock object;
+        for (const AnimatedInstance &instance : instances)
+        {
+            object.model = modelMatrix(instance, time);
+            if (!ring.push(OBJECT_BLOCK_BINDING, object))
+                return;
+            glDrawArrays(mode, 0, vertexCount);
+        }
+    }
+    // CPU mirror of spinModel() in src/common/spin.glsl. the axis must be normalized
+    // ------------------------------------------------------------------------
+    static glm::mat4 modelMatrix(const AnimatedInstance &instance, float time)
+    {
+        float degrees = instance.angularSpeed * time + instance.startAngle;
+        degrees -= 360.0f * std::floor(degrees / 360.0f); // GLSL mod()
+        float angle = glm::radians(degrees);
+        float c = std::cos(angle);
+        float s = std::sin(angle);
+        glm::vec3 axis = instance.axis;
+        glm::vec3 t = (1.0f - c) * axis;
+        return glm::mat4(
+            glm::vec4(c + t.x * axis.x,          t.x * axis.y + s * axis.z, t.x * axis.z - s * axis.y, 0.0f),
+            glm::vec4(t.y * axis.x - s * axis.z, c + t.y * axis.y,          t.y * axis.z + s * axis.x, 0.0f),
+            glm::vec4(t.z * axis.x + s * axis.y, t.z * axis.y - s * axis.x, c + t.z * axis.z,          0.0f),
+            glm::vec4(instance.position, 1.0f));
+    }
+    // largest difference between modelMatrix() and the glm::translate/glm::rotate matrix of every
+    // object at the given time
+    // ------------------------------------------------------------------------
+    float modelMatrixError(float time) const
+    {
+        float error = 0.0f;
+        for (const AnimatedInstance &instance : instances)
+        {
+            glm::mat4 model = modelMatrix(instance, time);
+            glm::mat4 reference = glm::translate(glm::mat4(1.0f), instance.position);
+            reference = glm::rotate(reference, glm::radians(instance.angularSpeed * time + instance.startAngle), instance.axis);
+            for (int column = 0; column < 4; column++)
+                for (int row = 0; row < 4; row++)
+                    error = std::max(error, std::fabs(model[column][row] - reference[column][row]));
+        }
+        return error;
+    }
+    // the uploaded parameters, axes normalized
+    const std::vector<AnimatedInstance>& parameters() const
+    {
+        return instances;
+    }
+    size_t size() const
+    {
+        return instances.size();
+    }
+
+private:
+    std::vector<AnimatedInstance> instances;
+};
+#endif
@@ -0,0 +1,78 @@
+#ifndef PROGRAM_PIPELINE_H
+#define PROGRAM_PIPELINE_H
+
+#include <glad/glad.h>
+
+#include <../includes/shader_s.h>
+
+#include <map>
+#include <utility>
+
+// Combines separable single-stage programs (Shader(GL_VERTEX_SHADER, ...), Shader(GL_FRAGMENT_SHADER, ...))
+// in program pipeline objects. One vertex stage is compiled once and paired with any number of
+// fragment stages, instead of linking the same vertex shader into every vertex+fragment program.
+// A pipeline is created the first time a pair is bound and reused afterwards.
+class PipelineCache
+{
+public:
+    PipelineCache() = default;
+    ~PipelineCache()
+    {
+        for (auto &entry : pipelines)
+            glDeleteProgramPipelines(1, &entry.second.pipeline);
+    }
+    PipelineCache(const PipelineCache&) = delete;
+    PipelineCache& operator=(const PipelineCache&) = delete;
+
+    static bool supported()
+    {
+        return GLAD_GL_VERSION_4_1 || GLAD_GL_ARB_separate_shader_objects;
+    }
+    // make the pair current for drawing. a program installed with glUseProgram takes precedence
+    // over the bound pipeline, so that is cleared first
+    // ------------------------------------------------------------------------
+    unsigned int bind(Shader &vertexStage, Shader &fragmentStage)
+    {
+        unsigned int pipeline = get(vertexStage, fragmentStage);
+        glUseProgram(0);
+        glBindProgramPipeline(pipeline);
+        return pipeline;
+    }
+    // the pipeline object for a pair, created on first request
+    // ------------------------------------------------------------------------
+    unsigned int get(Shader &vertexStage, Shader &fragmentStage)
+    {
+        vertexStage.resolve();
+        fragmentStage.resolve();
+        Entry &entry = pipelines[{ &vertexStage, &fragmentStage }];
+        if (entry.pipeline == 0)
+            glGenProgramPipelines(1, &entry.pipeline);
+        // a hot reload swaps a stage's program ID, attach the current one again when that happened
+        if (entry.vertexProgram != vertexStage.ID)
+        {
+            glUseProgramStages(entry.pipeline, GL_VERTEX_SHADER_BIT, vertexStage.ID);
+            entry.vertexProgram = vertexStage.ID;
+        }
+        if (entry.fragmentProgram != fragmentStage.ID)
+        {
+            glUseProgramStages(entry.pipeline, GL_FRAGMENT_SHADER_BIT, fragmentStage.ID);
+            entry.fragmentProgram = fragmentStage.ID;
+        }
+        return entry.pipeline;
+    }
+    // number of pipeline objects created so far
+    size_t size() const
+    {
+        return pipelines.size();
+    }
+
+private:
+    struct Entry
+    {
+        unsigned int pipeline = 0;
+        unsigned int vertexProgram = 0;
+        unsigned int fragmentProgram = 0;
+    };
+    std::map<std::pair<const Shader *, const Shader *>, Entry> pipelines;
+};
+#endif
@@ -0,0 +1,104 @@
+#ifndef PROGRAM_REGISTRY_H
+#define PROGRAM_REGISTRY_H
+
+#include <glad/glad.h>
+
+#include <../includes/shader_s.h>
+#include <../includes/hash.h>
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+
+// Hands out shared programs. Requests are keyed on the preprocessed stage sources (includes expanded,
+// defines injected), so two scenes asking for the same program - or for different files that end up
+// as the same source, like light_cube_13 and light_cube_14 - get the same Shader and the driver
+// compiles it once. The registry only holds weak references: a program is deleted when the last
+// shared_ptr to it goes away, and the next request for it compiles it again.
+//
+// Users of a shared Shader share its uniform values as well, set everything a draw needs before it.
+class ProgramRegistry
+{
+public:
+    // counters since the registry was created
+    struct Stats
+    {
+        unsigned int shared = 0;   // requests answered with a live program
+        unsigned int compiled = 0; // requests that built a new one
+    };
+
+    // ------------------------------------------------------------------------
+    std::shared_ptr<Shader> get(const char* vertexPath, const char* fragmentPath, const std::vector<std::string> &defines = {})
+    {
+        return get({ Shader::fileStage(GL_VERTEX_SHADER, vertexPath), Shader::fileStage(GL_FRAGMENT_SHADER, fragmentPath) },
+                   defines, false);
+    }
+    std::shared_ptr<Shader> get(ShaderPackId vertexId, ShaderPackId fragmentId, const std::vector<std::string> &defines = {})
+    {
+        return get({ Shader::packStage(GL_VERTEX_SHADER, vertexId), Shader::packStage(GL_FRAGMENT_SHADER, fragmentId) },
+                   defines, false);
+    }
+    // a single stage, separable unless it is a compute stage (see the matching Shader constructor)
+    std::shared_ptr<Shader> get(GLenum stage, ShaderPackId id, const std::vector<std::string> &defines = {})
+    {
+        return get({ Shader::packStage(stage, id) }, defines, stage != GL_COMPUTE_SHADER);
+    }
+    // programs currently alive
+    // ------------------------------------------------------------------------
+    size_t size()
+    {
+        prune();
+        return programs.size();
+    }
+    const Stats& stats() const
+    {
+        return counters;
+    }
+
+private:
+    std::unordered_map<std::uint64_t, std::weak_ptr<Shader>> programs;
+    Stats counters;
+
+    // ------------------------------------------------------------------------
+    std::shared_ptr<Shader> get(const std::vector<Shader::StageSource> &stages, const std::vector<std::string> &defines, bool separable)
+    {
+        std::vector<std::string> dependencies;
+        std::vector<std::string> sources = Shader::loadSources(stages, defines, separable, dependencies);
+        std::uint64_t key = hashString(separable ? "separable" : "linked");
+        for (size_t i = 0; i < stages.size(); i++)
+        {
+            key = hashBytes(reinterpret_cast<const char *>(&stages[i].type), sizeof(GLenum), key);
+            key = hashString(sources[i], key);
+            key = hashBytes("\0", 1, key);
+        }
+
+        std::weak_ptr<Shader> &entry = programs[key];
+        std::shared_ptr<Shader> shader = entry.lock();
+        // the hash only finds the candidate, the sources decide. a program reloaded from edited files
+        // no longer matches what its key was made from
+        if (shader && shader->sources == sources)
+        {
+            counters.shared++;
+            return shader;
+        }
+        shader.reset(new Shader(stages, defines, separable, sources, dependencies));
+        entry = shader;
+        counters.compiled++;
+        prune();
+        return shader;
+    }
+    // drop the entries of programs nobody uses anymore
+    // ------------------------------------------------------------------------
+    void prune()
+    {
+        for (auto it = programs.begin(); it != programs.end();)
+        {
+            if (it->second.expired())
+                it = programs.erase(it);
+            else
+                ++it;
+        }
+    }
+};
+#endif
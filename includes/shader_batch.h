@@ -0,0 +1,69 @@
+#ifndef SHADER_BATCH_H
+#define SHADER_BATCH_H
+
+#include <../includes/shader_s.h>
+#include <../includes/program_registry.h>
+
+#include <memory>
+#include <vector>
+
+// Submits a group of programs to the driver back to back without waiting on any of them.
+// With KHR_parallel_shader_compile the driver compiles them on its own threads while the
+// application carries on (loading textures, building buffers); poll() reports when they are done.
+// Each Shader still checks its status and logs errors lazily, on its first use(). Programs requested
+// through a ProgramRegistry are shared, the batch keeps its reference to them alive.
+class ShaderBatch
+{
+public:
+    ShaderBatch()
+    {
+        Shader::enableParallelCompile();
+    }
+    // start compiling a program. the returned reference stays valid for the lifetime of the batch
+    // ------------------------------------------------------------------------
+    Shader& submit(const char* vertexPath, const char* fragmentPath)
+    {
+        shaders.push_back(std::make_unique<Shader>(vertexPath, fragmentPath));
+        return *shaders.back();
+    }
+    Shader& submit(ShaderPackId vertexId, ShaderPackId fragmentId)
+    {
+        shaders.push_back(std::make_unique<Shader>(vertexId, fragmentId));
+        return *shaders.back();
+    }
+    // a live program with the same sources is returned as it is, compiled or not
+    Shader& submit(ProgramRegistry &registry, ShaderPackId vertexId, ShaderPackId fragmentId)
+    {
+        shaders.push_back(registry.get(vertexId, fragmentId));
+        return *shaders.back();
+    }
+    // non-blocking: number of submitted programs the driver has finished with
+    // ------------------------------------------------------------------------
+    size_t poll() const
+    {
+        size_t done = 0;
+        for (const std::shared_ptr<Shader> &shader : shaders)
+            if (shader->ready())
+                done++;
+        return done;
+    }
+    bool ready() const
+    {
+        return poll() == shaders.size();
+    }
+    // block until every program is linked and report any errors now rather than on first use
+    // ------------------------------------------------------------------------
+    void wait()
+    {
+        for (std::shared_ptr<Shader> &shader : shaders)
+            shader->resolve();
+    }
+    size_t size() const
+    {
+        return shaders.size();
+    }
+
+private:
+    std::vector<std::shared_ptr<Shader>> shaders;
+};
+#endif
@@ -0,0 +1,146 @@
+#ifndef SHADER_CACHE_H
+#define SHADER_CACHE_H
+
+#include <glad/glad.h>
+#include <../includes/hash.h>
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdlib>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+
+// On-disk cache of linked program binaries (glGetProgramBinary / glProgramBinary).
+// Entries are keyed on the shader sources plus the GL vendor, renderer and version strings,
+// so a driver update or a different GPU simply misses instead of loading a stale binary.
+// Set SHADER_CACHE_DIR to move the cache, or to an empty string to turn it off.
+class ShaderCache
+{
+public:
+    // ------------------------------------------------------------------------
+    static bool enabled()
+    {
+        static const bool supported = [] {
+            if (!(GLAD_GL_VERSION_4_1 || GLAD_GL_ARB_get_program_binary))
+                return false;
+            GLint formats = 0;
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+            return formats > 0;
+        }();
+        return supported && !directory().empty();
+    }
+    // ------------------------------------------------------------------------
+    static std::string directory()
+    {
+        const char *dir = std::getenv("SHADER_CACHE_DIR");
+        return dir ? std::string(dir) : std::string("shader_cache");
+    }
+    // key for a set of stage sources on the current driver
+    // ------------------------------------------------------------------------
+    static std::uint64_t key(const std::vector<std::string> &sources)
+    {
+        std::uint64_t hash = FNV_OFFSET_BASIS;
+        for (const std::string &source : sources)
+        {
+            hash = hashString(source, hash);
+            hash = hashBytes("\0", 1, hash); // keep "ab"+"c" and "a"+"bc" apart
+        }
+        const GLenum strings[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+        for (GLenum name : strings)
+        {
+            const char *value = reinterpret_cast<const char *>(glGetString(name));
+            hash = hashString(value ? value : "", hash);
+        }
+        return hash;
+    }
+    // try to fill program from the cache. returns false on a miss or when the driver rejects the binary,
+    // in which case the caller should compile from source (the program may be left in a failed link state)
+    // ------------------------------------------------------------------------
+    static bool load(unsigned int program, std::uint64_t key)
+    {
+        if (!enabled())
+            return false;
+        std::ifstream file(path(key), std::ios::binary);
+        if (!file)
+            return false;
+        Header header;
+        if (!file.read(reinterpret_cast<char *>(&header), sizeof(header)) || header.magic != MAGIC)
+            return false;
+        std::vector<char> binary(header.length);
+        if (!file.read(binary.data(), header.length))
+            return false;
+
+        glProgramBinary(program, header.format, binary.data(), (GLsizei)binary.size());
+        GLint success = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        if (!success)
+        {
+            // stale or foreign binary, drop it so the next launch doesn't try again
+            std::error_code ignored;
+            std::filesystem::remove(path(key), ignored);
+            return false;
+        }
+        return true;
+    }
+    // write a linked program to the cache. the program should have been linked with
+    // GL_PROGRAM_BINARY_RETRIEVABLE_HINT set, see prepare()
+    // ------------------------------------------------------------------------
+    static void store(unsigned int program, std::uint64_t key)
+    {
+        if (!enabled())
+            return;
+        GLint length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0)
+            return;
+        std::vector<char> binary(length);
+        Header header;
+        header.magic = MAGIC;
+        glGetProgramBinary(program, length, NULL, &header.format, binary.data());
+        header.length = (std::uint32_t)length;
+
+        std::error_code error;
+        std::filesystem::create_directories(directory(), error);
+        // write to a temporary name first so a concurrent launch never reads half a file
+        std::string finalPath = path(key);
+        std::string tempPath = finalPath + ".tmp";
+        {
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+            if (!file)
+                return;
+            file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            file.write(binary.data(), length);
+            if (!file)
+                return;
+        }
+        std::filesystem::rename(tempPath, finalPath, error);
+    }
+    // must be called before glLinkProgram for the binary to be retrievable afterwards
+    // ------------------------------------------------------------------------
+    static void prepare(unsigned int program)
+    {
+        if (enabled())
+            glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+
+private:
+    static constexpr std::uint32_t MAGIC = 0x4e494250; // "PBIN"
+
+    struct Header
+    {
+        std::uint32_t magic;
+        GLenum format;
+        std::uint32_t length;
+    };
+
+    // ------------------------------------------------------------------------
+    static std::string path(std::uint64_t key)
+    {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+        return directory() + "/" + name;
+    }
+};
+#endif
@@ -0,0 +1,31 @@
+#ifndef SHADER_PACK_H
+#define SHADER_PACK_H
+
+#include <../includes/shader_pack_data.h>
+
+#include <string>
+#include <cstdlib>
+
+// Runtime side of the compiled-in shader pack. includes/shader_pack_data.h is generated by
+// tools/shader_pack.cpp from every .vs/.fs/.cs under src/ with the #includes already expanded,
+// so building a Shader from a ShaderPackId reads nothing from disk.
+//
+// For development set SHADER_SOURCE_DIR to the repository root: pack ids then load
+// <root>/<path> from disk through the preprocessor instead, which makes them editable
+// and hot-reloadable without regenerating the pack.
+
+// ------------------------------------------------------------------------
+inline const ShaderPackEntry& shaderPackEntry(ShaderPackId id)
+{
+    return SHADER_PACK[id];
+}
+// the on-disk override for a pack entry, or an empty string when the embedded source should be used
+// ------------------------------------------------------------------------
+inline std::string shaderPackOverridePath(ShaderPackId id)
+{
+    const char *root = std::getenv("SHADER_SOURCE_DIR");
+    if (!root || !*root)
+        return std::string();
+    return std::string(root) + "/" + SHADER_PACK[id].path;
+}
+#endif
@@ -0,0 +1,898 @@
+// generated by tools/shader_pack.cpp - do not edit, rerun the tool instead
+#ifndef SHADER_PACK_DATA_H
+#define SHADER_PACK_DATA_H
+
+#include <cstdint>
+
+enum ShaderPackId
+{
+    SHADER_ANIMATE_INSTANCES_CS,
+    SHADER_CUBES_FS,
+    SHADER_CUBES_VS,
+    SHADER_PART1_SHADER_FS,
+    SHADER_PART1_SHADER_VS,
+    SHADER_PART1_SHADER_10_FS,
+    SHADER_PART1_SHADER_10_VS,
+    SHADER_PART1_SHADER_9_FS,
+    SHADER_PART1_SHADER_9_VS,
+    SHADER_PART1_TEXTURE_FS,
+    SHADER_PART1_TEXTURE_VS,
+    SHADER_PART2_COLOR_13_FS,
+    SHADER_PART2_COLOR_13_VS,
+    SHADER_PART2_LIGHT_CUBE_13_FS,
+    SHADER_PART2_LIGHT_CUBE_13_VS,
+    SHADER_PART2_LIGHT_CUBE_14_FS,
+    SHADER_PART2_LIGHT_CUBE_14_VS,
+    SHADER_PART2_LIGHT_CUBE_15_FS,
+    SHADER_PART2_LIGHT_CUBE_15_VS,
+    SHADER_PART2_PHONG_FS,
+    SHADER_PART2_PHONG_VS,
+    SHADER_PACK_COUNT
+};
+
+struct ShaderPackEntry
+{
+    const char *path;
+    const char *source;
+    std::uint64_t hash; // hashString(source), see includes/hash.h
+};
+
+constexpr ShaderPackEntry SHADER_PACK[SHADER_PACK_COUNT] = {
+    { "src/animate_instances.cs", R"GLSL(#version 430 core
+// The procedural animation of includes/procedural_animation.h evaluated by a compute program: one
+// invocation per instance writes its model matrix for the given time. Reads the instance buffer of
+// ProceduralAnimation as it is, see tools/compute_check.cpp.
+#line 1 1
+// translate(position) * rotate(angle, axis) of one procedurally animated instance, the same matrix
+// glm::translate + glm::rotate build. positionSpeed is the xyz world position and the angular speed in
+// degrees per second, axisStart the normalized rotation axis and the start angle in degrees: the
+// AnimatedInstance layout of includes/procedural_animation.h. Shared by the vertex path
+// (animation.glsl) and the compute path (animate_instances.cs), it must stay in step with
+// ProceduralAnimation::modelMatrix().
+
+mat4 spinModel(vec4 positionSpeed, vec4 axisStart, float time)
+{
+    // wrapped to one turn so sin/cos stay accurate however long the program runs
+    float angle = radians(mod(positionSpeed.w * time + axisStart.w, 360.0));
+    float c = cos(angle);
+    float s = sin(angle);
+    vec3 axis = axisStart.xyz;
+    vec3 t = (1.0 - c) * axis;
+    return mat4(
+        vec4(c + t.x * axis.x,          t.x * axis.y + s * axis.z, t.x * axis.z - s * axis.y, 0.0),
+        vec4(t.y * axis.x - s * axis.z, c + t.y * axis.y,          t.y * axis.z + s * axis.x, 0.0),
+        vec4(t.z * axis.x + s * axis.y, t.z * axis.y - s * axis.x, c + t.z * axis.z,          0.0),
+        vec4(positionSpeed.xyz, 1.0));
+}
+#line 6 0
+
+layout (local_size_x = 64) in;
+
+// two vec4s per instance, AnimatedInstance
+layout (std430, binding = 0) readonly buffer Instances {
+    vec4 instances[];
+};
+layout (std430, binding = 1) writeonly buffer Models {
+    mat4 models[];
+};
+
+uniform float time;
+uniform uint count;
+
+void main()
+{
+    uint i = gl_GlobalInvocationID.x;
+    if (i >= count)
+        return;
+    models[i] = spinModel(instances[2u * i], instances[2u * i + 1u], time);
+}
+)GLSL", 0x74cee53f1462d0e3ull },
+    { "src/cubes.fs", R"GLSL(#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoord;
+
+// texture samplers: layers of array textures (includes/texture_array.h), each image at its own layer
+// and uv rectangle (offset xy, scale zw) within it
+uniform sampler2DArray texture1;
+uniform sampler2DArray texture2;
+uniform vec4 texture1Rect;
+uniform vec4 texture2Rect;
+uniform float texture1Layer;
+uniform float texture2Layer;
+
+vec4 sampleRegion(sampler2DArray textures, vec4 rect, float layer)
+{
+	return texture(textures, vec3(rect.xy + TexCoord * rect.zw, layer));
+}
+
+void main()
+{
+	// linearly interpolate between both textures (80% container, 20% awesomeface)
+	FragColor = mix(sampleRegion(texture1, texture1Rect, texture1Layer), sampleRegion(texture2, texture2Rect, texture2Layer), 0.2);
+}
+)GLSL", 0xf8c4dbe219b29a0full },
+    { "src/cubes.vs", R"GLSL(#version 330 core
+#line 1 1
+// Per-frame camera data, uploaded once per frame by CameraBuffer (includes/camera_buffer.h)
+// and shared by every program through uniform block binding point 0.
+
+layout (std140) uniform Camera {
+    mat4 projection;
+    mat4 view;
+    vec3 viewPos;
+};
+#line 3 0
+#ifdef PROCEDURAL_ANIMATION
+#line 1 2
+// Procedural animation: every instance spins about its own axis at its own speed, driven by a
+// single time uniform. The per-instance parameters come from the instance buffer of
+// ProceduralAnimation (includes/procedural_animation.h); the matrix itself is spinModel(), which
+// ProceduralAnimation::modelMatrix() mirrors on the CPU to validate it.
+
+#line 1 3
+// translate(position) * rotate(angle, axis) of one procedurally animated instance, the same matrix
+// glm::translate + glm::rotate build. positionSpeed is the xyz world position and the angular speed in
+// degrees per second, axisStart the normalized rotation axis and the start angle in degrees: the
+// AnimatedInstance layout of includes/procedural_animation.h. Shared by the vertex path
+// (animation.glsl) and the compute path (animate_instances.cs), it must stay in step with
+// ProceduralAnimation::modelMatrix().
+
+mat4 spinModel(vec4 positionSpeed, vec4 axisStart, float time)
+{
+    // wrapped to one turn so sin/cos stay accurate however long the program runs
+    float angle = radians(mod(positionSpeed.w * time + axisStart.w, 360.0));
+    float c = cos(angle);
+    float s = sin(angle);
+    vec3 axis = axisStart.xyz;
+    vec3 t = (1.0 - c) * axis;
+    return mat4(
+        vec4(c + t.x * axis.x,          t.x * axis.y + s * axis.z, t.x * axis.z - s * axis.y, 0.0),
+        vec4(t.y * axis.x - s * axis.z, c + t.y * axis.y,          t.y * axis.z + s * axis.x, 0.0),
+        vec4(t.z * axis.x + s * axis.y, t.z * axis.y - s * axis.x, c + t.z * axis.z,          0.0),
+        vec4(positionSpeed.xyz, 1.0));
+}
+#line 7 2
+
+layout (location = 2) in vec4 aInstancePosition; // xyz world position, w angular speed in degrees per second
+layout (location = 3) in vec4 aInstanceAxis;     // xyz normalized rotation axis, w start angle in degrees
+
+uniform float time;
+
+mat4 animatedModel()
+{
+    return spinModel(aInstancePosition, aInstanceAxis, time);
+}
+#line 5 0
+#else
+#define OBJECT_BLOCK
+#line 1 4
+// Per-object data. With OBJECT_BLOCK defined it is read from a range of the per-frame uniform ring
+// (includes/uniform_ring.h) bound at binding point 1, otherwise it is a plain uniform.
+
+#ifdef OBJECT_BLOCK
+layout (std140) uniform Object {
+    mat4 model;
+};
+#else
+uniform mat4 model;
+#endif
+#line 8 0
+#endif
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoord;
+
+out vec2 TexCoord;
+
+void main()
+{
+#ifdef PROCEDURAL_ANIMATION
+	mat4 model = animatedModel();
+#endif
+	gl_Position = projection * view * model * vec4(aPos, 1.0);
+	TexCoord = vec2(aTexCoord.x, aTexCoord.y);
+}
+)GLSL", 0xcb1cfdd41b8a4e2full },
+    { "src/part1/shader.fs", R"GLSL(#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoord;
+
+// texture samplers
+uniform sampler2D texture1;
+uniform sampler2D texture2;
+
+void main()
+{
+	// linearly interpolate between both textures (80% container, 20% awesomeface)
+	FragColor = mix(texture(texture1, TexCoord), texture(texture2, TexCoord), 0.2);
+}
+)GLSL", 0xda7a6c5ebf4e531full },
+    { "src/part1/shader.vs", R"GLSL(#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoord;
+
+out vec2 TexCoord;
+
+uniform mat4 transform;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+	gl_Position = projection * view * model * vec4(aPos, 1.0);
+	TexCoord = vec2(aTexCoord.x, aTexCoord.y);
+}
+)GLSL", 0x4fb302f8e741f000ull },
+    { "src/part1/shader_10.fs", R"GLSL(#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoord;
+
+// texture samplers
+uniform sampler2D texture1;
+uniform sampler2D texture2;
+
+void main()
+{
+	// linearly interpolate between both textures (80% container, 20% awesomeface)
+	FragColor = mix(texture(texture1, TexCoord), texture(texture2, TexCoord), 0.2);
+}
+)GLSL", 0xda7a6c5ebf4e531full },
+    { "src/part1/shader_10.vs", R"GLSL(#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoord;
+
+out vec2 TexCoord;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+	gl_Position = projection * view * model * vec4(aPos, 1.0);
+	TexCoord = vec2(aTexCoord.x, aTexCoord.y);
+}
+)GLSL", 0x71bd2838b8319b2dull },
+    { "src/part1/shader_9.fs", R"GLSL(#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoord;
+
+// texture samplers
+uniform sampler2D texture1;
+uniform sampler2D texture2;
+
+void main()
+{
+	// linearly interpolate between both textures (80% container, 20% awesomeface)
+	FragColor = mix(texture(texture1, TexCoord), texture(texture2, TexCoord), 0.2);
+}
+)GLSL", 0xda7a6c5ebf4e531full },
+    { "src/part1/shader_9.vs", R"GLSL(#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoord;
+
+out vec2 TexCoord;
+
+uniform mat4 transform;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+	gl_Position = projection * view * model * vec4(aPos, 1.0);
+	TexCoord = vec2(aTexCoord.x, aTexCoord.y);
+}
+)GLSL", 0x4fb302f8e741f000ull },
+    { "src/part1/texture.fs", R"GLSL(#version 330 core
+out vec4 FragColor;
+
+in vec3 ourColor;
+in vec2 TexCoord;
+
+// texture samplers
+uniform sampler2D texture1;
+uniform sampler2D texture2;
+
+void main()
+{
+// 	linearly interpolate between both textures (80% container, 20% awesomeface)
+	FragColor = mix(texture(texture1, TexCoord), texture(texture2, TexCoord), 0.2);
+}
+)GLSL", 0x7a0aaf32ed80d527ull },
+    { "src/part1/texture.vs", R"GLSL(#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aColor;
+layout (location = 2) in vec2 aTexCoord;
+
+out vec3 ourColor;
+out vec2 TexCoord;
+
+void main()
+{
+	gl_Position = vec4(aPos, 1.0);
+	ourColor = aColor;
+	TexCoord = vec2(aTexCoord.x, aTexCoord.y);
+}
+)GLSL", 0x5c0d57a3616a82afull },
+    { "src/part2/color_13.fs", R"GLSL(#version 330 core
+
+out vec4 FragColor;
+
+in vec3 Normal;
+in vec3 FragPos;
+
+uniform vec3 lightPos;
+uniform vec3 viewPos;
+uniform vec3 lightColor;
+uniform vec3 objectColor;
+
+void main()
+{
+    // ambient
+    float ambientStrength = 0.1;
+    vec3 ambient = ambientStrength * lightColor;
+
+    // diffuse
+    vec3 norm = normalize(Normal);
+    vec3 lightDirection = normalize(lightPos - FragPos);
+
+    float diff = max(dot(norm, lightDirection), 0.0);
+    vec3 diffuse = diff * lightColor;
+//
+    // specular
+    float specularStrength = 0.7;
+
+    vec3 viewDir = normalize(viewPos - FragPos);
+    vec3 reflectDir = reflect(-lightDirection, norm);
+
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32);
+    vec3 specular = specularStrength * spec * lightColor;
+
+    // add all components together
+    vec3 result = (ambient + diffuse + specular) * objectColor;
+    FragColor = vec4(result, 1.0);
+}
+)GLSL", 0xbde73c0a7fa2e246ull },
+    { "src/part2/color_13.vs", R"GLSL(#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+
+out vec3 FragPos;
+out vec3 Normal;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+	FragPos = vec3(model * vec4(aPos, 1.0));
+	Normal = mat3(transpose(inverse(model))) * aNormal;
+
+	gl_Position = projection * view * model * vec4(aPos, 1.0);
+}
+)GLSL", 0xf28f261948dd8e99ull },
+    { "src/part2/light_cube_13.fs", R"GLSL(#version 330 core
+out vec4 FragColor;
+
+void main()
+{
+    FragColor = vec4(1.0); // set all 4 vector values to 1.0
+}
+)GLSL", 0x6a8de4ed51e5b662ull },
+    { "src/part2/light_cube_13.vs", R"GLSL(#version 330 core
+layout (location = 0) in vec3 aPos;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+	gl_Position = projection * view * model * vec4(aPos, 1.0);
+}
+)GLSL", 0x72fe40ee87d87746ull },
+    { "src/part2/light_cube_14.fs", R"GLSL(#version 330 core
+out vec4 FragColor;
+
+void main()
+{
+    FragColor = vec4(1.0); // set all 4 vector values to 1.0
+}
+)GLSL", 0x6a8de4ed51e5b662ull },
+    { "src/part2/light_cube_14.vs", R"GLSL(#version 330 core
+layout (location = 0) in vec3 aPos;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+	gl_Position = projection * view * model * vec4(aPos, 1.0);
+}
+)GLSL", 0x72fe40ee87d87746ull },
+    { "src/part2/light_cube_15.fs", R"GLSL(#version 330 core
+out vec4 FragColor;
+
+void main()
+{
+    FragColor = vec4(1.0); // set all 4 vector values to 1.0
+}
+)GLSL", 0x6a8de4ed51e5b662ull },
+    { "src/part2/light_cube_15.vs", R"GLSL(#version 330 core
+#line 1 1
+// Per-frame camera data, uploaded once per frame by CameraBuffer (includes/camera_buffer.h)
+// and shared by every program through uniform block binding point 0.
+
+layout (std140) uniform Camera {
+    mat4 projection;
+    mat4 view;
+    vec3 viewPos;
+};
+#line 3 0
+#define OBJECT_BLOCK
+#line 1 2
+// Per-object data. With OBJECT_BLOCK defined it is read from a range of the per-frame uniform ring
+// (includes/uniform_ring.h) bound at binding point 1, otherwise it is a plain uniform.
+
+#ifdef OBJECT_BLOCK
+layout (std140) uniform Object {
+    mat4 model;
+};
+#else
+uniform mat4 model;
+#endif
+#line 5 0
+
+layout (location = 0) in vec3 aPos;
+
+void main()
+{
+	gl_Position = projection * view * model * vec4(aPos, 1.0);
+}
+)GLSL", 0x6c9b7a579287d665ull },
+    { "src/part2/phong.fs", R"GLSL(#version 330 core
+#line 1 1
+// Per-frame camera data, uploaded once per frame by CameraBuffer (includes/camera_buffer.h)
+// and shared by every program through uniform block binding point 0.
+
+layout (std140) uniform Camera {
+    mat4 projection;
+    mat4 view;
+    vec3 viewPos;
+};
+#line 3 0
+#line 1 2
+// Phong lighting shared by the lit shaders. Feature bits (defined by the C++ side):
+//  DIFFUSE_MAP     - diffuse/ambient color comes from material.diffuse as a texture
+//  SPECULAR_MAP    - specular intensity comes from material.specular as a texture
+//  LAMBERT_ONLY    - shading LOD: no specular term at all
+//  VERTEX_LIGHTING - shading LOD: the light terms are computed per vertex (see phong.vs)
+//  TEXTURE_ARRAY   - the maps are layers of array textures (includes/texture_array.h): each map has
+//                    the layer and the uv rectangle of its image in the layer next to its sampler
+//  MATERIAL_BLOCK  - with TEXTURE_ARRAY: the layers and rectangles are per-object data read from the
+//                    MaterialParameters block, a range of the per-frame uniform ring bound at binding
+//                    point 2, and Material keeps only the samplers and the shininess
+// Without the map bits the material colors are plain vec3 uniforms.
+// A specialized program (Shader::enableSpecialization) defines FOLDED_material_shininess once the
+// shininess has kept its value, so pow() gets a constant exponent: Material holds samplers and can't
+// be folded as a whole. MATERIAL_SHININESS is the one to use.
+
+#ifdef FOLDED_material_shininess
+#define MATERIAL_SHININESS FOLDED_material_shininess
+#else
+#define MATERIAL_SHININESS material.shininess
+#endif
+
+struct Material {
+#ifdef DIFFUSE_MAP
+#ifdef TEXTURE_ARRAY
+    sampler2DArray diffuse;
+#ifndef MATERIAL_BLOCK
+    vec4 diffuseRect;
+    float diffuseLayer;
+#endif
+#else
+    sampler2D diffuse;
+#endif
+#else
+    vec3 ambient;
+    vec3 diffuse;
+#endif
+#ifdef SPECULAR_MAP
+#ifdef TEXTURE_ARRAY
+    sampler2DArray specular;
+#ifndef MATERIAL_BLOCK
+    vec4 specularRect;
+    float specularLayer;
+#endif
+#else
+    sampler2D specular;
+#endif
+#else
+    vec3 specular;
+#endif
+    float shininess;
+};
+
+#ifdef MATERIAL_BLOCK
+layout (std140) uniform MaterialParameters {
+    vec4 diffuseRect;
+    vec4 specularRect;
+    float diffuseLayer;
+    float specularLayer;
+} materialParameters;
+#define MATERIAL_DIFFUSE_RECT materialParameters.diffuseRect
+#define MATERIAL_DIFFUSE_LAYER materialParameters.diffuseLayer
+#define MATERIAL_SPECULAR_RECT materialParameters.specularRect
+#define MATERIAL_SPECULAR_LAYER materialParameters.specularLayer
+#else
+#define MATERIAL_DIFFUSE_RECT material.diffuseRect
+#define MATERIAL_DIFFUSE_LAYER material.diffuseLayer
+#define MATERIAL_SPECULAR_RECT material.specularRect
+#define MATERIAL_SPECULAR_LAYER material.specularLayer
+#endif
+
+struct Light {
+    vec3 position;
+
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+
+// light arriving at a point, before the material's colors are applied
+struct LightTerms {
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+
+LightTerms lightTerms(Light light, float shininess, vec3 normal, vec3 fragPos, vec3 viewPos)
+{
+    LightTerms terms;
+    // ambient
+    terms.ambient = light.ambient;
+
+    // diffuse
+    vec3 norm = normalize(normal);
+    vec3 lightDir = normalize(light.position - fragPos);
+    float diff = max(dot(norm, lightDir), 0.0);
+    terms.diffuse = light.diffuse * diff;
+
+    // specular
+#ifdef LAMBERT_ONLY
+    terms.specular = vec3(0.0);
+#else
+    vec3 viewDir = normalize(viewPos - fragPos);
+    vec3 reflectDir = reflect(-lightDir, norm);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
+    terms.specular = light.specular * spec;
+#endif
+    return terms;
+}
+
+#ifdef TEXTURE_ARRAY
+// rect is the uv offset (xy) and scale (zw) of the image within its layer
+vec4 sampleMap(sampler2DArray map, vec4 rect, float layer, vec2 texCoords)
+{
+    return texture(map, vec3(rect.xy + texCoords * rect.zw, layer));
+}
+#endif
+
+vec3 shade(Material material, LightTerms terms, vec2 texCoords)
+{
+#if defined(DIFFUSE_MAP) && defined(TEXTURE_ARRAY)
+    vec3 ambientColor = sampleMap(material.diffuse, MATERIAL_DIFFUSE_RECT, MATERIAL_DIFFUSE_LAYER, texCoords).rgb;
+    vec3 diffuseColor = ambientColor;
+#elif defined(DIFFUSE_MAP)
+    vec3 ambientColor = texture(material.diffuse, texCoords).rgb;
+    vec3 diffuseColor = ambientColor;
+#else
+    vec3 ambientColor = material.ambient;
+    vec3 diffuseColor = material.diffuse;
+#endif
+    vec3 result = terms.ambient * ambientColor + terms.diffuse * diffuseColor;
+#ifndef LAMBERT_ONLY
+#if defined(SPECULAR_MAP) && defined(TEXTURE_ARRAY)
+    vec3 specularColor = sampleMap(material.specular, MATERIAL_SPECULAR_RECT, MATERIAL_SPECULAR_LAYER, texCoords).rgb;
+#elif defined(SPECULAR_MAP)
+    vec3 specularColor = texture(material.specular, texCoords).rgb;
+#else
+    vec3 specularColor = material.specular;
+#endif
+    result += terms.specular * specularColor;
+#endif
+    return result;
+}
+
+vec3 phong(Material material, Light light, vec3 normal, vec3 fragPos, vec3 viewPos, vec2 texCoords)
+{
+    return shade(material, lightTerms(light, MATERIAL_SHININESS, normal, fragPos, viewPos), texCoords);
+}
+#line 4 0
+#if defined(FRAGMENT_NORMAL_MATRIX) && !defined(VERTEX_LIGHTING)
+#line 1 3
+// Per-object data. With OBJECT_BLOCK defined it is read from a range of the per-frame uniform ring
+// (includes/uniform_ring.h) bound at binding point 1, otherwise it is a plain uniform.
+
+#ifdef OBJECT_BLOCK
+layout (std140) uniform Object {
+    mat4 model;
+};
+#else
+uniform mat4 model;
+#endif
+#line 6 0
+#endif
+
+out vec4 FragColor;
+
+in vec3 Normal;
+in vec3 FragPos;
+in vec2 TexCoords;
+#ifdef VERTEX_LIGHTING
+in vec3 AmbientTerm;
+in vec3 DiffuseTerm;
+in vec3 SpecularTerm;
+#endif
+
+uniform Material material;
+uniform Light light;
+
+void main()
+{
+#ifdef VERTEX_LIGHTING
+    LightTerms terms;
+    terms.ambient = AmbientTerm;
+    terms.diffuse = DiffuseTerm;
+    terms.specular = SpecularTerm;
+    vec3 result = shade(material, terms, TexCoords);
+#else
+#ifdef FRAGMENT_NORMAL_MATRIX
+    // per fragment instead of per vertex: less vertex work, more fragment work, see Autotuner
+    vec3 normal = mat3(transpose(inverse(model))) * Normal;
+#else
+    vec3 normal = Normal;
+#endif
+    vec3 result = phong(material, light, normal, FragPos, viewPos, TexCoords);
+#endif
+#ifdef LOD_DEBUG
+    // tint by shading LOD: green full Phong, yellow Lambert, red per-vertex
+#ifdef VERTEX_LIGHTING
+    result = mix(result, vec3(1.0, 0.2, 0.2), 0.5);
+#else
+#ifdef LAMBERT_ONLY
+    result = mix(result, vec3(1.0, 1.0, 0.2), 0.5);
+#else
+    result = mix(result, vec3(0.2, 1.0, 0.2), 0.5);
+#endif
+#endif
+#endif
+    FragColor = vec4(result, 1.0);
+}
+)GLSL", 0xbf1c92d61372c028ull },
+    { "src/part2/phong.vs", R"GLSL(#version 330 core
+#line 1 1
+// Per-frame camera data, uploaded once per frame by CameraBuffer (includes/camera_buffer.h)
+// and shared by every program through uniform block binding point 0.
+
+layout (std140) uniform Camera {
+    mat4 projection;
+    mat4 view;
+    vec3 viewPos;
+};
+#line 3 0
+#line 1 2
+// Per-object data. With OBJECT_BLOCK defined it is read from a range of the per-frame uniform ring
+// (includes/uniform_ring.h) bound at binding point 1, otherwise it is a plain uniform.
+
+#ifdef OBJECT_BLOCK
+layout (std140) uniform Object {
+    mat4 model;
+};
+#else
+uniform mat4 model;
+#endif
+#line 4 0
+#ifdef VERTEX_LIGHTING
+#line 1 3
+// Phong lighting shared by the lit shaders. Feature bits (defined by the C++ side):
+//  DIFFUSE_MAP     - diffuse/ambient color comes from material.diffuse as a texture
+//  SPECULAR_MAP    - specular intensity comes from material.specular as a texture
+//  LAMBERT_ONLY    - shading LOD: no specular term at all
+//  VERTEX_LIGHTING - shading LOD: the light terms are computed per vertex (see phong.vs)
+//  TEXTURE_ARRAY   - the maps are layers of array textures (includes/texture_array.h): each map has
+//                    the layer and the uv rectangle of its image in the layer next to its sampler
+//  MATERIAL_BLOCK  - with TEXTURE_ARRAY: the layers and rectangles are per-object data read from the
+//                    MaterialParameters block, a range of the per-frame uniform ring bound at binding
+//                    point 2, and Material keeps only the samplers and the shininess
+// Without the map bits the material colors are plain vec3 uniforms.
+// A specialized program (Shader::enableSpecialization) defines FOLDED_material_shininess once the
+// shininess has kept its value, so pow() gets a constant exponent: Material holds samplers and can't
+// be folded as a whole. MATERIAL_SHININESS is the one to use.
+
+#ifdef FOLDED_material_shininess
+#define MATERIAL_SHININESS FOLDED_material_shininess
+#else
+#define MATERIAL_SHININESS material.shininess
+#endif
+
+struct Material {
+#ifdef DIFFUSE_MAP
+#ifdef TEXTURE_ARRAY
+    sampler2DArray diffuse;
+#ifndef MATERIAL_BLOCK
+    vec4 diffuseRect;
+    float diffuseLayer;
+#endif
+#else
+    sampler2D diffuse;
+#endif
+#else
+    vec3 ambient;
+    vec3 diffuse;
+#endif
+#ifdef SPECULAR_MAP
+#ifdef TEXTURE_ARRAY
+    sampler2DArray specular;
+#ifndef MATERIAL_BLOCK
+    vec4 specularRect;
+    float specularLayer;
+#endif
+#else
+    sampler2D specular;
+#endif
+#else
+    vec3 specular;
+#endif
+    float shininess;
+};
+
+#ifdef MATERIAL_BLOCK
+layout (std140) uniform MaterialParameters {
+    vec4 diffuseRect;
+    vec4 specularRect;
+    float diffuseLayer;
+    float specularLayer;
+} materialParameters;
+#define MATERIAL_DIFFUSE_RECT materialParameters.diffuseRect
+#define MATERIAL_DIFFUSE_LAYER materialParameters.diffuseLayer
+#define MATERIAL_SPECULAR_RECT materialParameters.specularRect
+#define MATERIAL_SPECULAR_LAYER materialParameters.specularLayer
+#else
+#define MATERIAL_DIFFUSE_RECT material.diffuseRect
+#define MATERIAL_DIFFUSE_LAYER material.diffuseLayer
+#define MATERIAL_SPECULAR_RECT material.specularRect
+#define MATERIAL_SPECULAR_LAYER material.specularLayer
+#endif
+
+struct Light {
+    vec3 position;
+
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+
+// light arriving at a point, before the material's colors are applied
+struct LightTerms {
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+
+LightTerms lightTerms(Light light, float shininess, vec3 normal, vec3 fragPos, vec3 viewPos)
+{
+    LightTerms terms;
+    // ambient
+    terms.ambient = light.ambient;
+
+    // diffuse
+    vec3 norm = normalize(normal);
+    vec3 lightDir = normalize(light.position - fragPos);
+    float diff = max(dot(norm, lightDir), 0.0);
+    terms.diffuse = light.diffuse * diff;
+
+    // specular
+#ifdef LAMBERT_ONLY
+    terms.specular = vec3(0.0);
+#else
+    vec3 viewDir = normalize(viewPos - fragPos);
+    vec3 reflectDir = reflect(-lightDir, norm);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
+    terms.specular = light.specular * spec;
+#endif
+    return terms;
+}
+
+#ifdef TEXTURE_ARRAY
+// rect is the uv offset (xy) and scale (zw) of the image within its layer
+vec4 sampleMap(sampler2DArray map, vec4 rect, float layer, vec2 texCoords)
+{
+    return texture(map, vec3(rect.xy + texCoords * rect.zw, layer));
+}
+#endif
+
+vec3 shade(Material material, LightTerms terms, vec2 texCoords)
+{
+#if defined(DIFFUSE_MAP) && defined(TEXTURE_ARRAY)
+    vec3 ambientColor = sampleMap(material.diffuse, MATERIAL_DIFFUSE_RECT, MATERIAL_DIFFUSE_LAYER, texCoords).rgb;
+    vec3 diffuseColor = ambientColor;
+#elif defined(DIFFUSE_MAP)
+    vec3 ambientColor = texture(material.diffuse, texCoords).rgb;
+    vec3 diffuseColor = ambientColor;
+#else
+    vec3 ambientColor = material.ambient;
+    vec3 diffuseColor = material.diffuse;
+#endif
+    vec3 result = terms.ambient * ambientColor + terms.diffuse * diffuseColor;
+#ifndef LAMBERT_ONLY
+#if defined(SPECULAR_MAP) && defined(TEXTURE_ARRAY)
+    vec3 specularColor = sampleMap(material.specular, MATERIAL_SPECULAR_RECT, MATERIAL_SPECULAR_LAYER, texCoords).rgb;
+#elif defined(SPECULAR_MAP)
+    vec3 specularColor = texture(material.specular, texCoords).rgb;
+#else
+    vec3 specularColor = material.specular;
+#endif
+    result += terms.specular * specularColor;
+#endif
+    return result;
+}
+
+vec3 phong(Material material, Light light, vec3 normal, vec3 fragPos, vec3 viewPos, vec2 texCoords)
+{
+    return shade(material, lightTerms(light, MATERIAL_SHININESS, normal, fragPos, viewPos), texCoords);
+}
+#line 6 0
+#endif
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoords;
+#ifdef VERTEX_LIGHTING
+// per-vertex light terms, the fragment stage only applies the material's colors
+out vec3 AmbientTerm;
+out vec3 DiffuseTerm;
+out vec3 SpecularTerm;
+
+uniform Material material;
+uniform Light light;
+#endif
+
+void main()
+{
+	FragPos = vec3(model * vec4(aPos, 1.0));
+#if defined(FRAGMENT_NORMAL_MATRIX) && !defined(VERTEX_LIGHTING)
+	// the fragment stage applies the normal matrix, see phong.fs
+	Normal = aNormal;
+#else
+	Normal = mat3(transpose(inverse(model))) * aNormal;
+#endif
+
+	gl_Position = projection * view * model * vec4(aPos, 1.0);
+	TexCoords = aTexCoords;
+#ifdef VERTEX_LIGHTING
+	LightTerms terms = lightTerms(light, MATERIAL_SHININESS, Normal, FragPos, viewPos);
+	AmbientTerm = terms.ambient;
+	DiffuseTerm = terms.diffuse;
+	SpecularTerm = terms.specular;
+#endif
+}
+)GLSL", 0x143c8a1919c32ffdull },
+};
+
+#endif
@@ -0,0 +1,123 @@
+#ifndef SHADER_PREPROCESSOR_H
+#define SHADER_PREPROCESSOR_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <filesystem>
+
+// Minimal GLSL preprocessing done on the CPU before the source reaches the driver:
+//  - #include "file" is resolved relative to the including file, each file is pulled in once
+//  - feature defines are injected right after the #version line
+// #line directives are emitted around every include so compile errors still point at the right
+// line; the second number is the file's index in the dependency list.
+class ShaderPreprocessor
+{
+public:
+    // load a shader with its includes expanded. dependencies (optional) receives every file that was read,
+    // the root file first
+    // ------------------------------------------------------------------------
+    static std::string load(const std::string &path, const std::vector<std::string> &defines,
+                            std::vector<std::string> *dependencies = nullptr)
+    {
+        std::vector<std::string> files;
+        std::string source;
+        expand(path, files, source);
+        if (dependencies)
+            *dependencies = files;
+        return injectDefines(source, defines);
+    }
+    // insert "#define NAME 1" for every feature after the #version line of an already expanded source
+    // ------------------------------------------------------------------------
+    static std::string injectDefines(const std::string &source, const std::vector<std::string> &defines)
+    {
+        if (defines.empty())
+            return source;
+        std::string block;
+        for (const std::string &define : defines)
+            block += "#define " + define + " 1\n";
+        return insertAfterVersion(source, block);
+    }
+    // insert a block of lines right after #version, followed by a #line so error messages stay aligned
+    // ------------------------------------------------------------------------
+    static std::string insertAfterVersion(const std::string &source, const std::string &block)
+    {
+        size_t version = source.find("#version");
+        if (version == std::string::npos)
+            return block + source;
+        size_t lineEnd = source.find('\n', version);
+        if (lineEnd == std::string::npos)
+            return source + "\n" + block;
+        // count the lines up to and including #version
+        size_t versionLine = 1;
+        for (size_t i = 0; i < lineEnd; i++)
+            if (source[i] == '\n')
+                versionLine++;
+        return source.substr(0, lineEnd + 1) + block + "#line " + std::to_string(versionLine + 1) + " 0\n" +
+               source.substr(lineEnd + 1);
+    }
+
+private:
+    // ------------------------------------------------------------------------
+    static void expand(const std::string &path, std::vector<std::string> &files, std::string &out)
+    {
+        std::string normalized = std::filesystem::path(path).lexically_normal().string();
+        for (const std::string &file : files)
+            if (file == normalized)
+                return; // already included
+        int fileIndex = (int)files.size();
+        files.push_back(normalized);
+
+        std::ifstream file(normalized);
+        if (!file)
+        {
+            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << normalized << std::endl;
+            return;
+        }
+        std::filesystem::path directory = std::filesystem::path(normalized).parent_path();
+
+        // #line is only legal after #version, which include files never come before
+        bool afterVersion = fileIndex != 0;
+        if (fileIndex != 0)
+            out += "#line 1 " + std::to_string(fileIndex) + "\n";
+
+        std::string line;
+        int lineNumber = 0;
+        while (std::getline(file, line))
+        {
+            lineNumber++;
+            size_t start = line.find_first_not_of(" \t");
+            if (start != std::string::npos && line.compare(start, 8, "#include") == 0)
+            {
+                size_t open = line.find('"', start + 8);
+                size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+                if (close == std::string::npos)
+                {
+                    std::cout << "ERROR::SHADER::BAD_INCLUDE: " << normalized << ":" << lineNumber << std::endl;
+                    continue;
+                }
+                std::string included = (directory / line.substr(open + 1, close - open - 1)).string();
+                expand(included, files, out);
+                // back in this file: line numbers continue after the #include
+                if (afterVersion)
+                    out += "#line " + std::to_string(lineNumber + 1) + " " + std::to_string(fileIndex) + "\n";
+                continue;
+            }
+            if (start != std::string::npos && line.compare(start, 8, "#version") == 0)
+            {
+                // only the root file keeps its #version, it has to be the first thing the compiler sees
+                if (fileIndex != 0)
+                {
+                    out += '\n';
+                    continue;
+                }
+                afterVersion = true;
+            }
+            out += line;
+            out += '\n';
+        }
+    }
+};
+#endif
@@ -2,99 +2,974 @@
 #define SHADER_H
 
 #include <glad/glad.h>
+#include <../includes/glm/glm/glm.hpp>
+#include <../includes/glm/glm/gtc/type_ptr.hpp>
+#include <../includes/hash.h>
+#include <../includes/shader_cache.h>
+#include <../includes/shader_preprocessor.h>
+#include <../includes/shader_pack.h>
+#include <../includes/uniform_struct.h>
+#include <../includes/shader_specializer.h>
 
 #include <string>
-#include <fstream>
-#include <sstream>
 #include <iostream>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+
+// typed handle into a Shader's uniform table. resolve it once with Shader::uniform<T>()
+// and pass it to Shader::set() every frame - no string lookup or driver query on that path
+template <typename T>
+struct Uniform
+{
+    int index = -1; // slot in the uniform table, -1 if the uniform is not active in the program
+
+    bool valid() const { return index >= 0; }
+};
+
+// handle for a whole generated uniform struct (includes/shader_uniforms_data.h): the table index of
+// each of UniformStruct<T>::fields, resolved once with Shader::uniformSet<T>()
+template <typename T>
+struct UniformSet
+{
+    std::vector<int> indices; // -1 for fields that are inactive or don't match the program
+
+    bool valid() const { return !indices.empty(); }
+};
+
+// maps a C++ value type to the GLSL types it may be bound to and the glUniform call that uploads it.
+// uploadTo() is the glProgramUniform form, used for separable stage programs that are never made current
+template <typename T> struct UniformTraits;
+
+// bools are uploaded (and shadowed) as ints, see Shader::set(Uniform<bool>, bool)
+template <> struct UniformTraits<bool>
+{
+    static bool accepts(GLenum type) { return type == GL_BOOL || type == GL_INT; }
+};
+
+template <> struct UniformTraits<int>
+{
+    // samplers are set through their texture unit, so they take an int as well
+    static bool accepts(GLenum type)
+    {
+        return type == GL_INT || type == GL_BOOL || type == GL_SAMPLER_1D || type == GL_SAMPLER_2D ||
+               type == GL_SAMPLER_3D || type == GL_SAMPLER_CUBE || type == GL_SAMPLER_2D_ARRAY ||
+               type == GL_SAMPLER_2D_SHADOW;
+    }
+    static void upload(GLint location, const int &value) { glUniform1i(location, value); }
+    static void uploadTo(GLuint program, GLint location, const int &value) { glProgramUniform1i(program, location, value); }
+};
+
+// unsigned counts and indices, typical for compute programs
+template <> struct UniformTraits<unsigned int>
+{
+    static bool accepts(GLenum type) { return type == GL_UNSIGNED_INT; }
+    static void upload(GLint location, const unsigned int &value) { glUniform1ui(location, value); }
+    static void uploadTo(GLuint program, GLint location, const unsigned int &value) { glProgramUniform1ui(program, location, value); }
+};
+
+template <> struct UniformTraits<float>
+{
+    static bool accepts(GLenum type) { return type == GL_FLOAT; }
+    static void upload(GLint location, const float &value) { glUniform1f(location, value); }
+    static void uploadTo(GLuint program, GLint location, const float &value) { glProgramUniform1f(program, location, value); }
+};
+
+template <> struct UniformTraits<glm::vec2>
+{
+    static bool accepts(GLenum type) { return type == GL_FLOAT_VEC2; }
+    static void upload(GLint location, const glm::vec2 &value) { glUniform2fv(location, 1, glm::value_ptr(value)); }
+    static void uploadTo(GLuint program, GLint location, const glm::vec2 &value) { glProgramUniform2fv(program, location, 1, glm::value_ptr(value)); }
+};
+
+template <> struct UniformTraits<glm::vec3>
+{
+    static bool accepts(GLenum type) { return type == GL_FLOAT_VEC3; }
+    static void upload(GLint location, const glm::vec3 &value) { glUniform3fv(location, 1, glm::value_ptr(value)); }
+    static void uploadTo(GLuint program, GLint location, const glm::vec3 &value) { glProgramUniform3fv(program, location, 1, glm::value_ptr(value)); }
+};
+
+template <> struct UniformTraits<glm::vec4>
+{
+    static bool accepts(GLenum type) { return type == GL_FLOAT_VEC4; }
+    static void upload(GLint location, const glm::vec4 &value) { glUniform4fv(location, 1, glm::value_ptr(value)); }
+    static void uploadTo(GLuint program, GLint location, const glm::vec4 &value) { glProgramUniform4fv(program, location, 1, glm::value_ptr(value)); }
+};
+
+template <> struct UniformTraits<glm::mat3>
+{
+    static bool accepts(GLenum type) { return type == GL_FLOAT_MAT3; }
+    static void upload(GLint location, const glm::mat3 &value) { glUniformMatrix3fv(location, 1, GL_FALSE, glm::value_ptr(value)); }
+    static void uploadTo(GLuint program, GLint location, const glm::mat3 &value) { glProgramUniformMatrix3fv(program, location, 1, GL_FALSE, glm::value_ptr(value)); }
+};
+
+template <> struct UniformTraits<glm::mat4>
+{
+    static bool accepts(GLenum type) { return type == GL_FLOAT_MAT4; }
+    static void upload(GLint location, const glm::mat4 &value) { glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value)); }
+    static void uploadTo(GLuint program, GLint location, const glm::mat4 &value) { glProgramUniformMatrix4fv(program, location, 1, GL_FALSE, glm::value_ptr(value)); }
+};
+
+// binding points of the uniform blocks that are shared between programs. GLSL 330 has no
+// layout(binding = N), so every program declaring one of these blocks is bound to it when it's resolved
+enum UniformBlockBinding
+{
+    CAMERA_BLOCK_BINDING = 0,
+    OBJECT_BLOCK_BINDING = 1,
+    MATERIAL_BLOCK_BINDING = 2
+};
+
+struct SharedUniformBlock
+{
+    const char *name;
+    UniformBlockBinding binding;
+};
+
+const SharedUniformBlock SHARED_UNIFORM_BLOCKS[] = {
+    { "Camera", CAMERA_BLOCK_BINDING },
+    { "Object", OBJECT_BLOCK_BINDING },
+    { "MaterialParameters", MATERIAL_BLOCK_BINDING }
+};
 
 class Shader
 {
 public:
     unsigned int ID;
-    // constructor generates the shader on the fly
-    // ------------------------------------------------------------------------
-    Shader(const char* vertexPath, const char* fragmentPath)
-    {
-        // 1. retrieve the vertex/fragment source code from filePath
-        std::string vertexCode;
-        std::string fragmentCode;
-        std::ifstream vShaderFile;
-        std::ifstream fShaderFile;
-        // ensure ifstream objects can throw exceptions:
-        vShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-        fShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-        try 
-        {
-            // open files
-            vShaderFile.open(vertexPath);
-            fShaderFile.open(fragmentPath);
-            std::stringstream vShaderStream, fShaderStream;
-            // read file's buffer contents into streams
-            vShaderStream << vShaderFile.rdbuf();
-            fShaderStream << fShaderFile.rdbuf();
-            // close file handlers
-            vShaderFile.close();
-            fShaderFile.close();
-            // convert stream into string
-            vertexCode   = vShaderStream.str();
-            fragmentCode = fShaderStream.str();
-        }
-        catch (std::ifstream::failure& e)
-        {
-            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << e.what() << std::endl;
-        }
-        const char* vShaderCode = vertexCode.c_str();
-        const char * fShaderCode = fragmentCode.c_str();
-        // 2. compile shaders
-        unsigned int vertex, fragment;
-        // vertex shader
-        vertex = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertex, 1, &vShaderCode, NULL);
-        glCompileShader(vertex);
-        checkCompileErrors(vertex, "VERTEX");
-        // fragment Shader
-        fragment = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragment, 1, &fShaderCode, NULL);
-        glCompileShader(fragment);
-        checkCompileErrors(fragment, "FRAGMENT");
-        // shader Program
-        ID = glCreateProgram();
-        glAttachShader(ID, vertex);
-        glAttachShader(ID, fragment);
-        glLinkProgram(ID);
-        checkCompileErrors(ID, "PROGRAM");
-        // delete the shaders as they're linked into our program now and no longer necessary
-        glDeleteShader(vertex);
-        glDeleteShader(fragment);
+
+    // one entry per active uniform, filled from glGetActiveUniform when the program is linked
+    struct UniformInfo
+    {
+        std::string name;
+        GLint location;
+        GLenum type;
+        size_t shadowOffset; // where the last uploaded value lives in the shadow copy
+    };
+
+    // glUniform* calls that reached the driver vs. ones dropped because the value was already set
+    struct UniformStats
+    {
+        unsigned int issued = 0;
+        unsigned int skipped = 0;
+    };
+    // constructor generates the shader on the fly. defines are injected as "#define NAME 1" into both stages
+    // ------------------------------------------------------------------------
+    Shader(const char* vertexPath, const char* fragmentPath, const std::vector<std::string> &defines = {})
+        : defines(defines)
+    {
+        // 1. retrieve the vertex/fragment source code from filePath, with #includes expanded
+        stages.push_back(fileStage(GL_VERTEX_SHADER, vertexPath));
+        stages.push_back(fileStage(GL_FRAGMENT_SHADER, fragmentPath));
+        // 2. link the program, straight from the binary cache if this exact source was linked before.
+        //    nothing waits for the compiler here, errors and the uniform table are picked up in resolve()
+        create();
+    }
+    // build from the compiled-in shader pack, no file is read. with SHADER_SOURCE_DIR set the
+    // sources are loaded from disk instead (see includes/shader_pack.h)
+    // ------------------------------------------------------------------------
+    Shader(ShaderPackId vertexId, ShaderPackId fragmentId, const std::vector<std::string> &defines = {})
+        : defines(defines)
+    {
+        stages.push_back(packStage(GL_VERTEX_SHADER, vertexId));
+        stages.push_back(packStage(GL_FRAGMENT_SHADER, fragmentId));
+        create();
+    }
+    // a separable program holding a single stage (GL_VERTEX_SHADER, GL_FRAGMENT_SHADER, ...), to be
+    // combined with other stages in a program pipeline (see includes/program_pipeline.h) instead of use()d.
+    // GL_COMPUTE_SHADER gives an ordinary compute program, see includes/compute_shader.h
+    // ------------------------------------------------------------------------
+    Shader(GLenum stage, const char* path, const std::vector<std::string> &defines = {})
+        : defines(defines), separable(stage != GL_COMPUTE_SHADER)
+    {
+        stages.push_back(fileStage(stage, path));
+        create();
+    }
+    Shader(GLenum stage, ShaderPackId id, const std::vector<std::string> &defines = {})
+        : defines(defines), separable(stage != GL_COMPUTE_SHADER)
+    {
+        stages.push_back(packStage(stage, id));
+        create();
+    }
+    // the program and anything still compiling for it is deleted with the Shader. share one program
+    // between several users through a ProgramRegistry (includes/program_registry.h), not by copying
+    // ------------------------------------------------------------------------
+    ~Shader()
+    {
+        if (resolved)
+            glDeleteProgram(ID);
+        else
+            discard(pending); // pending.program is ID
+        discard(reloading);
+        discard(specializing);
+        if (genericProgram != 0)
+            glDeleteProgram(genericProgram);
     }
+    Shader(const Shader&) = delete;
+    Shader& operator=(const Shader&) = delete;
     // activate the shader
     // ------------------------------------------------------------------------
     void use() 
     { 
+        resolve();
         glUseProgram(ID); 
     }
-    // utility uniform functions
+    // non-blocking: true once the driver has finished compiling and linking the program.
+    // without KHR_parallel_shader_compile there is no way to ask, so it always reports true
+    // ------------------------------------------------------------------------
+    bool ready() const
+    {
+        return resolved || isComplete(pending);
+    }
+    // wait for the program, report compile/link errors and build the uniform table.
+    // runs once, on first use; calling it earlier just moves the wait
+    // ------------------------------------------------------------------------
+    void resolve()
+    {
+        if (resolved)
+            return;
+        resolved = true;
+        finish(pending);
+        pending = PendingProgram();
+        // build the uniform table so nothing has to ask the driver for a location later on
+        reflectUniforms();
+        bindSharedUniformBlocks();
+    }
+    // recompile from the files on disk (hot reload). the current program stays in use until
+    // finishReload() finds the new one linked; a reload already in flight is abandoned
+    // ------------------------------------------------------------------------
+    void reload()
+    {
+        resolve();
+        dropSpecialization();
+        discard(reloading);
+        reloadingSources = loadSources();
+        reloading = build(stageTypes(), reloadingSources, separable);
+    }
+    // call at a frame boundary: swaps the reloaded program in once the driver is done with it.
+    // returns true if ID changed. a program that fails to compile or link is dropped and the old one kept
+    // ------------------------------------------------------------------------
+    bool finishReload()
+    {
+        if (reloading.program == 0 || !isComplete(reloading))
+            return false;
+        PendingProgram next = reloading;
+        reloading = PendingProgram();
+        if (!finish(next))
+        {
+            glDeleteProgram(next.program);
+            std::cout << "ERROR::SHADER::RELOAD_FAILED, keeping the previous program: " << sourceName() << std::endl;
+            return false;
+        }
+        glDeleteProgram(ID);
+        ID = next.program;
+        sources = reloadingSources;
+        adoptUniforms();
+        bindSharedUniformBlocks();
+        return true;
+    }
+    bool reloadPending() const
+    {
+        return reloading.program != 0;
+    }
+    // every file the current sources were built from, includes included
+    // ------------------------------------------------------------------------
+    const std::vector<std::string>& sourceFiles() const
+    {
+        return dependencies;
+    }
+    // let the driver compile on as many threads as it likes, if it supports KHR/ARB_parallel_shader_compile
+    // ------------------------------------------------------------------------
+    static void enableParallelCompile()
+    {
+        if (GLAD_GL_KHR_parallel_shader_compile)
+            glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+        else if (GLAD_GL_ARB_parallel_shader_compile)
+            glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+    }
+    static bool parallelCompileSupported()
+    {
+        return GLAD_GL_KHR_parallel_shader_compile || GLAD_GL_ARB_parallel_shader_compile;
+    }
+    // resolve a typed handle for a uniform. do this once outside the render loop;
+    // an inactive name or a type that doesn't match the GLSL declaration gives an invalid handle
+    // ------------------------------------------------------------------------
+    template <typename T>
+    Uniform<T> uniform(const std::string &name)
+    {
+        resolve();
+        Uniform<T> handle;
+        int index = findUniform(name);
+        if (index < 0)
+            return handle;
+        if (!UniformTraits<T>::accepts(uniforms[index].type))
+        {
+            std::cout << "ERROR::SHADER::UNIFORM_TYPE_MISMATCH: " << name << std::endl;
+            return handle;
+        }
+        handle.index = index;
+        return handle;
+    }
+    // set a uniform through a handle - a table index and the glUniform call, nothing else. the value is
+    // compared against the program's shadow copy first and only uploaded when its bytes differ
+    // ------------------------------------------------------------------------
+    template <typename T>
+    void set(Uniform<T> handle, const T &value)
+    {
+        if (!handle.valid())
+            return;
+        if (!updateShadow(handle.index, &value, sizeof(T)))
+            return;
+        const UniformInfo &info = uniforms[handle.index];
+        if (separable)
+            UniformTraits<T>::uploadTo(ID, info.location, value);
+        else
+            UniformTraits<T>::upload(info.location, value);
+    }
+    void set(Uniform<bool> handle, bool value)
+    {
+        Uniform<int> asInt;
+        asInt.index = handle.index;
+        set(asInt, (int)value);
+    }
+    // resolve every field of a generated uniform struct. fields the program doesn't have stay unset,
+    // a field whose GLSL type changed since the struct was generated is reported here, not per frame
+    // ------------------------------------------------------------------------
+    template <typename T>
+    UniformSet<T> uniformSet()
+    {
+        resolve();
+        UniformSet<T> handle;
+        for (const UniformField &field : UniformStruct<T>::fields)
+        {
+            int index = findUniform(field.name);
+            if (index >= 0 && uniforms[index].type != field.type)
+            {
+                std::cout << "ERROR::SHADER::UNIFORM_TYPE_MISMATCH: " << field.name << std::endl;
+                index = -1;
+            }
+            handle.indices.push_back(index);
+        }
+        return handle;
+    }
+    // upload a whole uniform struct in one call. locations and offsets are precomputed, each field
+    // still goes through the shadow copy so unchanged members cost a memcmp and no GL call
+    // ------------------------------------------------------------------------
+    template <typename T>
+    void set(const UniformSet<T> &handle, const T &values)
+    {
+        const unsigned char *bytes = reinterpret_cast<const unsigned char *>(&values);
+        for (size_t i = 0; i < handle.indices.size(); i++)
+        {
+            int index = handle.indices[i];
+            if (index < 0)
+                continue;
+            const unsigned char *value = bytes + UniformStruct<T>::fields[i].offset;
+            if (updateShadow(index, value, uniformSize(uniforms[index].type)))
+                uploadRaw(uniforms[index].type, uniforms[index].location, value);
+        }
+    }
+    // counters for the frame in progress; call endFrame() once per frame to roll them over
+    // ------------------------------------------------------------------------
+    const UniformStats& frameStats() const
+    {
+        return currentStats;
+    }
+    const UniformStats& lastFrameStats() const
+    {
+        return previousStats;
+    }
+    void endFrame()
+    {
+        previousStats = currentStats;
+        currentStats = UniformStats();
+        if (specializeAfter > 0)
+            updateSpecialization();
+        frameCounter++;
+    }
+    // opt-in profiler: uniforms that keep their value for this many frames (endFrame() calls) are
+    // folded into a specialized program compiled in the background. draws switch to it at a frame
+    // boundary, and back to the generic program as soon as a folded uniform is set to a new value
+    // ------------------------------------------------------------------------
+    void enableSpecialization(unsigned int frames = 120)
+    {
+        specializeAfter = frames;
+    }
+    // true while ID is a specialized program
+    bool specialized() const
+    {
+        return genericProgram != 0;
+    }
+    // forget every shadowed value, needed if the program's uniforms were changed behind the Shader's back
+    // ------------------------------------------------------------------------
+    void invalidateShadow()
+    {
+        std::fill(shadowValid.begin(), shadowValid.end(), 0);
+    }
+    // all active uniforms of the linked program
     // ------------------------------------------------------------------------
-    void setBool(const std::string &name, bool value) const
+    const std::vector<UniformInfo>& activeUniforms()
+    {
+        resolve();
+        return uniforms;
+    }
+    // utility uniform functions - these hash the name into the uniform table, prefer handles in render loops
+    // ------------------------------------------------------------------------
+    void setBool(const std::string &name, bool value)
     {         
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value); 
+        set(uniform<bool>(name), value);
     }
     // ------------------------------------------------------------------------
-    void setInt(const std::string &name, int value) const
+    void setInt(const std::string &name, int value)
     { 
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value); 
+        set(uniform<int>(name), value);
     }
     // ------------------------------------------------------------------------
-    void setFloat(const std::string &name, float value) const
+    void setUint(const std::string &name, unsigned int value)
+    {
+        set(uniform<unsigned int>(name), value);
+    }
+    // ------------------------------------------------------------------------
+    void setFloat(const std::string &name, float value)
     { 
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value); 
+        set(uniform<float>(name), value);
+    }
+    // ------------------------------------------------------------------------
+    void setVec2(const std::string &name, const glm::vec2 &value)
+    {
+        set(uniform<glm::vec2>(name), value);
+    }
+    void setVec2(const std::string &name, float x, float y)
+    {
+        set(uniform<glm::vec2>(name), glm::vec2(x, y));
+    }
+    // ------------------------------------------------------------------------
+    void setVec3(const std::string &name, const glm::vec3 &value)
+    {
+        set(uniform<glm::vec3>(name), value);
+    }
+    void setVec3(const std::string &name, float x, float y, float z)
+    {
+        set(uniform<glm::vec3>(name), glm::vec3(x, y, z));
+    }
+    // ------------------------------------------------------------------------
+    void setVec4(const std::string &name, const glm::vec4 &value)
+    {
+        set(uniform<glm::vec4>(name), value);
+    }
+    void setVec4(const std::string &name, float x, float y, float z, float w)
+    {
+        set(uniform<glm::vec4>(name), glm::vec4(x, y, z, w));
+    }
+    // ------------------------------------------------------------------------
+    void setMat3(const std::string &name, const glm::mat3 &mat)
+    {
+        set(uniform<glm::mat3>(name), mat);
+    }
+    // ------------------------------------------------------------------------
+    void setMat4(const std::string &name, const glm::mat4 &mat)
+    {
+        set(uniform<glm::mat4>(name), mat);
     }
 
 private:
+    friend class ProgramRegistry;
+
+    // a program handed to the driver whose compile/link status hasn't been looked at yet
+    struct PendingProgram
+    {
+        unsigned int program = 0;
+        std::vector<std::pair<GLenum, unsigned int>> stages; // empty when the program came from the binary cache
+        std::uint64_t cacheKey = 0;
+    };
+
+    // where one stage's source comes from: a file, or the compiled-in pack when entry is set
+    struct StageSource
+    {
+        GLenum type;
+        std::string path;
+        const ShaderPackEntry *entry;
+    };
+
+    std::vector<StageSource> stages;
+    std::vector<std::string> defines;
+    std::vector<std::string> dependencies;
+    bool separable = false;
+
+    bool resolved = false;
+    PendingProgram pending;
+    PendingProgram reloading;
+
+    std::vector<UniformInfo> uniforms;
+    // open addressing table of indices into uniforms, sized to a power of two, -1 marks an empty slot
+    std::vector<int> uniformSlots;
+    // CPU copy of the last value uploaded for every uniform, plus whether that copy is known yet
+    std::vector<unsigned char> shadow;
+    std::vector<char> shadowValid;
+    UniformStats currentStats;
+    UniformStats previousStats;
+
+    // constant-uniform specialization, see enableSpecialization()
+    std::vector<std::string> sources;          // preprocessed stage sources of the generic program
+    std::vector<std::string> reloadingSources;
+    unsigned int specializeAfter = 0;          // 0 while profiling is off
+    unsigned int frameCounter = 0;
+    std::vector<unsigned int> lastChange;      // per uniform: frame its value last changed
+    std::vector<char> volatileUniforms;        // per uniform: changed after being folded once, never folded again
+    std::vector<char> foldedUniforms;          // per uniform: baked into the running specialized program
+    unsigned int genericProgram = 0;           // set while ID is the specialized program
+    PendingProgram specializing;
+    std::vector<int> specializingIndices;
+    unsigned int specializingSince = 0;
+
+    // bytes needed to shadow one value of a GLSL type
+    // ------------------------------------------------------------------------
+    static size_t uniformSize(GLenum type)
+    {
+        switch (type)
+        {
+            case GL_FLOAT_VEC2: return 2 * sizeof(float);
+            case GL_FLOAT_VEC3: return 3 * sizeof(float);
+            case GL_FLOAT_VEC4: return 4 * sizeof(float);
+            case GL_FLOAT_MAT3: return 9 * sizeof(float);
+            case GL_FLOAT_MAT4: return 16 * sizeof(float);
+            default:            return sizeof(float); // float, int, bool and samplers
+        }
+    }
+    // returns true if the value differs from the shadow (and records it), false if the upload can be skipped
+    // ------------------------------------------------------------------------
+    bool updateShadow(int index, const void *value, size_t size)
+    {
+        unsigned char *cached = shadow.data() + uniforms[index].shadowOffset;
+        if (shadowValid[index] && std::memcmp(cached, value, size) == 0)
+        {
+            currentStats.skipped++;
+            return false;
+        }
+        if (foldedUniforms[index])
+        {
+            // the running program has the old value baked in, go back to the generic one
+            volatileUniforms[index] = 1;
+            dropSpecialization();
+            cached = shadow.data() + uniforms[index].shadowOffset;
+        }
+        std::memcpy(cached, value, size);
+        shadowValid[index] = 1;
+        lastChange[index] = frameCounter;
+        currentStats.issued++;
+        return true;
+    }
+
+    // enumerate the active uniforms of the linked program and index them by name.
+    // arrays are stored as "name" plus one entry per element "name[i]"
+    // ------------------------------------------------------------------------
+    void reflectUniforms()
+    {
+        uniforms.clear();
+        GLint count = 0, maxLength = 0;
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+        std::vector<char> nameBuffer(maxLength > 0 ? maxLength : 1);
+        for (GLint i = 0; i < count; i++)
+        {
+            GLint size = 0;
+            GLenum type = 0;
+            glGetActiveUniform(ID, (GLuint)i, maxLength, NULL, &size, &type, nameBuffer.data());
+            std::string name(nameBuffer.data());
+            GLint location = glGetUniformLocation(ID, name.c_str());
+            if (location < 0)
+                continue; // member of a uniform block, not set through glUniform
+            if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0)
+                name.erase(name.size() - 3);
+            uniforms.push_back({name, location, type, 0});
+            for (GLint element = 1; element < size; element++)
+            {
+                std::string elementName = name + "[" + std::to_string(element) + "]";
+                uniforms.push_back({elementName, glGetUniformLocation(ID, elementName.c_str()), type, 0});
+            }
+        }
+
+        indexUniforms();
+    }
+    // (re)build the hash slots and the shadow layout for the current uniform list
+    // ------------------------------------------------------------------------
+    void indexUniforms()
+    {
+        size_t shadowSize = 0;
+        for (UniformInfo &info : uniforms)
+        {
+            info.shadowOffset = shadowSize;
+            shadowSize += uniformSize(info.type);
+        }
+        shadow.assign(shadowSize, 0);
+        shadowValid.assign(uniforms.size(), 0);
+        // profiling state is per name and survives a rebuild of the table, new names are appended
+        lastChange.resize(uniforms.size(), 0);
+        volatileUniforms.resize(uniforms.size(), 0);
+        foldedUniforms.assign(uniforms.size(), 0);
+
+        size_t slotCount = 16;
+        while (slotCount < uniforms.size() * 2)
+            slotCount *= 2;
+        uniformSlots.assign(slotCount, -1);
+        for (size_t i = 0; i < uniforms.size(); i++)
+        {
+            size_t slot = hashString(uniforms[i].name) & (slotCount - 1);
+            while (uniformSlots[slot] >= 0)
+                slot = (slot + 1) & (slotCount - 1);
+            uniformSlots[slot] = (int)i;
+        }
+    }
+    // called from endFrame() while profiling: start a specialized build once some uniforms have been
+    // stable long enough, and swap it in when the driver is done with it
+    // ------------------------------------------------------------------------
+    void updateSpecialization()
+    {
+        if (!resolved || reloading.program != 0 || genericProgram != 0)
+            return;
+        if (specializing.program != 0)
+        {
+            if (!isComplete(specializing))
+                return;
+            PendingProgram next = specializing;
+            specializing = PendingProgram();
+            bool linked = finish(next);
+            bool stable = true;
+            for (int index : specializingIndices)
+                stable = stable && lastChange[index] <= specializingSince;
+            if (!linked || !stable)
+            {
+                // a failed specialization is not retried, the generic program works
+                if (!linked)
+                    specializeAfter = 0;
+                glDeleteProgram(next.program);
+                return;
+            }
+            genericProgram = ID;
+            ID = next.program;
+            adoptUniforms();
+            bindSharedUniformBlocks();
+            for (int index : specializingIndices)
+                foldedUniforms[index] = 1;
+            return;
+        }
+
+        // samplers can't be folded and a struct holding one can't be copied, see ShaderSpecializer. its
+        // members are only folded where the shader asks for them by macro
+        std::vector<std::string> opaque;
+        for (const UniformInfo &info : uniforms)
+            if (ShaderSpecializer::literal(info.type, shadow.data() + info.shadowOffset).empty())
+                opaque.push_back(info.name.substr(0, info.name.find('.')));
+        std::vector<FoldedUniform> constants;
+        specializingIndices.clear();
+        for (size_t i = 0; i < uniforms.size(); i++)
+        {
+            const UniformInfo &info = uniforms[i];
+            std::string base = info.name.substr(0, info.name.find('.'));
+            const unsigned char *value = shadow.data() + info.shadowOffset;
+            bool byMacro = base != info.name && !ShaderSpecializer::literal(info.type, value).empty() &&
+                           ShaderSpecializer::hasMemberMacro(sources, info.name);
+            if (!shadowValid[i] || volatileUniforms[i] || info.location < 0 || frameCounter - lastChange[i] < specializeAfter ||
+                info.name.find('[') != std::string::npos ||
+                (!byMacro && std::find(opaque.begin(), opaque.end(), base) != opaque.end()))
+                continue;
+            constants.push_back({ info.name, info.type, std::vector<unsigned char>(value, value + uniformSize(info.type)) });
+            specializingIndices.push_back((int)i);
+        }
+        if (constants.empty())
+            return;
+        std::vector<std::string> specialized;
+        for (const std::string &source : sources)
+            specialized.push_back(ShaderSpecializer::specialize(source, constants));
+        specializing = build(stageTypes(), specialized, separable);
+        specializingSince = frameCounter;
+    }
+    // back to the generic program, replaying the current values into it. an unfinished specialized
+    // build is abandoned
+    // ------------------------------------------------------------------------
+    void dropSpecialization()
+    {
+        discard(specializing);
+        if (genericProgram == 0)
+            return;
+        glDeleteProgram(ID);
+        ID = genericProgram;
+        genericProgram = 0;
+        adoptUniforms();
+        bindSharedUniformBlocks();
+    }
+    // after a reload: rebuild the table for the new program but keep every existing name at its old index,
+    // so handles resolved earlier stay valid, and replay the shadowed values into the new program
+    // ------------------------------------------------------------------------
+    void adoptUniforms()
+    {
+        std::vector<UniformInfo> previous = uniforms;
+        std::vector<unsigned char> previousShadow = shadow;
+        std::vector<char> previousValid = shadowValid;
+        reflectUniforms();
+
+        std::vector<UniformInfo> merged;
+        std::vector<char> taken(uniforms.size(), 0);
+        for (const UniformInfo &old : previous)
+        {
+            int index = findUniform(old.name);
+            bool kept = index >= 0 && uniforms[index].type == old.type;
+            if (index >= 0)
+                taken[index] = 1;
+            // a uniform that disappeared keeps its slot with location -1, which glUniform* ignores
+            merged.push_back({ old.name, kept ? uniforms[index].location : -1, old.type, 0 });
+        }
+        for (size_t i = 0; i < uniforms.size(); i++)
+            if (!taken[i])
+                merged.push_back(uniforms[i]);
+        uniforms = merged;
+        indexUniforms();
+
+        if (!separable)
+            glUseProgram(ID); // separable programs are written with glProgramUniform
+        for (size_t i = 0; i < previous.size(); i++)
+        {
+            if (!previousValid[i])
+                continue;
+            const unsigned char *value = previousShadow.data() + previous[i].shadowOffset;
+            std::memcpy(shadow.data() + uniforms[i].shadowOffset, value, uniformSize(uniforms[i].type));
+            shadowValid[i] = 1;
+            // an inactive uniform keeps its value on the CPU side, setting it again stays a no-op
+            if (uniforms[i].location >= 0)
+                uploadRaw(uniforms[i].type, uniforms[i].location, value);
+        }
+    }
+    // upload a shadowed value without knowing its C++ type
+    // ------------------------------------------------------------------------
+    void uploadRaw(GLenum type, GLint location, const unsigned char *value) const
+    {
+        const float *floats = reinterpret_cast<const float *>(value);
+        if (separable)
+        {
+            switch (type)
+            {
+                case GL_FLOAT:      glProgramUniform1fv(ID, location, 1, floats); break;
+                case GL_FLOAT_VEC2: glProgramUniform2fv(ID, location, 1, floats); break;
+                case GL_FLOAT_VEC3: glProgramUniform3fv(ID, location, 1, floats); break;
+                case GL_FLOAT_VEC4: glProgramUniform4fv(ID, location, 1, floats); break;
+                case GL_FLOAT_MAT3: glProgramUniformMatrix3fv(ID, location, 1, GL_FALSE, floats); break;
+                case GL_FLOAT_MAT4: glProgramUniformMatrix4fv(ID, location, 1, GL_FALSE, floats); break;
+                case GL_UNSIGNED_INT: glProgramUniform1uiv(ID, location, 1, reinterpret_cast<const GLuint *>(value)); break;
+                default:            glProgramUniform1iv(ID, location, 1, reinterpret_cast<const int *>(value)); break;
+            }
+            return;
+        }
+        switch (type)
+        {
+            case GL_FLOAT:      glUniform1fv(location, 1, floats); break;
+            case GL_FLOAT_VEC2: glUniform2fv(location, 1, floats); break;
+            case GL_FLOAT_VEC3: glUniform3fv(location, 1, floats); break;
+            case GL_FLOAT_VEC4: glUniform4fv(location, 1, floats); break;
+            case GL_FLOAT_MAT3: glUniformMatrix3fv(location, 1, GL_FALSE, floats); break;
+            case GL_FLOAT_MAT4: glUniformMatrix4fv(location, 1, GL_FALSE, floats); break;
+            case GL_UNSIGNED_INT: glUniform1uiv(location, 1, reinterpret_cast<const GLuint *>(value)); break;
+            default:            glUniform1iv(location, 1, reinterpret_cast<const int *>(value)); break;
+        }
+    }
+    // point the program's shared blocks (Camera, ...) at their fixed binding points
+    // ------------------------------------------------------------------------
+    void bindSharedUniformBlocks()
+    {
+        for (const SharedUniformBlock &block : SHARED_UNIFORM_BLOCKS)
+        {
+            GLuint index = glGetUniformBlockIndex(ID, block.name);
+            if (index != GL_INVALID_INDEX)
+                glUniformBlockBinding(ID, index, block.binding);
+        }
+    }
+    // ------------------------------------------------------------------------
+    int findUniform(const std::string &name) const
+    {
+        if (uniformSlots.empty())
+            return -1;
+        size_t mask = uniformSlots.size() - 1;
+        size_t slot = hashString(name) & mask;
+        while (uniformSlots[slot] >= 0)
+        {
+            if (uniforms[uniformSlots[slot]].name == name)
+                return uniformSlots[slot];
+            slot = (slot + 1) & mask;
+        }
+        return -1;
+    }
+    // compile and link all stages, or load the program binary a previous run stored for the same sources.
+    // status queries are left to resolve() so the driver can keep compiling in the background
+    // ------------------------------------------------------------------------
+    static PendingProgram build(const std::vector<GLenum> &types, const std::vector<std::string> &codes, bool separable)
+    {
+        PendingProgram result;
+        std::vector<std::string> keySources = codes;
+        if (separable)
+            keySources.push_back("separable");
+        result.cacheKey = ShaderCache::key(keySources);
+        result.program = createProgram(separable);
+        if (ShaderCache::load(result.program, result.cacheKey))
+            return result;
+        // a cache miss or a rejected binary: start over with a clean program object
+        glDeleteProgram(result.program);
+        result.program = createProgram(separable);
+        ShaderCache::prepare(result.program);
+
+        for (size_t i = 0; i < types.size(); i++)
+        {
+            const char* code = codes[i].c_str();
+            unsigned int shader = glCreateShader(types[i]);
+            glShaderSource(shader, 1, &code, NULL);
+            glCompileShader(shader);
+            glAttachShader(result.program, shader);
+            result.stages.push_back({ types[i], shader });
+        }
+        glLinkProgram(result.program);
+        return result;
+    }
+    // ------------------------------------------------------------------------
+    static unsigned int createProgram(bool separable)
+    {
+        unsigned int program = glCreateProgram();
+        if (separable)
+            glProgramParameteri(program, GL_PROGRAM_SEPARABLE, GL_TRUE);
+        return program;
+    }
+    // non-blocking completion query; without parallel compile support it can't be asked and reports true
+    // ------------------------------------------------------------------------
+    static bool isComplete(const PendingProgram &program)
+    {
+        if (program.stages.empty() || !parallelCompileSupported())
+            return true;
+        GLint done = GL_TRUE;
+        glGetProgramiv(program.program, GL_COMPLETION_STATUS_KHR, &done);
+        return done == GL_TRUE;
+    }
+    // check (and log) the compile and link status, store a good binary in the cache and free the stages
+    // ------------------------------------------------------------------------
+    static bool finish(const PendingProgram &program)
+    {
+        if (program.stages.empty())
+            return true; // loaded from the binary cache, already known to be linked
+        for (const std::pair<GLenum, unsigned int> &stage : program.stages)
+            checkCompileErrors(stage.second, stageName(stage.first));
+        bool linked = checkCompileErrors(program.program, "PROGRAM");
+        if (linked)
+            ShaderCache::store(program.program, program.cacheKey);
+        // delete the shaders as they're linked into our program now and no longer necessary
+        for (const std::pair<GLenum, unsigned int> &stage : program.stages)
+            glDeleteShader(stage.second);
+        return linked;
+    }
+    // ------------------------------------------------------------------------
+    static void discard(PendingProgram &program)
+    {
+        if (program.program == 0)
+            return;
+        for (const std::pair<GLenum, unsigned int> &stage : program.stages)
+            glDeleteShader(stage.second);
+        glDeleteProgram(program.program);
+        program = PendingProgram();
+    }
+    // ------------------------------------------------------------------------
+    static const char* stageName(GLenum type)
+    {
+        switch (type)
+        {
+            case GL_VERTEX_SHADER:   return "VERTEX";
+            case GL_FRAGMENT_SHADER: return "FRAGMENT";
+            case GL_COMPUTE_SHADER:  return "COMPUTE";
+            default:                 return "SHADER";
+        }
+    }
+    // ------------------------------------------------------------------------
+    static StageSource fileStage(GLenum type, const char* path)
+    {
+        return { type, path, nullptr };
+    }
+    static StageSource packStage(GLenum type, ShaderPackId id)
+    {
+        std::string path = shaderPackOverridePath(id);
+        if (!path.empty())
+            return { type, path, nullptr };
+        return { type, std::string(), &shaderPackEntry(id) };
+    }
+    // ------------------------------------------------------------------------
+    std::string sourceName() const
+    {
+        std::string name;
+        for (const StageSource &stage : stages)
+            name += (name.empty() ? "" : " + ") + (stage.entry ? std::string(stage.entry->path) : stage.path);
+        return name;
+    }
+    // ------------------------------------------------------------------------
+    std::vector<GLenum> stageTypes() const
+    {
+        std::vector<GLenum> types;
+        for (const StageSource &stage : stages)
+            types.push_back(stage.type);
+        return types;
+    }
+    // ------------------------------------------------------------------------
+    void create()
+    {
+        sources = loadSources();
+        pending = build(stageTypes(), sources, separable);
+        ID = pending.program;
+    }
+    // build from stage sources that were already run through the preprocessor (ProgramRegistry)
+    // ------------------------------------------------------------------------
+    Shader(const std::vector<StageSource> &stages, const std::vector<std::string> &defines, bool separable,
+           const std::vector<std::string> &sources, const std::vector<std::string> &dependencies)
+        : stages(stages), defines(defines), dependencies(dependencies), separable(separable), sources(sources)
+    {
+        pending = build(stageTypes(), sources, separable);
+        ID = pending.program;
+    }
+    // read every stage through the preprocessor and remember which files they came from
+    // ------------------------------------------------------------------------
+    std::vector<std::string> loadSources()
+    {
+        return loadSources(stages, defines, separable, dependencies);
+    }
+    static std::vector<std::string> loadSources(const std::vector<StageSource> &stages, const std::vector<std::string> &defines,
+                                                bool separable, std::vector<std::string> &dependencies)
+    {
+        std::vector<std::string> codes;
+        dependencies.clear();
+        for (const StageSource &stage : stages)
+        {
+            std::string code;
+            if (stage.entry)
+            {
+                // packed sources already have their includes expanded, there is nothing on disk to watch
+                code = ShaderPreprocessor::injectDefines(stage.entry->source, defines);
+            }
+            else
+            {
+                std::vector<std::string> files;
+                code = ShaderPreprocessor::load(stage.path, defines, &files);
+                for (const std::string &file : files)
+                    if (std::find(dependencies.begin(), dependencies.end(), file) == dependencies.end())
+                        dependencies.push_back(file);
+            }
+            if (separable)
+                code = ShaderPreprocessor::insertAfterVersion(code, separablePrelude(stage.type));
+            codes.push_back(code);
+        }
+        return codes;
+    }
+    // separable stages match their interfaces by name through ARB_separate_shader_objects,
+    // and a separable vertex stage has to redeclare the gl_PerVertex block it writes
+    // ------------------------------------------------------------------------
+    static std::string separablePrelude(GLenum type)
+    {
+        std::string prelude = "#extension GL_ARB_separate_shader_objects : enable\n";
+        if (type == GL_VERTEX_SHADER)
+            prelude += "out gl_PerVertex { vec4 gl_Position; };\n";
+        return prelude;
+    }
     // utility function for checking shader compilation/linking errors.
     // ------------------------------------------------------------------------
-    void checkCompileErrors(unsigned int shader, std::string type)
+    static bool checkCompileErrors(unsigned int shader, const std::string &type)
     {
         int success;
         char infoLog[1024];
@@ -116,6 +991,7 @@ private:
                 std::cout << "ERROR::PROGRAM_LINKING_ERROR of type: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
             }
         }
+        return success != 0;
     }
 };
 #endif
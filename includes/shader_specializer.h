@@ -0,0 +1,175 @@
+#ifndef SHADER_SPECIALIZER_H
+#define SHADER_SPECIALIZER_H
+
+#include <glad/glad.h>
+
+#include <string>
+#include <vector>
+#include <regex>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+// a uniform whose value is baked into a specialized program
+struct FoldedUniform
+{
+    std::string name; // as reported by glGetActiveUniform, e.g. "model" or "light.ambient"
+    GLenum type;
+    std::vector<unsigned char> value;
+};
+
+// Rewrites a GLSL stage so the given uniforms become compile-time constants the driver can fold.
+//  - a plain uniform is turned into a const global:  uniform mat4 model;  ->  const mat4 model = mat4(...);
+//  - members of a struct uniform are folded through a global copy of the struct that main() fills
+//    from the uniform and then overwrites member by member; a #define routes every later use of
+//    the uniform's name to the copy. uniform names stay the same, so the unfolded members keep
+//    their names in the specialized program
+//  - a member whose macro (memberMacro(), e.g. FOLDED_material_shininess) the source mentions is
+//    #defined to its value instead, for the shader to use in place of the member. structs holding
+//    samplers can't be copied in GLSL, so this is the only way their members are folded
+class ShaderSpecializer
+{
+public:
+    // the GLSL literal for a shadowed value, empty if the type can't be folded
+    // ------------------------------------------------------------------------
+    static std::string literal(GLenum type, const unsigned char *value)
+    {
+        const float *floats = reinterpret_cast<const float *>(value);
+        int integer;
+        std::memcpy(&integer, value, sizeof(int));
+        switch (type)
+        {
+            case GL_FLOAT:      return number(floats[0]);
+            case GL_FLOAT_VEC2: return constructor("vec2", floats, 2);
+            case GL_FLOAT_VEC3: return constructor("vec3", floats, 3);
+            case GL_FLOAT_VEC4: return constructor("vec4", floats, 4);
+            case GL_FLOAT_MAT3: return constructor("mat3", floats, 9);
+            case GL_FLOAT_MAT4: return constructor("mat4", floats, 16);
+            case GL_INT:        return std::to_string(integer);
+            case GL_UNSIGNED_INT: return std::to_string((unsigned int)integer) + "u";
+            case GL_BOOL:       return integer ? "true" : "false";
+            default:            return std::string();
+        }
+    }
+    // the macro a shader tests to take a struct member as a constant: "material.shininess" is
+    // FOLDED_material_shininess
+    // ------------------------------------------------------------------------
+    static std::string memberMacro(const std::string &name)
+    {
+        std::string macro = "FOLDED_" + name;
+        std::replace(macro.begin(), macro.end(), '.', '_');
+        return macro;
+    }
+    // whether any stage asks for a struct member through its macro
+    static bool hasMemberMacro(const std::vector<std::string> &sources, const std::string &name)
+    {
+        std::string macro = memberMacro(name);
+        for (const std::string &source : sources)
+            if (source.find(macro) != std::string::npos)
+                return true;
+        return false;
+    }
+    // ------------------------------------------------------------------------
+    static std::string specialize(std::string source, const std::vector<FoldedUniform> &constants)
+    {
+        std::vector<std::string> copied;
+        std::vector<std::string> assignments; // per copied struct
+        std::string defines;                  // members folded through their macro
+        for (const FoldedUniform &constant : constants)
+        {
+            size_t dot = constant.name.find('.');
+            std::string base = constant.name.substr(0, dot);
+            std::string value = literal(constant.type, constant.value.data());
+            if (dot != std::string::npos && source.find(memberMacro(constant.name)) != std::string::npos)
+            {
+                defines += "#define " + memberMacro(constant.name) + " " + value + "\n";
+                continue;
+            }
+            if (dot == std::string::npos)
+            {
+                std::regex declaration("\\buniform\\s+(?:(?:lowp|mediump|highp)\\s+)?" + glslType(constant.type) +
+                                       "\\s+" + base + "\\s*;");
+                source = std::regex_replace(source, declaration, "const " + glslType(constant.type) + " " + base + " = " + value + ";");
+                continue;
+            }
+            std::regex declaration("\\buniform\\s+(\\w+)\\s+" + base + "\\s*;");
+            if (!std::regex_search(source, declaration))
+                continue;
+            std::string copy = base + "_folded";
+            size_t index = std::find(copied.begin(), copied.end(), base) - copied.begin();
+            if (index == copied.size())
+            {
+                copied.push_back(base);
+                assignments.push_back(std::string());
+                source = std::regex_replace(source, declaration, "uniform $1 " + base + ";\n$1 " + copy + ";\n#define " + base + " " + copy + "\n");
+            }
+            assignments[index] += "    " + copy + constant.name.substr(dot) + " = " + value + ";\n";
+        }
+        // the declaration may sit in an #ifdef'd out block, the copy is only filled where the macro exists
+        std::string prologue;
+        for (size_t i = 0; i < copied.size(); i++)
+        {
+            const std::string &base = copied[i];
+            prologue += "\n#ifdef " + base + "\n#undef " + base + "\n    " + base + "_folded = " + base + ";\n#define " + base +
+                        " " + base + "_folded\n" + assignments[i] + "#endif\n";
+        }
+        if (!defines.empty())
+        {
+            // right after #version, ahead of every use
+            size_t version = source.find("#version");
+            size_t line = version == std::string::npos ? std::string::npos : source.find('\n', version);
+            source.insert(line == std::string::npos ? 0 : line + 1, defines);
+        }
+        if (prologue.empty())
+            return source;
+        std::smatch main;
+        if (std::regex_search(source, main, std::regex("\\bvoid\\s+main\\s*\\(\\s*(void)?\\s*\\)\\s*\\{")))
+            source.insert(main.position(0) + main.length(0), prologue);
+        return source;
+    }
+
+private:
+    // ------------------------------------------------------------------------
+    static std::string glslType(GLenum type)
+    {
+        switch (type)
+        {
+            case GL_FLOAT:      return "float";
+            case GL_FLOAT_VEC2: return "vec2";
+            case GL_FLOAT_VEC3: return "vec3";
+            case GL_FLOAT_VEC4: return "vec4";
+            case GL_FLOAT_MAT3: return "mat3";
+            case GL_FLOAT_MAT4: return "mat4";
+            case GL_INT:        return "int";
+            case GL_UNSIGNED_INT: return "uint";
+            default:            return "bool";
+        }
+    }
+    // a float literal that reads back as the same float
+    // ------------------------------------------------------------------------
+    static std::string number(float value)
+    {
+        if (!std::isfinite(value))
+            return std::string();
+        char text[32];
+        std::snprintf(text, sizeof(text), "%.9g", value);
+        std::string result = text;
+        if (result.find_first_of(".e") == std::string::npos)
+            result += ".0";
+        return result;
+    }
+    static std::string constructor(const char *type, const float *values, int count)
+    {
+        std::string result = std::string(type) + "(";
+        for (int i = 0; i < count; i++)
+        {
+            std::string value = number(values[i]);
+            if (value.empty())
+                return std::string();
+            result += (i ? ", " : "") + value;
+        }
+        return result + ")";
+    }
+};
+#endif
@@ -0,0 +1,156 @@
+// generated by tools/uniform_structs.cpp from tools/uniform_structs.txt - do not edit, rerun the tool instead
+#ifndef SHADER_UNIFORMS_DATA_H
+#define SHADER_UNIFORMS_DATA_H
+
+#include <glad/glad.h>
+#include <../includes/glm/glm/glm.hpp>
+#include <../includes/uniform_struct.h>
+
+#include <cstddef>
+
+// std140 layout of uniform block Camera (src/part2/phong.vs)
+struct CameraUniformBlock
+{
+    glm::mat4 projection;
+    glm::mat4 view;
+    glm::vec3 viewPos;
+    float pad0;
+};
+static_assert(offsetof(CameraUniformBlock, projection) == 0, "std140 offset of Camera.projection");
+static_assert(offsetof(CameraUniformBlock, view) == 64, "std140 offset of Camera.view");
+static_assert(offsetof(CameraUniformBlock, viewPos) == 128, "std140 offset of Camera.viewPos");
+static_assert(sizeof(CameraUniformBlock) == 144, "std140 size of Camera");
+
+// std140 layout of uniform block Object (src/part2/phong.vs)
+struct ObjectUniformBlock
+{
+    glm::mat4 model;
+};
+static_assert(offsetof(ObjectUniformBlock, model) == 0, "std140 offset of Object.model");
+static_assert(sizeof(ObjectUniformBlock) == 64, "std140 size of Object");
+
+// std140 layout of uniform block MaterialParameters (src/part2/phong.fs)
+struct MaterialParametersUniformBlock
+{
+    glm::vec4 diffuseRect;
+    glm::vec4 specularRect;
+    float diffuseLayer;
+    float specularLayer;
+    float pad0;
+    float pad1;
+};
+static_assert(offsetof(MaterialParametersUniformBlock, diffuseRect) == 0, "std140 offset of MaterialParameters.diffuseRect");
+static_assert(offsetof(MaterialParametersUniformBlock, specularRect) == 16, "std140 offset of MaterialParameters.specularRect");
+static_assert(offsetof(MaterialParametersUniformBlock, diffuseLayer) == 32, "std140 offset of MaterialParameters.diffuseLayer");
+static_assert(offsetof(MaterialParametersUniformBlock, specularLayer) == 36, "std140 offset of MaterialParameters.specularLayer");
+static_assert(sizeof(MaterialParametersUniformBlock) == 48, "std140 size of MaterialParameters");
+
+// src/part2/phong.vs src/part2/phong.fs
+struct PhongUniforms
+{
+    struct Material
+    {
+        glm::vec3 ambient;
+        glm::vec3 diffuse;
+        glm::vec3 specular;
+        float shininess;
+    };
+    struct Light
+    {
+        glm::vec3 position;
+        glm::vec3 ambient;
+        glm::vec3 diffuse;
+        glm::vec3 specular;
+    };
+    glm::mat4 model;
+    Material material;
+    Light light;
+};
+template<> struct UniformStruct<PhongUniforms>
+{
+    static constexpr UniformField fields[] = {
+        { "model", GL_FLOAT_MAT4, offsetof(PhongUniforms, model) },
+        { "material.ambient", GL_FLOAT_VEC3, offsetof(PhongUniforms, material) + offsetof(PhongUniforms::Material, ambient) },
+        { "material.diffuse", GL_FLOAT_VEC3, offsetof(PhongUniforms, material) + offsetof(PhongUniforms::Material, diffuse) },
+        { "material.specular", GL_FLOAT_VEC3, offsetof(PhongUniforms, material) + offsetof(PhongUniforms::Material, specular) },
+        { "material.shininess", GL_FLOAT, offsetof(PhongUniforms, material) + offsetof(PhongUniforms::Material, shininess) },
+        { "light.position", GL_FLOAT_VEC3, offsetof(PhongUniforms, light) + offsetof(PhongUniforms::Light, position) },
+        { "light.ambient", GL_FLOAT_VEC3, offsetof(PhongUniforms, light) + offsetof(PhongUniforms::Light, ambient) },
+        { "light.diffuse", GL_FLOAT_VEC3, offsetof(PhongUniforms, light) + offsetof(PhongUniforms::Light, diffuse) },
+        { "light.specular", GL_FLOAT_VEC3, offsetof(PhongUniforms, light) + offsetof(PhongUniforms::Light, specular) },
+    };
+};
+
+// src/part2/phong.vs src/part2/phong.fs -DDIFFUSE_MAP -DSPECULAR_MAP -DOBJECT_BLOCK -DTEXTURE_ARRAY
+struct PhongTexturedUniforms
+{
+    struct Material
+    {
+        int diffuse; // sampler2DArray
+        glm::vec4 diffuseRect;
+        float diffuseLayer;
+        int specular; // sampler2DArray
+        glm::vec4 specularRect;
+        float specularLayer;
+        float shininess;
+    };
+    struct Light
+    {
+        glm::vec3 position;
+        glm::vec3 ambient;
+        glm::vec3 diffuse;
+        glm::vec3 specular;
+    };
+    Material material;
+    Light light;
+};
+template<> struct UniformStruct<PhongTexturedUniforms>
+{
+    static constexpr UniformField fields[] = {
+        { "material.diffuse", GL_SAMPLER_2D_ARRAY, offsetof(PhongTexturedUniforms, material) + offsetof(PhongTexturedUniforms::Material, diffuse) },
+        { "material.diffuseRect", GL_FLOAT_VEC4, offsetof(PhongTexturedUniforms, material) + offsetof(PhongTexturedUniforms::Material, diffuseRect) },
+        { "material.diffuseLayer", GL_FLOAT, offsetof(PhongTexturedUniforms, material) + offsetof(PhongTexturedUniforms::Material, diffuseLayer) },
+        { "material.specular", GL_SAMPLER_2D_ARRAY, offsetof(PhongTexturedUniforms, material) + offsetof(PhongTexturedUniforms::Material, specular) },
+        { "material.specularRect", GL_FLOAT_VEC4, offsetof(PhongTexturedUniforms, material) + offsetof(PhongTexturedUniforms::Material, specularRect) },
+        { "material.specularLayer", GL_FLOAT, offsetof(PhongTexturedUniforms, material) + offsetof(PhongTexturedUniforms::Material, specularLayer) },
+        { "material.shininess", GL_FLOAT, offsetof(PhongTexturedUniforms, material) + offsetof(PhongTexturedUniforms::Material, shininess) },
+        { "light.position", GL_FLOAT_VEC3, offsetof(PhongTexturedUniforms, light) + offsetof(PhongTexturedUniforms::Light, position) },
+        { "light.ambient", GL_FLOAT_VEC3, offsetof(PhongTexturedUniforms, light) + offsetof(PhongTexturedUniforms::Light, ambient) },
+        { "light.diffuse", GL_FLOAT_VEC3, offsetof(PhongTexturedUniforms, light) + offsetof(PhongTexturedUniforms::Light, diffuse) },
+        { "light.specular", GL_FLOAT_VEC3, offsetof(PhongTexturedUniforms, light) + offsetof(PhongTexturedUniforms::Light, specular) },
+    };
+};
+
+// src/part2/phong.vs src/part2/phong.fs -DDIFFUSE_MAP -DSPECULAR_MAP -DOBJECT_BLOCK -DTEXTURE_ARRAY -DMATERIAL_BLOCK
+struct PhongStreamedUniforms
+{
+    struct Material
+    {
+        int diffuse; // sampler2DArray
+        int specular; // sampler2DArray
+        float shininess;
+    };
+    struct Light
+    {
+        glm::vec3 position;
+        glm::vec3 ambient;
+        glm::vec3 diffuse;
+        glm::vec3 specular;
+    };
+    Material material;
+    Light light;
+};
+template<> struct UniformStruct<PhongStreamedUniforms>
+{
+    static constexpr UniformField fields[] = {
+        { "material.diffuse", GL_SAMPLER_2D_ARRAY, offsetof(PhongStreamedUniforms, material) + offsetof(PhongStreamedUniforms::Material, diffuse) },
+        { "material.specular", GL_SAMPLER_2D_ARRAY, offsetof(PhongStreamedUniforms, material) + offsetof(PhongStreamedUniforms::Material, specular) },
+        { "material.shininess", GL_FLOAT, offsetof(PhongStreamedUniforms, material) + offsetof(PhongStreamedUniforms::Material, shininess) },
+        { "light.position", GL_FLOAT_VEC3, offsetof(PhongStreamedUniforms, light) + offsetof(PhongStreamedUniforms::Light, position) },
+        { "light.ambient", GL_FLOAT_VEC3, offsetof(PhongStreamedUniforms, light) + offsetof(PhongStreamedUniforms::Light, ambient) },
+        { "light.diffuse", GL_FLOAT_VEC3, offsetof(PhongStreamedUniforms, light) + offsetof(PhongStreamedUniforms::Light, diffuse) },
+        { "light.specular", GL_FLOAT_VEC3, offsetof(PhongStreamedUniforms, light) + offsetof(PhongStreamedUniforms::Light, specular) },
+    };
+};
+
+#endif
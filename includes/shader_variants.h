@@ -0,0 +1,103 @@
+#ifndef SHADER_VARIANTS_H
+#define SHADER_VARIANTS_H
+
+#include <../includes/shader_s.h>
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <initializer_list>
+#include <iostream>
+
+// One uber-shader source, many specialized programs. Every feature name is a bit in a mask;
+// get(mask) compiles the program with "#define NAME 1" for each set bit the first time that
+// mask is asked for and returns the same Shader afterwards. The shader source uses #ifdef on
+// the feature names, so each program only contains the code paths its draws actually need.
+class ShaderVariants
+{
+public:
+    ShaderVariants(const std::string &vertexPath, const std::string &fragmentPath, const std::vector<std::string> &features)
+        : vertexPath(vertexPath), fragmentPath(fragmentPath), features(features)
+    {
+        if (features.size() > 32)
+            std::cout << "ERROR::SHADER_VARIANTS::TOO_MANY_FEATURES: " << features.size() << std::endl;
+    }
+    // variants of a shader from the compiled-in pack
+    ShaderVariants(ShaderPackId vertexId, ShaderPackId fragmentId, const std::vector<std::string> &features)
+        : ShaderVariants(std::string(), std::string(), features)
+    {
+        packed = true;
+        this->vertexId = vertexId;
+        this->fragmentId = fragmentId;
+    }
+    // variants of a single separable stage, e.g. many fragment variants sharing one vertex stage
+    // through a PipelineCache (see includes/program_pipeline.h)
+    ShaderVariants(GLenum stage, ShaderPackId id, const std::vector<std::string> &features)
+        : ShaderVariants(std::string(), std::string(), features)
+    {
+        packed = true;
+        this->stage = stage;
+        this->vertexId = id;
+    }
+    // bit mask for a set of feature names, unknown names are reported and ignored
+    // ------------------------------------------------------------------------
+    unsigned int mask(std::initializer_list<const char*> names) const
+    {
+        unsigned int result = 0;
+        for (const char *name : names)
+        {
+            unsigned int bit = 0;
+            while (bit < features.size() && features[bit] != name)
+                bit++;
+            if (bit == features.size())
+                std::cout << "ERROR::SHADER_VARIANTS::UNKNOWN_FEATURE: " << name << std::endl;
+            else
+                result |= 1u << bit;
+        }
+        return result;
+    }
+    // the program for a feature mask, compiled on first request. the reference stays valid
+    // for the lifetime of this object
+    // ------------------------------------------------------------------------
+    Shader& get(unsigned int featureMask)
+    {
+        auto found = programs.find(featureMask);
+        if (found != programs.end())
+            return *found->second;
+        std::unique_ptr<Shader> &program = programs[featureMask];
+        if (stage != 0)
+            program = std::make_unique<Shader>(stage, vertexId, definesFor(featureMask));
+        else if (packed)
+            program = std::make_unique<Shader>(vertexId, fragmentId, definesFor(featureMask));
+        else
+            program = std::make_unique<Shader>(vertexPath.c_str(), fragmentPath.c_str(), definesFor(featureMask));
+        return *program;
+    }
+    // number of variants compiled so far
+    size_t size() const
+    {
+        return programs.size();
+    }
+
+private:
+    std::string vertexPath;
+    std::string fragmentPath;
+    bool packed = false;
+    GLenum stage = 0; // non-zero for single-stage variants, whose source is vertexId
+    ShaderPackId vertexId = SHADER_PACK_COUNT;
+    ShaderPackId fragmentId = SHADER_PACK_COUNT;
+    std::vector<std::string> features;
+    std::unordered_map<unsigned int, std::unique_ptr<Shader>> programs;
+
+    // ------------------------------------------------------------------------
+    std::vector<std::string> definesFor(unsigned int featureMask) const
+    {
+        std::vector<std::string> defines;
+        for (unsigned int bit = 0; bit < features.size(); bit++)
+            if (featureMask & (1u << bit))
+                defines.push_back(features[bit]);
+        return defines;
+    }
+};
+#endif
@@ -0,0 +1,179 @@
+#ifndef SHADER_WATCHER_H
+#define SHADER_WATCHER_H
+
+#include <../includes/shader_s.h>
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <chrono>
+#include <iostream>
+#include <filesystem>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+#endif
+
+// Hot reload for shader sources. Watches every file a Shader was built from (its #includes too)
+// and, when one changes, recompiles the program in the background and swaps it in at a frame
+// boundary. A source that no longer compiles is reported and the running program is kept.
+//
+// On Linux the directories are watched with inotify (directories rather than files, since editors
+// usually save by writing a new file and renaming it over the old one). Elsewhere the files'
+// modification times are polled a couple of times a second.
+class ShaderWatcher
+{
+public:
+    ShaderWatcher()
+    {
+#ifdef __linux__
+        fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fd < 0)
+            std::cout << "ERROR::SHADER_WATCHER::INOTIFY_INIT_FAILED, falling back to polling" << std::endl;
+#endif
+    }
+    ~ShaderWatcher()
+    {
+#ifdef __linux__
+        if (fd >= 0)
+            close(fd);
+#endif
+    }
+    ShaderWatcher(const ShaderWatcher&) = delete;
+    ShaderWatcher& operator=(const ShaderWatcher&) = delete;
+
+    // start watching a shader. it must outlive the watcher (or at least its last update())
+    // ------------------------------------------------------------------------
+    void watch(Shader &shader)
+    {
+        for (Shader *watched : shaders)
+            if (watched == &shader)
+                return;
+        shaders.push_back(&shader);
+        addFiles(shader);
+    }
+    // call once per frame, before any drawing: picks up file changes, starts recompiles and
+    // swaps finished programs in. returns the number of programs swapped this frame
+    // ------------------------------------------------------------------------
+    int update()
+    {
+        std::set<std::string> changed = changedFiles();
+        for (Shader *shader : shaders)
+        {
+            for (const std::string &file : shader->sourceFiles())
+            {
+                if (changed.count(absolute(file)))
+                {
+                    std::cout << "SHADER::RELOAD: " << file << std::endl;
+                    shader->reload();
+                    break;
+                }
+            }
+        }
+
+        int swapped = 0;
+        for (Shader *shader : shaders)
+        {
+            if (!shader->finishReload())
+                continue;
+            swapped++;
+            addFiles(*shader); // a new #include may have appeared
+        }
+        return swapped;
+    }
+
+private:
+    std::vector<Shader *> shaders;
+    // absolute path -> last seen modification time
+    std::map<std::string, std::filesystem::file_time_type> files;
+    std::chrono::steady_clock::time_point lastPoll;
+#ifdef __linux__
+    int fd = -1;
+    // inotify watch descriptor -> directory
+    std::map<int, std::string> directories;
+#endif
+
+    // ------------------------------------------------------------------------
+    static std::string absolute(const std::string &path)
+    {
+        std::error_code error;
+        std::filesystem::path result = std::filesystem::absolute(path, error);
+        return result.lexically_normal().string();
+    }
+    // ------------------------------------------------------------------------
+    void addFiles(const Shader &shader)
+    {
+        for (const std::string &file : shader.sourceFiles())
+        {
+            std::string path = absolute(file);
+            if (files.count(path))
+                continue;
+            std::error_code error;
+            files[path] = std::filesystem::last_write_time(path, error);
+#ifdef __linux__
+            if (fd < 0)
+                continue;
+            std::string directory = std::filesystem::path(path).parent_path().string();
+            bool watched = false;
+            for (const auto &entry : directories)
+                watched = watched || entry.second == directory;
+            if (watched)
+                continue;
+            int wd = inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+            if (wd < 0)
+                std::cout << "ERROR::SHADER_WATCHER::CANNOT_WATCH: " << directory << std::endl;
+            else
+                directories[wd] = directory;
+#endif
+        }
+    }
+    // every watched file that changed since the last call
+    // ------------------------------------------------------------------------
+    std::set<std::string> changedFiles()
+    {
+        std::set<std::string> changed;
+#ifdef __linux__
+        if (fd >= 0)
+        {
+            alignas(inotify_event) char buffer[4096];
+            ssize_t length;
+            while ((length = read(fd, buffer, sizeof(buffer))) > 0)
+            {
+                for (char *cursor = buffer; cursor < buffer + length;)
+                {
+                    const inotify_event *event = reinterpret_cast<const inotify_event *>(cursor);
+                    cursor += sizeof(inotify_event) + event->len;
+                    auto directory = directories.find(event->wd);
+                    if (directory == directories.end() || event->len == 0)
+                        continue;
+                    std::string path = directory->second + "/" + event->name;
+                    if (files.count(path))
+                        changed.insert(path);
+                }
+            }
+            return changed;
+        }
+#endif
+        // no inotify: poll modification times, but not every frame
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (now - lastPoll < std::chrono::milliseconds(500))
+            return changed;
+        lastPoll = now;
+        for (auto &entry : files)
+        {
+            std::error_code error;
+            std::filesystem::file_time_type time = std::filesystem::last_write_time(entry.first, error);
+            if (!error && time != entry.second)
+            {
+                entry.second = time;
+                changed.insert(entry.first);
+            }
+        }
+        return changed;
+    }
+};
+#endif
@@ -0,0 +1,108 @@
+#ifndef SHADING_LOD_H
+#define SHADING_LOD_H
+
+#include <../includes/glm/glm/glm.hpp>
+#include <../includes/camera.h>
+#include <../includes/shader_variants.h>
+
+#include <cmath>
+
+enum ShadingLevel
+{
+    SHADING_FULL,    // per-pixel Phong
+    SHADING_LAMBERT, // per-pixel, no specular term
+    SHADING_VERTEX,  // light terms computed per vertex
+    SHADING_LEVEL_COUNT
+};
+
+// Level of detail for shading: a lit material picks a cheaper program variant for objects that
+// cover little of the screen, so distant clutter doesn't pay for the full per-pixel Phong path.
+// The material's ShaderVariants must declare the features LAMBERT_ONLY, VERTEX_LIGHTING and
+// LOD_DEBUG (see src/common/lighting.glsl); the debug view tints every object by the level it used.
+class ShadingLod
+{
+public:
+    // projected object height as a fraction of the viewport height below which a level is used
+    struct Thresholds
+    {
+        float lambert = 0.25f;
+        float vertex = 0.08f;
+    };
+    Thresholds thresholds;
+
+    // baseMask holds the material's own features (DIFFUSE_MAP, ...), the LOD bits are added to it
+    ShadingLod(ShaderVariants &variants, unsigned int baseMask)
+        : variants(variants), baseMask(baseMask)
+    {
+        levelMasks[SHADING_FULL] = 0;
+        levelMasks[SHADING_LAMBERT] = variants.mask({ "LAMBERT_ONLY" });
+        levelMasks[SHADING_VERTEX] = variants.mask({ "VERTEX_LIGHTING" });
+        debugMask = variants.mask({ "LOD_DEBUG" });
+    }
+    // height of a bounding sphere on screen, as a fraction of the viewport height, for the
+    // camera's vertical field of view (Camera::Zoom)
+    // ------------------------------------------------------------------------
+    static float projectedSize(const Camera &camera, const glm::vec3 &center, float radius)
+    {
+        float distance = glm::length(center - camera.Position);
+        if (distance <= radius)
+            return 1.0f;
+        return radius / (distance * std::tan(glm::radians(camera.Zoom) * 0.5f));
+    }
+    // ------------------------------------------------------------------------
+    ShadingLevel select(const Camera &camera, const glm::vec3 &center, float radius) const
+    {
+        float size = projectedSize(camera, center, radius);
+        if (size < thresholds.vertex)
+            return SHADING_VERTEX;
+        if (size < thresholds.lambert)
+            return SHADING_LAMBERT;
+        return SHADING_FULL;
+    }
+    // the program for one draw of an object with this bounding sphere. counted in the frame's stats
+    // ------------------------------------------------------------------------
+    Shader& shaderFor(const Camera &camera, const glm::vec3 &center, float radius)
+    {
+        ShadingLevel level = select(camera, center, radius);
+        currentCounts[level]++;
+        return shader(level);
+    }
+    Shader& shader(ShadingLevel level)
+    {
+        return variants.get(baseMask | levelMasks[level] | (debugView ? debugMask : 0));
+    }
+    // tint every object by the level it was drawn with: green full, yellow Lambert, red per-vertex
+    // ------------------------------------------------------------------------
+    void setDebugView(bool enabled)
+    {
+        debugView = enabled;
+    }
+    bool debugViewEnabled() const
+    {
+        return debugView;
+    }
+    // draws per level in the previous frame; call endFrame() once per frame to roll them over
+    // ------------------------------------------------------------------------
+    unsigned int lastFrameCount(ShadingLevel level) const
+    {
+        return previousCounts[level];
+    }
+    void endFrame()
+    {
+        for (int level = 0; level < SHADING_LEVEL_COUNT; level++)
+        {
+            previousCounts[level] = currentCounts[level];
+            currentCounts[level] = 0;
+        }
+    }
+
+private:
+    ShaderVariants &variants;
+    unsigned int baseMask;
+    unsigned int levelMasks[SHADING_LEVEL_COUNT];
+    unsigned int debugMask;
+    bool debugView = false;
+    unsigned int currentCounts[SHADING_LEVEL_COUNT] = {};
+    unsigned int previousCounts[SHADING_LEVEL_COUNT] = {};
+};
+#endif
@@ -274,6 +274,13 @@ RECENT REVISION HISTORY:
 // you have issues compiling it, you can disable it entirely by
 // defining STBI_NO_SIMD.
 //
+// Additions in this copy: on x64 the JPEG color conversion and 2x upsampling
+// also have AVX2 kernels, picked at run time when the CPU supports AVX2
+// (define STBI_NO_AVX2 to leave them out), and PNG rows of 8-bit RGB/RGBA
+// are unfiltered with SSE2. They produce exactly the bytes the stock kernels
+// do; stbi_set_vectorized_kernels(0) goes back to the stock ones, for
+// comparing the two.
+//
 // ===========================================================================
 //
 // HDR image support   (disable by defining STBI_NO_HDR)
@@ -524,6 +531,10 @@ STBIDEF void stbi_set_unpremultiply_on_load_thread(int flag_true_if_should_unpre
 STBIDEF void stbi_convert_iphone_png_to_rgb_thread(int flag_true_if_should_convert);
 STBIDEF void stbi_set_flip_vertically_on_load_thread(int flag_true_if_should_flip);
 
+// use the vectorized PNG unfiltering and AVX2 JPEG kernels where the CPU has them (the
+// default), or only the kernels stb_image ships with. the output is the same either way
+STBIDEF void stbi_set_vectorized_kernels(int flag_true_if_should_vectorize);
+
 // ZLIB client - used by PNG, available for other purposes
 
 STBIDEF char *stbi_zlib_decode_malloc_guesssize(const char *buffer, int len, int initial_size, int *outlen);
@@ -750,7 +761,7 @@ static int stbi__cpuid3(void)
 
 #define STBI_SIMD_ALIGN(type, name) __declspec(align(16)) type name
 
-#if !defined(STBI_NO_JPEG) && defined(STBI_SSE2)
+#if (!defined(STBI_NO_JPEG) || !defined(STBI_NO_PNG)) && defined(STBI_SSE2)
 static int stbi__sse2_available(void)
 {
    int info3 = stbi__cpuid3();
@@ -761,7 +772,7 @@ static int stbi__sse2_available(void)
 #else // assume GCC-style if not VC++
 #define STBI_SIMD_ALIGN(type, name) type name __attribute__((aligned(16)))
 
-#if !defined(STBI_NO_JPEG) && defined(STBI_SSE2)
+#if (!defined(STBI_NO_JPEG) || !defined(STBI_NO_PNG)) && defined(STBI_SSE2)
 static int stbi__sse2_available(void)
 {
    // If we're even attempting to compile this on GCC/Clang, that means
@@ -774,6 +785,34 @@ static int stbi__sse2_available(void)
 #endif
 #endif
 
+// AVX2 JPEG kernels, picked at run time. gcc and clang compile just those functions for
+// AVX2 through a target attribute, everything else stays SSE2
+#if defined(STBI_SSE2) && defined(STBI__X64_TARGET) && !defined(STBI_NO_AVX2) && !defined(STBI_NO_JPEG) && \
+    (defined(__GNUC__) || defined(__clang__) || (defined(_MSC_VER) && _MSC_VER >= 1700))
+#define STBI_AVX2
+#include <immintrin.h>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define STBI__AVX2_TARGET
+static int stbi__avx2_available(void)
+{
+   int info[4];
+   __cpuid(info, 1);
+   // OSXSAVE, and the OS saving the YMM registers
+   if (((info[2] >> 27) & 1) == 0 || (_xgetbv(0) & 6) != 6)
+      return 0;
+   __cpuidex(info, 7, 0);
+   return (info[1] >> 5) & 1;
+}
+#else
+#define STBI__AVX2_TARGET __attribute__((target("avx2")))
+static int stbi__avx2_available(void)
+{
+   return __builtin_cpu_supports("avx2");
+}
+#endif
+#endif
+
 // ARM NEON
 #if defined(STBI_NO_SIMD) && defined(STBI_NEON)
 #undef STBI_NEON
@@ -1112,6 +1151,12 @@ static stbi_uc *stbi__hdr_to_ldr(float   *data, int x, int y, int comp);
 #endif
 
 static int stbi__vertically_flip_on_load_global = 0;
+static int stbi__vectorized_kernels = 1;
+
+STBIDEF void stbi_set_vectorized_kernels(int flag_true_if_should_vectorize)
+{
+   stbi__vectorized_kernels = flag_true_if_should_vectorize;
+}
 
 STBIDEF void stbi_set_flip_vertically_on_load(int flag_true_if_should_flip)
 {
@@ -1998,6 +2043,7 @@ typedef struct
    void (*idct_block_kernel)(stbi_uc *out, int out_stride, short data[64]);
    void (*YCbCr_to_RGB_kernel)(stbi_uc *out, const stbi_uc *y, const stbi_uc *pcb, const stbi_uc *pcr, int count, int step);
    stbi_uc *(*resample_row_hv_2_kernel)(stbi_uc *out, stbi_uc *in_near, stbi_uc *in_far, int w, int hs);
+   stbi_uc *(*resample_row_h_2_kernel)(stbi_uc *out, stbi_uc *in_near, stbi_uc *in_far, int w, int hs);
 } stbi__jpeg;
 
 static int stbi__build_huffman(stbi__huffman *h, int *count)
@@ -3817,12 +3863,151 @@ static void stbi__YCbCr_to_RGB_simd(stbi_uc *out, stbi_uc const *y, stbi_uc cons
 }
 #endif
 
+#ifdef STBI_AVX2
+// AVX2 versions of the kernels above, 16 pixels at a time. the arithmetic is the same
+// integer arithmetic, so they give the same bytes
+
+// the interleave of two rows of 16 16-bit values, packed to 32 bytes in order. unpack and
+// pack work within 128-bit lanes, which puts the two halves back in sequence
+STBI__AVX2_TARGET static __m256i stbi__interleave_pack_avx2(__m256i even, __m256i odd, int shift)
+{
+   __m256i lo = _mm256_srli_epi16(_mm256_unpacklo_epi16(even, odd), shift);
+   __m256i hi = _mm256_srli_epi16(_mm256_unpackhi_epi16(even, odd), shift);
+   return _mm256_packus_epi16(lo, hi);
+}
+
+STBI__AVX2_TARGET static __m256i stbi__load16_avx2(const stbi_uc *p)
+{
+   return _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *) p));
+}
+
+STBI__AVX2_TARGET static stbi_uc *stbi__resample_row_h_2_avx2(stbi_uc *out, stbi_uc *in_near, stbi_uc *in_far, int w, int hs)
+{
+   int i;
+   stbi_uc *input = in_near;
+
+   if (w == 1) {
+      out[0] = out[1] = input[0];
+      return out;
+   }
+
+   out[0] = input[0];
+   out[1] = stbi__div4(input[0]*3 + input[1] + 2);
+   // the loads reach one pixel to either side, so stop 16 short of the last pixel
+   for (i=1; i + 16 < w; i += 16) {
+      __m256i n = _mm256_add_epi16(_mm256_mullo_epi16(stbi__load16_avx2(input + i), _mm256_set1_epi16(3)), _mm256_set1_epi16(2));
+      __m256i even = _mm256_add_epi16(n, stbi__load16_avx2(input + i - 1));
+      __m256i odd  = _mm256_add_epi16(n, stbi__load16_avx2(input + i + 1));
+      _mm256_storeu_si256((__m256i *) (out + i*2), stbi__interleave_pack_avx2(even, odd, 2));
+   }
+   for (; i < w-1; ++i) {
+      int n = 3*input[i]+2;
+      out[i*2+0] = stbi__div4(n+input[i-1]);
+      out[i*2+1] = stbi__div4(n+input[i+1]);
+   }
+   out[i*2+0] = stbi__div4(input[w-2]*3 + input[w-1] + 2);
+   out[i*2+1] = input[w-1];
+
+   STBI_NOTUSED(in_far);
+   STBI_NOTUSED(hs);
+
+   return out;
+}
+
+STBI__AVX2_TARGET static stbi_uc *stbi__resample_row_hv_2_avx2(stbi_uc *out, stbi_uc *in_near, stbi_uc *in_far, int w, int hs)
+{
+   int i,t0,t1;
+   __m256i three = _mm256_set1_epi16(3);
+   __m256i bias = _mm256_set1_epi16(8);
+
+   if (w == 1) {
+      out[0] = out[1] = stbi__div4(3*in_near[0] + in_far[0] + 2);
+      return out;
+   }
+
+   out[0] = stbi__div4(3*in_near[0] + in_far[0] + 2);
+   // output pixels 2i-1 and 2i blend the vertically filtered columns i-1 and i
+   for (i=1; i + 16 <= w; i += 16) {
+      __m256i prev = _mm256_add_epi16(_mm256_mullo_epi16(stbi__load16_avx2(in_near + i - 1), three), stbi__load16_avx2(in_far + i - 1));
+      __m256i curr = _mm256_add_epi16(_mm256_mullo_epi16(stbi__load16_avx2(in_near + i), three), stbi__load16_avx2(in_far + i));
+      __m256i odd  = _mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(prev, three), curr), bias);
+      __m256i even = _mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(curr, three), prev), bias);
+      _mm256_storeu_si256((__m256i *) (out + i*2 - 1), stbi__interleave_pack_avx2(odd, even, 4));
+   }
+   t1 = 3*in_near[i-1] + in_far[i-1];
+   for (; i < w; ++i) {
+      t0 = t1;
+      t1 = 3*in_near[i]+in_far[i];
+      out[i*2-1] = stbi__div16(3*t0 + t1 + 8);
+      out[i*2  ] = stbi__div16(3*t1 + t0 + 8);
+   }
+   out[w*2-1] = stbi__div4(t1+2);
+
+   STBI_NOTUSED(hs);
+
+   return out;
+}
+
+STBI__AVX2_TARGET static void stbi__YCbCr_to_RGB_avx2(stbi_uc *out, stbi_uc const *y, stbi_uc const *pcb, stbi_uc const *pcr, int count, int step)
+{
+   int i = 0;
+   if (step == 4) {
+      __m256i signflip  = _mm256_set1_epi16(0x80);
+      __m256i cr_const0 = _mm256_set1_epi16(   (short) ( 1.40200f*4096.0f+0.5f));
+      __m256i cr_const1 = _mm256_set1_epi16( - (short) ( 0.71414f*4096.0f+0.5f));
+      __m256i cb_const0 = _mm256_set1_epi16( - (short) ( 0.34414f*4096.0f+0.5f));
+      __m256i cb_const1 = _mm256_set1_epi16(   (short) ( 1.77200f*4096.0f+0.5f));
+      __m256i y_bias = _mm256_set1_epi16(128);
+      __m256i xw = _mm256_set1_epi16(255); // alpha channel
+
+      for (; i+15 < count; i += 16) {
+         // the same words the SSE2 kernel unpacks: y << 8 | 128, (c - 128) << 8
+         __m256i yw  = _mm256_or_si256(_mm256_slli_epi16(stbi__load16_avx2(y+i), 8), y_bias);
+         __m256i crw = _mm256_slli_epi16(_mm256_xor_si256(stbi__load16_avx2(pcr+i), signflip), 8);
+         __m256i cbw = _mm256_slli_epi16(_mm256_xor_si256(stbi__load16_avx2(pcb+i), signflip), 8);
+
+         // color transform
+         __m256i yws = _mm256_srli_epi16(yw, 4);
+         __m256i cr0 = _mm256_mulhi_epi16(cr_const0, crw);
+         __m256i cb0 = _mm256_mulhi_epi16(cb_const0, cbw);
+         __m256i cb1 = _mm256_mulhi_epi16(cbw, cb_const1);
+         __m256i cr1 = _mm256_mulhi_epi16(crw, cr_const1);
+         __m256i rws = _mm256_add_epi16(cr0, yws);
+         __m256i gwt = _mm256_add_epi16(cb0, yws);
+         __m256i bws = _mm256_add_epi16(yws, cb1);
+         __m256i gws = _mm256_add_epi16(gwt, cr1);
+
+         // descale
+         __m256i rw = _mm256_srai_epi16(rws, 4);
+         __m256i bw = _mm256_srai_epi16(bws, 4);
+         __m256i gw = _mm256_srai_epi16(gws, 4);
+
+         // back to byte and interleave, within each 128-bit lane: pixels 0-3 | 8-11 and 4-7 | 12-15
+         __m256i brb = _mm256_packus_epi16(rw, bw);
+         __m256i gxb = _mm256_packus_epi16(gw, xw);
+         __m256i t0 = _mm256_unpacklo_epi8(brb, gxb);
+         __m256i t1 = _mm256_unpackhi_epi8(brb, gxb);
+         __m256i o0 = _mm256_unpacklo_epi16(t0, t1);
+         __m256i o1 = _mm256_unpackhi_epi16(t0, t1);
+
+         // store in pixel order
+         _mm256_storeu_si256((__m256i *) (out + 0), _mm256_permute2x128_si256(o0, o1, 0x20));
+         _mm256_storeu_si256((__m256i *) (out + 32), _mm256_permute2x128_si256(o0, o1, 0x31));
+         out += 64;
+      }
+   }
+   // the rest of the row, and other steps, as the SSE2 kernel does them
+   stbi__YCbCr_to_RGB_simd(out, y+i, pcb+i, pcr+i, count-i, step);
+}
+#endif // STBI_AVX2
+
 // set up the kernels
 static void stbi__setup_jpeg(stbi__jpeg *j)
 {
    j->idct_block_kernel = stbi__idct_block;
    j->YCbCr_to_RGB_kernel = stbi__YCbCr_to_RGB_row;
    j->resample_row_hv_2_kernel = stbi__resample_row_hv_2;
+   j->resample_row_h_2_kernel = stbi__resample_row_h_2;
 
 #ifdef STBI_SSE2
    if (stbi__sse2_available()) {
@@ -3832,6 +4017,14 @@ static void stbi__setup_jpeg(stbi__jpeg *j)
    }
 #endif
 
+#ifdef STBI_AVX2
+   if (stbi__vectorized_kernels && stbi__avx2_available()) {
+      j->YCbCr_to_RGB_kernel = stbi__YCbCr_to_RGB_avx2;
+      j->resample_row_hv_2_kernel = stbi__resample_row_hv_2_avx2;
+      j->resample_row_h_2_kernel = stbi__resample_row_h_2_avx2;
+   }
+#endif
+
 #ifdef STBI_NEON
    j->idct_block_kernel = stbi__idct_simd;
    j->YCbCr_to_RGB_kernel = stbi__YCbCr_to_RGB_simd;
@@ -3913,7 +4106,7 @@ static stbi_uc *load_jpeg_image(stbi__jpeg *z, int *out_x, int *out_y, int *comp
 
          if      (r->hs == 1 && r->vs == 1) r->resample = resample_row_1;
          else if (r->hs == 1 && r->vs == 2) r->resample = stbi__resample_row_v_2;
-         else if (r->hs == 2 && r->vs == 1) r->resample = stbi__resample_row_h_2;
+         else if (r->hs == 2 && r->vs == 1) r->resample = z->resample_row_h_2_kernel;
          else if (r->hs == 2 && r->vs == 2) r->resample = z->resample_row_hv_2_kernel;
          else                               r->resample = stbi__resample_row_generic;
       }
@@ -4692,6 +4885,99 @@ static void stbi__create_png_alpha_expand8(stbi_uc *dest, stbi_uc *src, stbi__ui
    }
 }
 
+#ifdef STBI_SSE2
+// SSE2 unfiltering. Up works on 16 bytes at a time; Sub, Avg and Paeth depend on the pixel to
+// the left, so they work a whole 3 or 4 byte pixel at a time in 16-bit lanes. returns 0 for
+// the rows they don't cover (other pixel sizes), which take the scalar loops
+static __m128i stbi__png_load_pixel(const stbi_uc *p, int n)
+{
+   stbi__uint32 v;
+   if (n == 4)
+      memcpy(&v, p, 4);
+   else // 3 byte pixels must not read past the row
+      v = p[0] | (p[1] << 8) | ((stbi__uint32) p[2] << 16);
+   return _mm_unpacklo_epi8(_mm_cvtsi32_si128((int) v), _mm_setzero_si128());
+}
+
+static void stbi__png_store_pixel(stbi_uc *p, __m128i v, int n)
+{
+   stbi__uint32 packed = (stbi__uint32) _mm_cvtsi128_si32(_mm_packus_epi16(v, v));
+   if (n == 4) {
+      memcpy(p, &packed, 4);
+   } else {
+      p[0] = (stbi_uc) packed;
+      p[1] = (stbi_uc) (packed >> 8);
+      p[2] = (stbi_uc) (packed >> 16);
+   }
+}
+
+static __m128i stbi__png_abs16(__m128i v)
+{
+   return _mm_max_epi16(v, _mm_sub_epi16(_mm_setzero_si128(), v));
+}
+
+// the PNG spec's predictor: whichever of a, b, c is closest to a + b - c, preferring a, then b
+static __m128i stbi__png_paeth_sse2(__m128i a, __m128i b, __m128i c)
+{
+   __m128i bc = _mm_sub_epi16(b, c);
+   __m128i ac = _mm_sub_epi16(a, c);
+   __m128i pa = stbi__png_abs16(bc);
+   __m128i pb = stbi__png_abs16(ac);
+   __m128i pc = stbi__png_abs16(_mm_add_epi16(bc, ac));
+   __m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+   __m128i use_b = _mm_cmpeq_epi16(pb, smallest);
+   __m128i use_a = _mm_cmpeq_epi16(pa, smallest);
+   __m128i pred = _mm_or_si128(_mm_and_si128(use_b, b), _mm_andnot_si128(use_b, c));
+   return _mm_or_si128(_mm_and_si128(use_a, a), _mm_andnot_si128(use_a, pred));
+}
+
+static int stbi__png_unfilter_sse2(int filter, stbi_uc *cur, stbi_uc *prior, stbi_uc *raw, int nk, int filter_bytes)
+{
+   int k;
+   __m128i low = _mm_set1_epi16(0xff);
+   __m128i a = _mm_setzero_si128(); // left, 0 before the first pixel
+   __m128i b = _mm_setzero_si128(); // above
+   __m128i c = _mm_setzero_si128(); // above left
+
+   if (filter == STBI__F_up) {
+      for (k = 0; k + 16 <= nk; k += 16)
+         _mm_storeu_si128((__m128i *) (cur + k), _mm_add_epi8(_mm_loadu_si128((__m128i *) (raw + k)), _mm_loadu_si128((__m128i *) (prior + k))));
+      for (; k < nk; ++k)
+         cur[k] = STBI__BYTECAST(raw[k] + prior[k]);
+      return 1;
+   }
+   if (filter_bytes != 3 && filter_bytes != 4)
+      return 0;
+
+   switch (filter) {
+   case STBI__F_sub:
+      for (k = 0; k < nk; k += filter_bytes) {
+         a = _mm_and_si128(_mm_add_epi16(stbi__png_load_pixel(raw + k, filter_bytes), a), low);
+         stbi__png_store_pixel(cur + k, a, filter_bytes);
+      }
+      return 1;
+   case STBI__F_avg:
+   case STBI__F_avg_first:
+      for (k = 0; k < nk; k += filter_bytes) {
+         if (filter == STBI__F_avg)
+            b = stbi__png_load_pixel(prior + k, filter_bytes);
+         a = _mm_and_si128(_mm_add_epi16(stbi__png_load_pixel(raw + k, filter_bytes), _mm_srli_epi16(_mm_add_epi16(a, b), 1)), low);
+         stbi__png_store_pixel(cur + k, a, filter_bytes);
+      }
+      return 1;
+   case STBI__F_paeth:
+      for (k = 0; k < nk; k += filter_bytes) {
+         b = stbi__png_load_pixel(prior + k, filter_bytes);
+         a = _mm_and_si128(_mm_add_epi16(stbi__png_load_pixel(raw + k, filter_bytes), stbi__png_paeth_sse2(a, b, c)), low);
+         c = b;
+         stbi__png_store_pixel(cur + k, a, filter_bytes);
+      }
+      return 1;
+   }
+   return 0;
+}
+#endif
+
 // create the png data from post-deflated data
 static int stbi__create_png_image_raw(stbi__png *a, stbi_uc *raw, stbi__uint32 raw_len, int out_n, stbi__uint32 x, stbi__uint32 y, int depth, int color)
 {
@@ -4752,6 +5038,9 @@ static int stbi__create_png_image_raw(stbi__png *a, stbi_uc *raw, stbi__uint32 r
       if (j == 0) filter = first_row_filter[filter];
 
       // perform actual filtering
+#ifdef STBI_SSE2
+      if (!(stbi__vectorized_kernels && stbi__sse2_available() && stbi__png_unfilter_sse2(filter, cur, prior, raw, nk, filter_bytes)))
+#endif
       switch (filter) {
       case STBI__F_none:
          memcpy(cur, raw, nk);
@@ -0,0 +1,615 @@
+#ifndef TEXTURE_ARRAY_H
+#define TEXTURE_ARRAY_H
+
+#include <glad/glad.h>
+
+#include <../includes/texture_cache.h>
+#include <../includes/glm/glm/glm.hpp>
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+
+// where a material finds one of its textures: a layer of a GL_TEXTURE_2D_ARRAY and the part of the layer
+// the image covers - all of it, or its place on an atlas page. the shaders sample
+// texture(array, vec3(rect.xy + uv * rect.zw, layer)), see src/common/lighting.glsl
+struct TextureRegion
+{
+    unsigned int texture = 0; // the array, 0 if the image failed to load
+    float layer = 0.0f;       // a float, as the shader takes it
+    glm::vec4 rect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f); // uv offset (xy) and scale (zw) in the layer
+
+    bool loaded() const
+    {
+        return texture != 0;
+    }
+};
+
+// what every layer of an array holds. images of the same size, level count and format share arrays
+struct TextureShape
+{
+    int width = 0;
+    int height = 0;
+    int levels = 0;
+    bool compressed = false;
+    BlockFormat format = BLOCK_BC1; // when compressed, uncompressed layers are RGBA8
+    bool atlas = false;             // placed on an atlas page instead of a layer of its own
+
+    bool operator==(const TextureShape &other) const
+    {
+        return width == other.width && height == other.height && levels == other.levels && compressed == other.compressed &&
+               (!compressed || format == other.format) && atlas == other.atlas;
+    }
+};
+
+// Packs rectangles into a page of a fixed size, so many small images share one layer. Skyline bottom-left:
+// the top edge of what is packed so far is kept as a row of horizontal segments, and every rectangle goes
+// where it ends up lowest, leftmost on a tie. Rectangles are never taken out again, a full page is
+// followed by a new one.
+class AtlasPacker
+{
+public:
+    AtlasPacker(int width, int height)
+        : width(width), height(height)
+    {
+        skyline.push_back({ 0, 0, width });
+    }
+
+    // place a rectangle, false if the page has no room left for it
+    // ------------------------------------------------------------------------
+    bool insert(int rectWidth, int rectHeight, int &x, int &y)
+    {
+        size_t best = skyline.size();
+        int bestTop = height;
+        for (size_t i = 0; i < skyline.size(); i++)
+        {
+            int top;
+            if (fits(i, rectWidth, rectHeight, top) && top < bestTop)
+            {
+                best = i;
+                bestTop = top;
+            }
+        }
+        if (best == skyline.size())
+            return false;
+        x = skyline[best].x;
+        y = bestTop;
+
+        // the rectangle's top becomes a segment, the segments it covers are cut back or dropped
+        skyline.insert(skyline.begin() + best, { x, y + rectHeight, rectWidth });
+        int end = x + rectWidth;
+        for (size_t i = best + 1; i < skyline.size() && skyline[i].x < end;)
+        {
+            Segment &segment = skyline[i];
+            int covered = end - segment.x;
+            if (covered < segment.width)
+            {
+                segment.x += covered;
+                segment.width -= covered;
+                break;
+            }
+            skyline.erase(skyline.begin() + i);
+        }
+        // neighbours at the same height are one segment
+        for (size_t i = 0; i + 1 < skyline.size();)
+        {
+            if (skyline[i].y == skyline[i + 1].y)
+            {
+                skyline[i].width += skyline[i + 1].width;
+                skyline.erase(skyline.begin() + i + 1);
+            }
+            else
+                i++;
+        }
+        used += (size_t)rectWidth * rectHeight;
+        return true;
+    }
+    // the share of the page covered by rectangles
+    float occupancy() const
+    {
+        return (float)((double)used / ((double)width * height));
+    }
+
+private:
+    struct Segment
+    {
+        int x;
+        int y;     // top of what is packed below this segment
+        int width;
+    };
+
+    int width;
+    int height;
+    std::vector<Segment> skyline; // left to right, covering the page's width
+    size_t used = 0;
+
+    // whether a rectangle whose left edge is at segment index fits on the page, and the y it rests at
+    // ------------------------------------------------------------------------
+    bool fits(size_t index, int rectWidth, int rectHeight, int &top) const
+    {
+        if (skyline[index].x + rectWidth > width)
+            return false;
+        top = 0;
+        for (size_t i = index, remaining = 0; remaining < (size_t)rectWidth; i++)
+        {
+            top = std::max(top, skyline[i].y);
+            remaining += skyline[i].width;
+        }
+        return top + rectHeight <= height;
+    }
+};
+
+// One GL_TEXTURE_2D_ARRAY of a fixed shape and number of layers, all of its storage allocated up front.
+// Layers are handed out in order and never given back. Filtering and wrapping are those of Texture:
+// trilinear, GL_REPEAT.
+//
+// Uploads bind the array on a texture unit of their own, the last one, so the arrays bound for drawing
+// stay bound; they leave unit 0 active.
+class TextureArray
+{
+public:
+    unsigned int ID = 0;
+    TextureShape shape;
+    int capacity;
+    int used = 0; // layers handed out
+
+    TextureArray(const TextureShape &shape, int capacity)
+        : shape(shape), capacity(capacity)
+    {
+        glGenTextures(1, &ID);
+        bindForUpload();
+        int levelWidth = shape.width, levelHeight = shape.height;
+        for (int level = 0; level < shape.levels; level++)
+        {
+            if (shape.compressed)
+                glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, level, Texture::compressedFormat(shape.format), levelWidth, levelHeight,
+                                       capacity, 0, (GLsizei)(BlockCodec::imageBytes(shape.format, levelWidth, levelHeight) * capacity), NULL);
+            else
+                glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA8, levelWidth, levelHeight, capacity, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+            levelWidth = std::max(1, levelWidth / 2);
+            levelHeight = std::max(1, levelHeight / 2);
+        }
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, shape.levels - 1);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, shape.levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glActiveTexture(GL_TEXTURE0);
+    }
+    ~TextureArray()
+    {
+        glDeleteTextures(1, &ID);
+    }
+    TextureArray(const TextureArray&) = delete;
+    TextureArray& operator=(const TextureArray&) = delete;
+
+    // the next free layer, -1 when the array is full
+    // ------------------------------------------------------------------------
+    int allocate()
+    {
+        return used < capacity ? used++ : -1;
+    }
+    // write the levels of a mip chain into a layer, level 0 at (x, y) and every level below at (x, y) halved.
+    // as Texture::upload, levels is an offset into a bound GL_PIXEL_UNPACK_BUFFER if there is one. levels
+    // past the array's are left out
+    // ------------------------------------------------------------------------
+    void upload(int layer, int x, int y, const unsigned char *levels, const MipChain &chain, int rowAlignment = 1)
+    {
+        GLenum format = Texture::pixelFormat(chain.channels);
+        bindForUpload();
+        glPixelStorei(GL_UNPACK_ALIGNMENT, rowAlignment);
+        for (size_t level = 0; level < chain.levels.size() && (int)level < shape.levels; level++)
+        {
+            const MipLevel &mip = chain.levels[level];
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, (GLint)level, x >> level, y >> level, layer, mip.width, mip.height, 1, format,
+                            GL_UNSIGNED_BYTE, levels + mip.offset);
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glActiveTexture(GL_TEXTURE0);
+    }
+    // the same for the block compressed levels of a whole layer
+    // ------------------------------------------------------------------------
+    void upload(int layer, const unsigned char *blocks, const std::vector<MipLevel> &mips)
+    {
+        bindForUpload();
+        for (size_t level = 0; level < mips.size() && (int)level < shape.levels; level++)
+        {
+            const MipLevel &mip = mips[level];
+            glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, (GLint)level, 0, 0, layer, mip.width, mip.height, 1,
+                                      Texture::compressedFormat(shape.format), (GLsizei)mip.size, blocks + mip.offset);
+        }
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+private:
+    // ------------------------------------------------------------------------
+    void bindForUpload() const
+    {
+        static GLint units = 0;
+        if (units == 0)
+            glGetIntegerv(GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS, &units);
+        glActiveTexture(GL_TEXTURE0 + units - 1);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, ID);
+    }
+};
+
+// Puts textures into the layers of texture arrays, so materials differ by a layer index instead of a
+// texture binding: with the arrays bound once, any number of objects draw without binding textures in
+// between (see TextureRegion). Images of the same size, level count and format share arrays of
+// layersPerArray layers, a new array is started when one fills up.
+//
+// Images no larger than atlasMaxImage on either side go onto atlas pages instead: atlasSize square layers
+// of an RGBA8 array of their own, where AtlasPacker finds them a place. Every image there is surrounded by
+// ATLAS_PADDING texels of its own edge, so filtering doesn't pick up its neighbours, and the pages have
+// ATLAS_LEVELS mip levels - the padding is one texel on the last. An image on an atlas page can't repeat,
+// set atlasMaxImage to 0 when small textures tile. Texture files and KTX2 files (see TextureCache) always
+// get a layer of their own: their mip chain is used as it is.
+//
+// Regions are cached on the file and the load options like TextureCache does, and live as long as the
+// allocator does - layers are not freed.
+class TextureArrays
+{
+public:
+    static const int ATLAS_PADDING = 4;
+    static const int ATLAS_LEVELS = 3;
+
+    struct Stats
+    {
+        unsigned int arrays = 0;     // array textures, atlas pages' included
+        unsigned int layers = 0;     // layers in use, atlas pages' included
+        unsigned int atlasImages = 0;
+        unsigned int atlasPages = 0;
+        float atlasOccupancy = 0.0f; // of all the pages together
+    };
+
+    TextureArrays(int layersPerArray = 8, int atlasSize = 1024, int atlasMaxImage = 128)
+        : layersPerArray(layersPerArray), atlasSize(atlasSize), atlasMaxImage(atlasMaxImage)
+    {
+    }
+    TextureArrays(const TextureArrays&) = delete;
+    TextureArrays& operator=(const TextureArrays&) = delete;
+
+    // decode (or map) a file and upload it into its region now. see AsyncTextureLoader for loading on
+    // worker threads instead
+    // ------------------------------------------------------------------------
+    TextureRegion load(const std::string &path, TextureOptions options = TextureOptions())
+    {
+        TextureRegion region = find(path, options);
+        if (region.loaded())
+            return region;
+        if (TextureCache::compressed(path))
+            region = loadCompressed(path, options);
+        else if (TextureCache::packed(path))
+            region = loadPacked(path, options);
+        else
+            region = loadImage(path, options);
+        if (!region.loaded())
+            std::cout << "Texture failed to load at path: " << path << std::endl;
+        return region;
+    }
+    // the region of a file that was loaded (or is being loaded) before, an empty one otherwise
+    // ------------------------------------------------------------------------
+    TextureRegion find(const std::string &path, const TextureOptions &options) const
+    {
+        auto found = regions.find(TextureCache::keyFor(path, options));
+        return found == regions.end() ? TextureRegion() : found->second;
+    }
+    // the shape a file will be uploaded with, from its header only. false if it can't be read, or if a
+    // prepared file was written for other options than these
+    // ------------------------------------------------------------------------
+    bool probe(const std::string &path, const TextureOptions &options, TextureShape &shape) const
+    {
+        if (TextureCache::compressed(path))
+        {
+            Ktx2File file;
+            if (!TextureCache::openCompressed(file, path, options))
+                return false;
+            shape = compressedShape(file.format, file.levels);
+            return true;
+        }
+        if (TextureCache::packed(path))
+        {
+            TextureFile file;
+            if (!TextureCache::openPacked(file, path, options))
+                return false;
+            shape = file.compressed ? compressedShape(file.format, file.layout.levels) : layerShape(file.layout.levels);
+            return true;
+        }
+        int width, height, channels;
+        if (!stbi_info(path.c_str(), &width, &height, &channels))
+            return false;
+        shape = imageShape(width, height);
+        return true;
+    }
+    // place an image of a shape: a new layer, or a rectangle of an atlas page. the region is what find()
+    // returns for the file from now on, its texels are undefined until upload()
+    // ------------------------------------------------------------------------
+    TextureRegion allocate(const std::string &path, const TextureOptions &options, const TextureShape &shape)
+    {
+        TextureRegion region;
+        if (shape.atlas)
+        {
+            MipChain cell = atlasChain(shape.width, shape.height, 4);
+            int cellWidth = cell.levels[0].width, cellHeight = cell.levels[0].height;
+            Page *page = nullptr;
+            int x = 0, y = 0;
+            for (Page &candidate : pages)
+            {
+                if (candidate.packer.insert(cellWidth, cellHeight, x, y))
+                {
+                    page = &candidate;
+                    break;
+                }
+            }
+            if (!page)
+            {
+                TextureShape pageShape;
+                pageShape.width = pageShape.height = atlasSize;
+                pageShape.levels = ATLAS_LEVELS;
+                pageShape.atlas = true;
+                Page fresh = { nullptr, 0, AtlasPacker(atlasSize, atlasSize) };
+                fresh.layer = newLayer(pageShape, fresh.array);
+                pages.push_back(fresh);
+                page = &pages.back();
+                page->packer.insert(cellWidth, cellHeight, x, y);
+            }
+            region.texture = page->array->ID;
+            region.layer = (float)page->layer;
+            float texel = 1.0f / atlasSize;
+            region.rect = glm::vec4((x + ATLAS_PADDING) * texel, (y + ATLAS_PADDING) * texel, shape.width * texel, shape.height * texel);
+            atlasImages++;
+        }
+        else
+        {
+            TextureArray *array;
+            region.layer = (float)newLayer(shape, array);
+            region.texture = array->ID;
+        }
+        regions[TextureCache::keyFor(path, options)] = region;
+        return region;
+    }
+    // write an uncompressed image into its region. an atlas region takes the padded chain of atlasChain()
+    // ------------------------------------------------------------------------
+    void upload(const TextureRegion &region, const unsigned char *levels, const MipChain &chain, int rowAlignment = 1)
+    {
+        TextureArray *array = arrayOf(region);
+        if (!array || array->shape.compressed)
+            return;
+        int x = 0, y = 0;
+        if (array->shape.atlas)
+        {
+            x = (int)std::lround(region.rect.x * atlasSize) - ATLAS_PADDING;
+            y = (int)std::lround(region.rect.y * atlasSize) - ATLAS_PADDING;
+        }
+        array->upload((int)region.layer, x, y, levels, chain, rowAlignment);
+    }
+    // write block compressed levels into their layer
+    // ------------------------------------------------------------------------
+    void upload(const TextureRegion &region, const unsigned char *blocks, const std::vector<MipLevel> &levels)
+    {
+        TextureArray *array = arrayOf(region);
+        if (array && array->shape.compressed)
+            array->upload((int)region.layer, blocks, levels);
+    }
+    // fill a region with one color, for showing something until its image is uploaded
+    // ------------------------------------------------------------------------
+    void fill(const TextureRegion &region, const unsigned char color[4])
+    {
+        TextureArray *array = arrayOf(region);
+        if (!array)
+            return;
+        const TextureShape &shape = array->shape;
+        int width = shape.atlas ? (int)std::lround(region.rect.z * atlasSize) : shape.width;
+        int height = shape.atlas ? (int)std::lround(region.rect.w * atlasSize) : shape.height;
+        if (shape.compressed)
+        {
+            // one solid block, repeated over every level
+            unsigned char texels[64], block[16];
+            for (int texel = 0; texel < 16; texel++)
+                std::memcpy(texels + texel * 4, color, 4);
+            BlockCodec::encodeBlock(shape.format, texels, block);
+            size_t size;
+            std::vector<MipLevel> levels = Ktx2File::layout(shape.format, width, height, shape.levels, size);
+            std::vector<unsigned char> blocks(size);
+            for (size_t offset = 0; offset < size; offset += BlockCodec::blockBytes(shape.format))
+                std::memcpy(blocks.data() + offset, block, BlockCodec::blockBytes(shape.format));
+            array->upload((int)region.layer, blocks.data(), levels);
+            return;
+        }
+        MipChain chain = shape.atlas ? atlasChain(width, height, 4) : MipChain(width, height, 4);
+        chain.levels.resize(std::min(chain.levels.size(), (size_t)shape.levels));
+        std::vector<unsigned char> texels(chain.levels.back().offset + chain.levels.back().size);
+        for (size_t offset = 0; offset < texels.size(); offset += 4)
+            std::memcpy(texels.data() + offset, color, 4);
+        upload(region, texels.data(), chain);
+    }
+    // bind the array of a region to a texture unit
+    // ------------------------------------------------------------------------
+    static void bind(const TextureRegion &region, unsigned int unit)
+    {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, region.texture);
+    }
+    // the mip chain an image goes onto an atlas page as: the image with its padding, rounded up to a
+    // multiple of 4 texels so every level lines up with the page's, ATLAS_LEVELS levels
+    // ------------------------------------------------------------------------
+    static MipChain atlasChain(int width, int height, int channels)
+    {
+        MipChain chain(align(width + 2 * ATLAS_PADDING, 1 << (ATLAS_LEVELS - 1)), align(height + 2 * ATLAS_PADDING, 1 << (ATLAS_LEVELS - 1)), channels);
+        chain.levels.resize(ATLAS_LEVELS);
+        chain.size = chain.levels.back().offset + chain.levels.back().size;
+        return chain;
+    }
+    // copy an image into level 0 of its atlasChain(), surrounded by copies of its edge texels
+    // ------------------------------------------------------------------------
+    static void pad(const unsigned char *image, int width, int height, int channels, unsigned char *out)
+    {
+        MipLevel cell = atlasChain(width, height, channels).levels[0];
+        for (int y = 0; y < cell.height; y++)
+        {
+            const unsigned char *row = image + (size_t)std::min(std::max(y - ATLAS_PADDING, 0), height - 1) * width * channels;
+            unsigned char *target = out + (size_t)y * cell.width * channels;
+            for (int x = 0; x < cell.width; x++)
+                std::memcpy(target + (size_t)x * channels, row + (size_t)std::min(std::max(x - ATLAS_PADDING, 0), width - 1) * channels, channels);
+        }
+    }
+    Stats stats() const
+    {
+        Stats stats;
+        stats.arrays = (unsigned int)arrays.size();
+        for (const std::unique_ptr<TextureArray> &array : arrays)
+            stats.layers += array->used;
+        stats.atlasImages = atlasImages;
+        stats.atlasPages = (unsigned int)pages.size();
+        for (const Page &page : pages)
+            stats.atlasOccupancy += page.packer.occupancy() / pages.size();
+        return stats;
+    }
+
+private:
+    struct Page
+    {
+        TextureArray *array;
+        int layer;
+        AtlasPacker packer;
+    };
+
+    int layersPerArray;
+    int atlasSize;
+    int atlasMaxImage;
+    std::vector<std::unique_ptr<TextureArray>> arrays;
+    std::vector<Page> pages;
+    std::unordered_map<std::string, TextureRegion> regions;
+    unsigned int atlasImages = 0;
+
+    // ------------------------------------------------------------------------
+    static int align(int value, int alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+    // a layer of an array of the shape, in a new array if the others are full
+    // ------------------------------------------------------------------------
+    int newLayer(const TextureShape &shape, TextureArray *&array)
+    {
+        for (const std::unique_ptr<TextureArray> &candidate : arrays)
+        {
+            if (candidate->shape == shape && candidate->used < candidate->capacity)
+            {
+                array = candidate.get();
+                return array->allocate();
+            }
+        }
+        arrays.emplace_back(new TextureArray(shape, layersPerArray));
+        array = arrays.back().get();
+        return array->allocate();
+    }
+    TextureArray* arrayOf(const TextureRegion &region) const
+    {
+        for (const std::unique_ptr<TextureArray> &array : arrays)
+            if (array->ID == region.texture)
+                return array.get();
+        return nullptr;
+    }
+    // ------------------------------------------------------------------------
+    TextureShape imageShape(int width, int height) const
+    {
+        TextureShape shape;
+        shape.width = width;
+        shape.height = height;
+        shape.atlas = width <= atlasMaxImage && height <= atlasMaxImage && width + 2 * ATLAS_PADDING <= atlasSize &&
+                      height + 2 * ATLAS_PADDING <= atlasSize;
+        shape.levels = shape.atlas ? ATLAS_LEVELS : (int)MipChain(width, height, 1).levels.size();
+        return shape;
+    }
+    static TextureShape layerShape(const std::vector<MipLevel> &levels)
+    {
+        TextureShape shape;
+        shape.width = levels[0].width;
+        shape.height = levels[0].height;
+        shape.levels = (int)levels.size();
+        return shape;
+    }
+    // compressed levels stay compressed when the GL has their format and are decoded to RGBA8 otherwise,
+    // as TextureCache::uploadCompressed does
+    static TextureShape compressedShape(BlockFormat format, const std::vector<MipLevel> &levels)
+    {
+        TextureShape shape = layerShape(levels);
+        shape.compressed = Texture::compressedSupported(format);
+        shape.format = format;
+        return shape;
+    }
+    // ------------------------------------------------------------------------
+    TextureRegion loadImage(const std::string &path, const TextureOptions &options)
+    {
+        int width, height, nrComponents;
+        stbi_set_flip_vertically_on_load_thread(options.flip);
+        unsigned char *data = stbi_load(path.c_str(), &width, &height, &nrComponents, options.channels);
+        if (!data)
+            return TextureRegion();
+        int channels = options.channels ? options.channels : nrComponents;
+        TextureShape shape = imageShape(width, height);
+        MipChain chain = shape.atlas ? atlasChain(width, height, channels) : MipChain(width, height, channels);
+        std::vector<unsigned char> levels(chain.size);
+        if (shape.atlas)
+        {
+            std::vector<unsigned char> padded(chain.levels[0].size);
+            pad(data, width, height, channels, padded.data());
+            chain.build(padded.data(), levels.data(), TextureCache::mipOptions(options));
+        }
+        else
+            chain.build(data, levels.data(), TextureCache::mipOptions(options));
+        stbi_image_free(data);
+        TextureRegion region = allocate(path, options, shape);
+        upload(region, levels.data(), chain);
+        return region;
+    }
+    // ------------------------------------------------------------------------
+    TextureRegion loadCompressed(const std::string &path, const TextureOptions &options)
+    {
+        Ktx2File file;
+        std::vector<unsigned char> blocks;
+        if (!TextureCache::openCompressed(file, path, options))
+            return TextureRegion();
+        blocks.resize(file.size);
+        if (!file.read(blocks.data()))
+            return TextureRegion();
+        return uploadLevels(path, options, file.format, file.levels, blocks.data());
+    }
+    // ------------------------------------------------------------------------
+    TextureRegion loadPacked(const std::string &path, const TextureOptions &options)
+    {
+        // the driver copies the texels out of the mapping, which is unmapped when file goes
+        TextureFile file;
+        if (!TextureCache::openPacked(file, path, options))
+            return TextureRegion();
+        if (file.compressed)
+            return uploadLevels(path, options, file.format, file.layout.levels, file.data());
+        TextureRegion region = allocate(path, options, layerShape(file.layout.levels));
+        upload(region, file.data(), file.layout, TextureFile::ROW_ALIGNMENT);
+        return region;
+    }
+    // a layer for block compressed levels, decoded first if the GL lacks their format
+    // ------------------------------------------------------------------------
+    TextureRegion uploadLevels(const std::string &path, const TextureOptions &options, BlockFormat format,
+                               const std::vector<MipLevel> &levels, const unsigned char *blocks)
+    {
+        TextureShape shape = compressedShape(format, levels);
+        TextureRegion region = allocate(path, options, shape);
+        if (shape.compressed)
+        {
+            upload(region, blocks, levels);
+            return region;
+        }
+        MipChain chain = TextureCache::decodedChain(levels);
+        std::vector<unsigned char> decoded(chain.size);
+        TextureCache::decodeLevels(format, levels, blocks, decoded.data());
+        upload(region, decoded.data(), chain);
+        return region;
+    }
+};
+#endif
@@ -0,0 +1,417 @@
+#ifndef TEXTURE_CACHE_H
+#define TEXTURE_CACHE_H
+
+#include <glad/glad.h>
+
+// the translation unit that defines STB_IMAGE_IMPLEMENTATION has usually included stb_image.h already,
+// a second include would emit the implementation twice
+#ifndef STBI_INCLUDE_STB_IMAGE_H
+#include <../includes/stb_image.h>
+#endif
+
+#include <../includes/mip_chain.h>
+#include <../includes/block_compression.h>
+#include <../includes/ktx2.h>
+#include <../includes/texture_file.h>
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <iostream>
+#include <filesystem>
+#include <unordered_map>
+
+// how an image file is turned into a texture. part of the cache key: the same file loaded flipped
+// and unflipped is two textures
+struct TextureOptions
+{
+    bool flip = false; // flip vertically on load, for images stored top row first
+    int channels = 0;  // 1..4 to convert on load, 0 keeps the file's own channel count
+    bool srgb = true;  // the pixels are sRGB colors, mipmapped in linear light. false for data (specular maps, ...)
+};
+
+// a 2D texture owned by whoever holds a reference to it, deleted with the last one
+class Texture
+{
+public:
+    unsigned int ID = 0;
+    int width = 0;
+    int height = 0;
+    int channels = 0; // 0 if the file failed to load, ID is then an empty texture
+
+    Texture()
+    {
+        glGenTextures(1, &ID);
+    }
+    ~Texture()
+    {
+        glDeleteTextures(1, &ID);
+    }
+    Texture(const Texture&) = delete;
+    Texture& operator=(const Texture&) = delete;
+
+    bool loaded() const
+    {
+        return channels > 0;
+    }
+    // (re)define the texture from every level of a mip chain (see includes/mip_chain.h), with trilinear
+    // filtering and GL_REPEAT wrapping. with a buffer bound to GL_PIXEL_UNPACK_BUFFER, levels is an
+    // offset into it. rowAlignment is what the rows are padded to, 1 for a tightly packed chain
+    // ------------------------------------------------------------------------
+    void upload(const unsigned char *levels, const MipChain &chain, int rowAlignment = 1)
+    {
+        GLenum format = pixelFormat(chain.channels);
+        glBindTexture(GL_TEXTURE_2D, ID);
+        // rows of 1 and 3 channel images are not 4-byte aligned, unless they were padded
+        glPixelStorei(GL_UNPACK_ALIGNMENT, rowAlignment);
+        for (size_t level = 0; level < chain.levels.size(); level++)
+        {
+            const MipLevel &mip = chain.levels[level];
+            glTexImage2D(GL_TEXTURE_2D, (GLint)level, format, mip.width, mip.height, 0, format, GL_UNSIGNED_BYTE, levels + mip.offset);
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        define(chain.levels, chain.channels);
+    }
+    // the same from block compressed levels (see includes/ktx2.h), which stay compressed in VRAM.
+    // the format has to be compressedSupported()
+    // ------------------------------------------------------------------------
+    void upload(const unsigned char *levels, BlockFormat format, const std::vector<MipLevel> &mips)
+    {
+        glBindTexture(GL_TEXTURE_2D, ID);
+        for (size_t level = 0; level < mips.size(); level++)
+        {
+            const MipLevel &mip = mips[level];
+            glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)level, compressedFormat(format), mip.width, mip.height, 0,
+                                   (GLsizei)mip.size, levels + mip.offset);
+        }
+        define(mips, BlockCodec::channels(format));
+    }
+    // the client format of 8-bit pixels with 1..4 channels
+    static GLenum pixelFormat(int channels)
+    {
+        if (channels == 1)
+            return GL_RED;
+        if (channels == 2)
+            return GL_RG;
+        if (channels == 3)
+            return GL_RGB;
+        return GL_RGBA;
+    }
+    // whether the GL can sample a block compressed format. BC4/5 (RGTC) are core since 3.0
+    // ------------------------------------------------------------------------
+    static bool compressedSupported(BlockFormat format)
+    {
+        switch (format)
+        {
+        case BLOCK_BC1:
+        case BLOCK_BC3:
+            return GLAD_GL_EXT_texture_compression_s3tc;
+        case BLOCK_BC7:
+            return GLAD_GL_VERSION_4_2 || GLAD_GL_ARB_texture_compression_bptc;
+        default:
+            return true;
+        }
+    }
+    // the internal format a compressed format uploads as. always the linear one: uncompressed textures
+    // are GL_RGB/GL_RGBA too, so an sRGB file renders the same either way
+    static GLenum compressedFormat(BlockFormat format)
+    {
+        switch (format)
+        {
+        case BLOCK_BC1:
+            return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        case BLOCK_BC3:
+            return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        case BLOCK_BC4:
+            return GL_COMPRESSED_RED_RGTC1;
+        case BLOCK_BC5:
+            return GL_COMPRESSED_RG_RGTC2;
+        default:
+            return GL_COMPRESSED_RGBA_BPTC_UNORM;
+        }
+    }
+
+private:
+    // the parameters and size of a texture whose levels were just uploaded
+    // ------------------------------------------------------------------------
+    void define(const std::vector<MipLevel> &levels, int levelChannels)
+    {
+        // a texture replaced by a smaller one keeps its old lower levels, they must not count
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)levels.size() - 1);
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, levels.size() > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+        width = levels[0].width;
+        height = levels[0].height;
+        channels = levelChannels;
+    }
+};
+
+// Decodes and uploads every image once. Textures are keyed on the canonical path of the file plus
+// the load options, so "../resources/a.png" and "../resources/./a.png" share one texture, and every
+// caller gets a shared reference to it. The cache only holds weak references: a texture is evicted
+// (glDeleteTextures) as soon as its last user releases it, and the next request loads it again.
+//
+// Textures are mipmapped on the CPU (includes/mip_chain.h), with trilinear filtering and GL_REPEAT wrapping. They are shared, so change
+// their parameters only if every user wants the change - or use a sampler object.
+//
+// A .ktx2 path loads a block compressed texture written by tools/texture_compress.cpp, mip chain and all.
+// It is uploaded compressed when the GL supports its format and decoded to RGBA8 when it doesn't. The
+// file was flipped (or not) and mipmapped when it was written, so the srgb option doesn't change it and a
+// file whose KTXorientation disagrees with the flip option is refused rather than shown upside down.
+// A .gltex path (includes/texture_file.h) is the same without any decoding: the file is mapped and the
+// levels are uploaded straight from the mapping. Its FLIPPED and SRGB flags must match the flip and srgb
+// options, a file written for other options is refused as well.
+class TextureCache
+{
+public:
+    // counters since the cache was created
+    struct Stats
+    {
+        unsigned int shared = 0; // requests answered with a resident texture
+        unsigned int loaded = 0; // requests that decoded and uploaded the file
+    };
+
+    // ------------------------------------------------------------------------
+    std::shared_ptr<Texture> load(const std::string &path, TextureOptions options = TextureOptions())
+    {
+        std::string key = keyFor(path, options);
+        std::weak_ptr<Texture> &entry = textures[key];
+        std::shared_ptr<Texture> texture = entry.lock();
+        if (texture)
+        {
+            counters.shared++;
+            return texture;
+        }
+        texture = std::make_shared<Texture>();
+        decodeAndUpload(*texture, path, options);
+        counters.loaded++;
+        if (texture->loaded())
+            entry = texture;
+        else
+            textures.erase(key); // a missing file is looked for again next time
+        prune();
+        return texture;
+    }
+    // how the mip chain of a texture loaded with options is filtered
+    // ------------------------------------------------------------------------
+    static MipOptions mipOptions(const TextureOptions &options)
+    {
+        MipOptions mips;
+        mips.srgb = options.srgb;
+        return mips;
+    }
+    // the texture for a file if it is resident (or being loaded by an AsyncTextureLoader), null otherwise
+    // ------------------------------------------------------------------------
+    std::shared_ptr<Texture> find(const std::string &path, TextureOptions options = TextureOptions())
+    {
+        auto found = textures.find(keyFor(path, options));
+        return found == textures.end() ? std::shared_ptr<Texture>() : found->second.lock();
+    }
+    // register a texture that is filled in elsewhere (AsyncTextureLoader) as the one every request for
+    // path and options gets from now on
+    // ------------------------------------------------------------------------
+    void insert(const std::string &path, TextureOptions options, const std::shared_ptr<Texture> &texture)
+    {
+        textures[keyFor(path, options)] = texture;
+        prune();
+    }
+    // textures currently resident
+    // ------------------------------------------------------------------------
+    size_t size()
+    {
+        prune();
+        return textures.size();
+    }
+    const Stats& stats() const
+    {
+        return counters;
+    }
+    // the cache key of a file loaded with options: its canonical path and the options
+    // ------------------------------------------------------------------------
+    static std::string keyFor(const std::string &path, const TextureOptions &options)
+    {
+        std::error_code error;
+        std::filesystem::path canonical = std::filesystem::weakly_canonical(path, error);
+        std::string name = error ? std::filesystem::path(path).lexically_normal().string() : canonical.string();
+        return name + (options.flip ? "|flip|" : "|") + std::to_string(options.channels) + (options.srgb ? "|srgb" : "|linear");
+    }
+    // whether a path names a block compressed KTX2 file rather than an image
+    // ------------------------------------------------------------------------
+    static bool compressed(const std::string &path)
+    {
+        std::string extension = std::filesystem::path(path).extension().string();
+        return extension == ".ktx2" || extension == ".KTX2";
+    }
+    // open a KTX2 file for a load with options. a compressed texture can't be flipped at load time, so a
+    // file whose rows are stored the other way round than options.flip asks for is refused
+    // ------------------------------------------------------------------------
+    static bool openCompressed(Ktx2File &file, const std::string &path, const TextureOptions &options)
+    {
+        if (!file.open(path))
+            return false;
+        if (file.bottomUp != options.flip)
+        {
+            std::cout << "ERROR::KTX2::ORIENTATION: " << path << " is stored " << (file.bottomUp ? "bottom" : "top")
+                      << " row first but is loaded " << (options.flip ? "with" : "without")
+                      << " flip, rewrite it with texture_compress" << (options.flip ? " --flip" : " without --flip") << std::endl;
+            return false;
+        }
+        return true;
+    }
+    // whether a path names a texture file (includes/texture_file.h)
+    // ------------------------------------------------------------------------
+    static bool packed(const std::string &path)
+    {
+        return std::filesystem::path(path).extension() == ".gltex";
+    }
+    // map a texture file for a load with options. its rows were flipped and its mips filtered when it was
+    // written, so a file whose FLIPPED or SRGB flag disagrees with options.flip or options.srgb is refused
+    // ------------------------------------------------------------------------
+    static bool openPacked(TextureFile &file, const std::string &path, const TextureOptions &options)
+    {
+        if (!file.open(path))
+            return false;
+        bool flipped = (file.flags & TextureFile::FLIPPED) != 0;
+        if (flipped != options.flip)
+        {
+            std::cout << "ERROR::TEXTURE_FILE::ORIENTATION: " << path << " is stored " << (flipped ? "bottom" : "top")
+                      << " row first but is loaded " << (options.flip ? "with" : "without")
+                      << " flip, rewrite it with texture_pack" << (options.flip ? " --flip" : " without --flip") << std::endl;
+            return false;
+        }
+        bool srgb = (file.flags & TextureFile::SRGB) != 0;
+        if (srgb != options.srgb)
+        {
+            std::cout << "ERROR::TEXTURE_FILE::COLOR_SPACE: " << path << " was mipmapped as " << (srgb ? "sRGB colors" : "linear data")
+                      << " but is loaded as " << (options.srgb ? "sRGB colors" : "linear data")
+                      << ", rewrite it with texture_pack" << (options.srgb ? " without --linear" : " --linear") << std::endl;
+            return false;
+        }
+        return true;
+    }
+    // the texture file (.gltex) or KTX2 file next to an image if one was made from it, else the image
+    // itself. the prepared file had the flip applied when it was written, not when it is loaded
+    // ------------------------------------------------------------------------
+    static std::string prepared(const std::string &path)
+    {
+        const char *extensions[] = { ".gltex", ".ktx2" };
+        for (const char *extension : extensions)
+        {
+            std::string candidate = std::filesystem::path(path).replace_extension(extension).string();
+            std::error_code error;
+            if (candidate != path && std::filesystem::exists(candidate, error))
+                return candidate;
+        }
+        return path;
+    }
+    // the RGBA8 levels compressed levels decode to when their format isn't supported
+    // ------------------------------------------------------------------------
+    static MipChain decodedChain(const std::vector<MipLevel> &compressedLevels)
+    {
+        MipChain chain;
+        chain.channels = 4;
+        for (const MipLevel &mip : compressedLevels)
+        {
+            size_t bytes = (size_t)mip.width * mip.height * 4;
+            chain.levels.push_back({ mip.width, mip.height, chain.size, bytes });
+            chain.size += bytes;
+        }
+        return chain;
+    }
+    // decode every level of blocks into out, laid out as decodedChain(levels)
+    // ------------------------------------------------------------------------
+    static void decodeLevels(BlockFormat format, const std::vector<MipLevel> &levels, const unsigned char *blocks, unsigned char *out)
+    {
+        MipChain chain = decodedChain(levels);
+        for (size_t level = 0; level < levels.size(); level++)
+        {
+            const MipLevel &mip = levels[level];
+            if (!BlockCodec::decodeImage(format, blocks + mip.offset, mip.width, mip.height, out + chain.levels[level].offset))
+                std::cout << "ERROR::TEXTURE_CACHE::BLOCK_DECODE: " << BlockCodec::name(format)
+                          << " blocks of a mode the decoder lacks, level " << level << std::endl;
+        }
+    }
+    // upload compressed levels, decoding them on this thread if the GL lacks their format
+    // ------------------------------------------------------------------------
+    static void uploadCompressed(Texture &texture, BlockFormat format, const std::vector<MipLevel> &levels, const unsigned char *blocks)
+    {
+        if (Texture::compressedSupported(format))
+        {
+            texture.upload(blocks, format, levels);
+            return;
+        }
+        MipChain chain = decodedChain(levels);
+        std::vector<unsigned char> decoded(chain.size);
+        decodeLevels(format, levels, blocks, decoded.data());
+        texture.upload(decoded.data(), chain);
+    }
+
+private:
+    std::unordered_map<std::string, std::weak_ptr<Texture>> textures;
+    Stats counters;
+
+    // ------------------------------------------------------------------------
+    static void decodeAndUpload(Texture &texture, const std::string &path, const TextureOptions &options)
+    {
+        if (compressed(path))
+        {
+            Ktx2File file;
+            std::vector<unsigned char> blocks;
+            if (openCompressed(file, path, options))
+            {
+                blocks.resize(file.size);
+                if (file.read(blocks.data()))
+                    uploadCompressed(texture, file.format, file.levels, blocks.data());
+            }
+            if (!texture.loaded())
+                std::cout << "Texture failed to load at path: " << path << std::endl;
+            return;
+        }
+        if (packed(path))
+        {
+            // the driver copies the texels out of the mapping, which is unmapped when file goes
+            TextureFile file;
+            if (openPacked(file, path, options))
+            {
+                if (file.compressed)
+                    uploadCompressed(texture, file.format, file.layout.levels, file.data());
+                else
+                    texture.upload(file.data(), file.layout, TextureFile::ROW_ALIGNMENT);
+            }
+            if (!texture.loaded())
+                std::cout << "Texture failed to load at path: " << path << std::endl;
+            return;
+        }
+        int width, height, nrComponents;
+        // the flip flag is set for this thread only, decoder threads (AsyncTextureLoader) set their own
+        stbi_set_flip_vertically_on_load_thread(options.flip);
+        unsigned char *data = stbi_load(path.c_str(), &width, &height, &nrComponents, options.channels);
+        if (!data)
+        {
+            std::cout << "Texture failed to load at path: " << path << std::endl;
+            return;
+        }
+        MipChain chain(width, height, options.channels ? options.channels : nrComponents);
+        std::vector<unsigned char> levels(chain.size);
+        chain.build(data, levels.data(), mipOptions(options));
+        stbi_image_free(data);
+        texture.upload(levels.data(), chain);
+    }
+    // drop the entries of textures nobody uses anymore
+    // ------------------------------------------------------------------------
+    void prune()
+    {
+        for (auto it = textures.begin(); it != textures.end();)
+        {
+            if (it->second.expired())
+                it = textures.erase(it);
+            else
+                ++it;
+        }
+    }
+};
+#endif
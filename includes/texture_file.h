@@ -0,0 +1,218 @@
+#ifndef TEXTURE_FILE_H
+#define TEXTURE_FILE_H
+
+#include <../includes/mapped_file.h>
+#include <../includes/mip_chain.h>
+#include <../includes/block_compression.h>
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+// The repository's own texture file (.gltex), written by tools/texture_pack.cpp: texels exactly as
+// glTexImage2D / glCompressedTexImage2D take them, so loading one is mapping it and uploading from the
+// mapping - no decoder, no flip, no mip filtering at startup.
+//
+// Layout, all numbers little endian:
+//   header      48 bytes: "GLTX", version, width, height, channels (1..4, 0 if compressed), block format + 1
+//               (0 if uncompressed), flags, level count, data offset (u64), data size (u64)
+//   level index 24 bytes per level, level 0 first: width, height, offset from the data offset (u64), size (u64)
+//   data        starts on a page boundary. uncompressed rows are padded to 4 bytes (GL's default unpack
+//               alignment), every level starts on a 16 byte boundary
+//
+// The image is stored bottom row first when the FLIPPED flag is set - what stbi_load with the flip
+// on gives - and its mip chain was filtered in linear light when SRGB is set.
+class TextureFile
+{
+public:
+    enum Flags
+    {
+        FLIPPED = 1,
+        SRGB = 2
+    };
+    static const std::uint32_t VERSION = 1;
+    static const int ROW_ALIGNMENT = 4;
+
+    int width = 0;
+    int height = 0;
+    bool compressed = false;
+    BlockFormat format = BLOCK_BC1; // when compressed
+    std::uint32_t flags = 0;
+    // the levels as Texture::upload takes them, offsets relative to data(). channels is 0 when compressed
+    MipChain layout;
+
+    // map a file and check its header, false if it is missing or not a texture file of this version
+    // ------------------------------------------------------------------------
+    bool open(const std::string &path)
+    {
+        if (!file.open(path))
+            return false;
+        const unsigned char *bytes = file.data();
+        if (file.size() < HEADER_SIZE || std::memcmp(bytes, MAGIC, 4) != 0 || word(bytes + 4) != VERSION)
+        {
+            std::cout << "ERROR::TEXTURE_FILE::NOT_A_TEXTURE_FILE: " << path << std::endl;
+            return false;
+        }
+        width = (int)word(bytes + 8);
+        height = (int)word(bytes + 12);
+        std::uint32_t channels = word(bytes + 16);
+        std::uint32_t block = word(bytes + 20);
+        flags = word(bytes + 24);
+        std::uint32_t levelCount = word(bytes + 28);
+        dataOffset = (size_t)longWord(bytes + 32);
+        std::uint64_t dataSize = longWord(bytes + 40);
+        compressed = block != 0;
+        format = compressed ? (BlockFormat)(block - 1) : BLOCK_BC1;
+        if (width <= 0 || height <= 0 || levelCount == 0 || levelCount > 32 || channels > 4 || block > BLOCK_BC7 + 1 ||
+            compressed == (channels != 0) || HEADER_SIZE + (size_t)levelCount * LEVEL_SIZE > file.size() ||
+            dataOffset > file.size() || dataSize > file.size() - dataOffset)
+        {
+            std::cout << "ERROR::TEXTURE_FILE::CORRUPT_HEADER: " << path << std::endl;
+            return false;
+        }
+        layout = MipChain();
+        layout.channels = (int)channels;
+        layout.size = (size_t)dataSize;
+        for (std::uint32_t level = 0; level < levelCount; level++)
+        {
+            const unsigned char *entry = bytes + HEADER_SIZE + level * LEVEL_SIZE;
+            MipLevel mip = { (int)word(entry), (int)word(entry + 4), (size_t)longWord(entry + 8), (size_t)longWord(entry + 16) };
+            if (mip.offset > layout.size || mip.size > layout.size - mip.offset || mip.size < levelBytes(mip.width, mip.height))
+            {
+                std::cout << "ERROR::TEXTURE_FILE::CORRUPT_LEVEL: " << path << " level " << level << std::endl;
+                return false;
+            }
+            layout.levels.push_back(mip);
+        }
+        return true;
+    }
+    // the texels, at layout's offsets. valid while the file is open
+    const unsigned char* data() const
+    {
+        return file.data() + dataOffset;
+    }
+    // unmap the file, once the texels are uploaded or copied
+    void close()
+    {
+        file.close();
+    }
+
+    // write uncompressed levels, tightly packed as chain lays them out (includes/mip_chain.h). rows are
+    // padded on the way
+    // ------------------------------------------------------------------------
+    static bool write(const std::string &path, const MipChain &chain, const unsigned char *levels, std::uint32_t flags)
+    {
+        std::vector<MipLevel> padded;
+        size_t size = 0;
+        for (const MipLevel &mip : chain.levels)
+        {
+            size_t stride = rowBytes(mip.width, chain.channels);
+            padded.push_back({ mip.width, mip.height, size, stride * mip.height });
+            size = align(size + stride * mip.height, LEVEL_ALIGNMENT);
+        }
+        std::vector<unsigned char> data(size, 0);
+        for (size_t level = 0; level < padded.size(); level++)
+        {
+            const MipLevel &mip = chain.levels[level];
+            size_t tight = (size_t)mip.width * chain.channels;
+            for (int y = 0; y < mip.height; y++)
+                std::memcpy(data.data() + padded[level].offset + y * rowBytes(mip.width, chain.channels),
+                            levels + mip.offset + y * tight, tight);
+        }
+        return writeFile(path, chain.channels, 0, flags, padded, data);
+    }
+    // write block compressed levels laid out as Ktx2File::layout() lays them out
+    // ------------------------------------------------------------------------
+    static bool write(const std::string &path, BlockFormat format, const std::vector<MipLevel> &levels,
+                      const unsigned char *blocks, std::uint32_t flags)
+    {
+        std::vector<MipLevel> aligned;
+        size_t size = 0;
+        for (const MipLevel &mip : levels)
+        {
+            aligned.push_back({ mip.width, mip.height, size, mip.size });
+            size = align(size + mip.size, LEVEL_ALIGNMENT);
+        }
+        std::vector<unsigned char> data(size, 0);
+        for (size_t level = 0; level < levels.size(); level++)
+            std::memcpy(data.data() + aligned[level].offset, blocks + levels[level].offset, levels[level].size);
+        return writeFile(path, 0, (std::uint32_t)format + 1, flags, aligned, data);
+    }
+    static size_t rowBytes(int width, int channels)
+    {
+        return align((size_t)width * channels, ROW_ALIGNMENT);
+    }
+
+private:
+    static constexpr char MAGIC[4] = { 'G', 'L', 'T', 'X' };
+    static const size_t HEADER_SIZE = 48;
+    static const size_t LEVEL_SIZE = 24;
+    static const size_t LEVEL_ALIGNMENT = 16;
+    static const size_t PAGE_SIZE = 4096;
+
+    MappedFile file;
+    size_t dataOffset = 0;
+
+    // ------------------------------------------------------------------------
+    static size_t align(size_t value, size_t alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+    static std::uint32_t word(const unsigned char *bytes)
+    {
+        return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((std::uint32_t)bytes[3] << 24);
+    }
+    static std::uint64_t longWord(const unsigned char *bytes)
+    {
+        return word(bytes) | ((std::uint64_t)word(bytes + 4) << 32);
+    }
+    static void put(std::vector<unsigned char> &out, std::uint64_t value, int bytes)
+    {
+        for (int i = 0; i < bytes; i++)
+            out.push_back((unsigned char)(value >> (8 * i)));
+    }
+    // the bytes a level needs at least, to reject files that would make GL read past the mapping
+    size_t levelBytes(int levelWidth, int levelHeight) const
+    {
+        if (compressed)
+            return BlockCodec::imageBytes(format, levelWidth, levelHeight);
+        return rowBytes(levelWidth, layout.channels) * levelHeight;
+    }
+    // ------------------------------------------------------------------------
+    static bool writeFile(const std::string &path, int channels, std::uint32_t block, std::uint32_t flags,
+                          const std::vector<MipLevel> &levels, const std::vector<unsigned char> &data)
+    {
+        size_t dataOffset = align(HEADER_SIZE + levels.size() * LEVEL_SIZE, PAGE_SIZE);
+        std::vector<unsigned char> out(MAGIC, MAGIC + 4);
+        put(out, VERSION, 4);
+        put(out, (std::uint32_t)levels[0].width, 4);
+        put(out, (std::uint32_t)levels[0].height, 4);
+        put(out, (std::uint32_t)channels, 4);
+        put(out, block, 4);
+        put(out, flags, 4);
+        put(out, levels.size(), 4);
+        put(out, dataOffset, 8);
+        put(out, data.size(), 8);
+        for (const MipLevel &mip : levels)
+        {
+            put(out, (std::uint32_t)mip.width, 4);
+            put(out, (std::uint32_t)mip.height, 4);
+            put(out, mip.offset, 8);
+            put(out, mip.size, 8);
+        }
+        out.resize(dataOffset, 0);
+        out.insert(out.end(), data.begin(), data.end());
+
+        std::ofstream stream(path, std::ios::binary);
+        if (!stream.write(reinterpret_cast<const char *>(out.data()), (std::streamsize)out.size()))
+        {
+            std::cout << "ERROR::TEXTURE_FILE::WRITE_FAILED: " << path << std::endl;
+            return false;
+        }
+        return true;
+    }
+};
+#endif
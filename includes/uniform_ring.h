@@ -0,0 +1,147 @@
+#ifndef UNIFORM_RING_H
+#define UNIFORM_RING_H
+
+#include <glad/glad.h>
+
+#include <cstring>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+// Per-draw uniform data (the Object block, ...) streamed through one persistently mapped buffer.
+// The buffer is split into one region per frame in flight. Every push() copies a block to the next
+// aligned offset of the current region and binds that range with glBindBufferRange, so a draw costs
+// a memcpy and a bind instead of a glUniform call per value. beginFrame() waits on the fence of the
+// region it is about to reuse, so data the GPU may still be reading is never overwritten.
+//
+// Without GL 4.4 / ARB_buffer_storage the ring falls back to a glBufferSubData per push.
+class UniformRing
+{
+public:
+    unsigned int ID;
+
+    // regionSize bytes of blocks per frame, for up to framesInFlight frames queued on the GPU
+    UniformRing(size_t regionSize = 256 * 1024, unsigned int framesInFlight = 3)
+        : framesInFlight(framesInFlight)
+    {
+        GLint offsetAlignment = 256;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &offsetAlignment);
+        alignment = offsetAlignment > 0 ? (size_t)offsetAlignment : 256;
+        this->regionSize = align(regionSize);
+
+        glGenBuffers(1, &ID);
+        glBindBuffer(GL_UNIFORM_BUFFER, ID);
+        GLsizeiptr size = (GLsizeiptr)(this->regionSize * framesInFlight);
+        if (GLAD_GL_VERSION_4_4 || GLAD_GL_ARB_buffer_storage)
+        {
+            // coherent: writes through the mapping are visible to the GPU without an explicit flush
+            GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glBufferStorage(GL_UNIFORM_BUFFER, size, NULL, flags);
+            mapped = static_cast<unsigned char *>(glMapBufferRange(GL_UNIFORM_BUFFER, 0, size, flags));
+            if (!mapped)
+                std::cout << "ERROR::UNIFORM_RING::MAP_FAILED" << std::endl;
+        }
+        else
+            glBufferData(GL_UNIFORM_BUFFER, size, NULL, GL_STREAM_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        fences.assign(framesInFlight, 0);
+    }
+    ~UniformRing()
+    {
+        for (GLsync fence : fences)
+            if (fence)
+                glDeleteSync(fence);
+        if (mapped)
+        {
+            glBindBuffer(GL_UNIFORM_BUFFER, ID);
+            glUnmapBuffer(GL_UNIFORM_BUFFER);
+            glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        }
+        glDeleteBuffers(1, &ID);
+    }
+    UniformRing(const UniformRing&) = delete;
+    UniformRing& operator=(const UniformRing&) = delete;
+
+    // move on to the next region, waiting until the GPU is done with what was written there
+    // framesInFlight frames ago
+    // ------------------------------------------------------------------------
+    void beginFrame()
+    {
+        region = (region + 1) % framesInFlight;
+        offset = 0;
+        GLsync &fence = fences[region];
+        if (!fence)
+            return;
+        GLenum status = glClientWaitSync(fence, 0, 0);
+        if (status == GL_TIMEOUT_EXPIRED)
+        {
+            stalls++;
+            while (status == GL_TIMEOUT_EXPIRED)
+                status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000); // 1 ms
+        }
+        glDeleteSync(fence);
+        fence = 0;
+    }
+    // fence the region once every draw reading from it has been issued
+    // ------------------------------------------------------------------------
+    void endFrame()
+    {
+        if (fences[region])
+            glDeleteSync(fences[region]);
+        fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+    // copy one block into the ring and bind it to a uniform block binding point for the next draw.
+    // T must have the block's std140 layout (see includes/shader_uniforms_data.h)
+    // ------------------------------------------------------------------------
+    template <typename T>
+    bool push(GLuint binding, const T &block)
+    {
+        if (offset + sizeof(T) > regionSize)
+        {
+            std::cout << "ERROR::UNIFORM_RING::REGION_FULL: " << regionSize << " bytes per frame" << std::endl;
+            return false;
+        }
+        size_t at = region * regionSize + offset;
+        if (mapped)
+            std::memcpy(mapped + at, &block, sizeof(T));
+        else
+        {
+            glBindBuffer(GL_UNIFORM_BUFFER, ID);
+            glBufferSubData(GL_UNIFORM_BUFFER, (GLintptr)at, sizeof(T), &block);
+        }
+        glBindBufferRange(GL_UNIFORM_BUFFER, binding, ID, (GLintptr)at, sizeof(T));
+        offset = align(offset + sizeof(T));
+        return true;
+    }
+    // bytes written to the current region so far
+    size_t used() const
+    {
+        return offset;
+    }
+    // how often beginFrame() had to wait for the GPU
+    unsigned int stallCount() const
+    {
+        return stalls;
+    }
+    bool persistent() const
+    {
+        return mapped != nullptr;
+    }
+
+private:
+    unsigned int framesInFlight;
+    size_t alignment;
+    size_t regionSize;
+    unsigned char *mapped = nullptr;
+    std::vector<GLsync> fences;
+    unsigned int region = 0;
+    size_t offset = 0;
+    unsigned int stalls = 0;
+
+    // ------------------------------------------------------------------------
+    size_t align(size_t value) const
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+};
+#endif
@@ -0,0 +1,21 @@
+#ifndef UNIFORM_STRUCT_H
+#define UNIFORM_STRUCT_H
+
+#include <glad/glad.h>
+
+#include <cstddef>
+
+// One uniform of a generated uniform struct: the name glGetActiveUniform reports, its GLSL type
+// and where its value sits in the C++ struct.
+struct UniformField
+{
+    const char *name;
+    GLenum type;
+    size_t offset;
+};
+
+// specialized for every struct in includes/shader_uniforms_data.h (generated by tools/uniform_structs.cpp)
+// with a static constexpr UniformField fields[] array
+template<typename T>
+struct UniformStruct;
+#endif
@@ -0,0 +1,26 @@
+#version 430 core
+// The procedural animation of includes/procedural_animation.h evaluated by a compute program: one
+// invocation per instance writes its model matrix for the given time. Reads the instance buffer of
+// ProceduralAnimation as it is, see tools/compute_check.cpp.
+#include "common/spin.glsl"
+
+layout (local_size_x = 64) in;
+
+// two vec4s per instance, AnimatedInstance
+layout (std430, binding = 0) readonly buffer Instances {
+    vec4 instances[];
+};
+layout (std430, binding = 1) writeonly buffer Models {
+    mat4 models[];
+};
+
+uniform float time;
+uniform uint count;
+
+void main()
+{
+    uint i = gl_GlobalInvocationID.x;
+    if (i >= count)
+        return;
+    models[i] = spinModel(instances[2u * i], instances[2u * i + 1u], time);
+}
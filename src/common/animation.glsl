@@ -0,0 +1,16 @@
+// Procedural animation: every instance spins about its own axis at its own speed, driven by a
+// single time uniform. The per-instance parameters come from the instance buffer of
+// ProceduralAnimation (includes/procedural_animation.h); the matrix itself is spinModel(), which
+// ProceduralAnimation::modelMatrix() mirrors on the CPU to validate it.
+
+#include "spin.glsl"
+
+layout (location = 2) in vec4 aInstancePosition; // xyz world position, w angular speed in degrees per second
+layout (location = 3) in vec4 aInstanceAxis;     // xyz normalized rotation axis, w start angle in degrees
+
+uniform float time;
+
+mat4 animatedModel()
+{
+    return spinModel(aInstancePosition, aInstanceAxis, time);
+}
@@ -0,0 +1,8 @@
+// Per-frame camera data, uploaded once per frame by CameraBuffer (includes/camera_buffer.h)
+// and shared by every program through uniform block binding point 0.
+
+layout (std140) uniform Camera {
+    mat4 projection;
+    mat4 view;
+    vec3 viewPos;
+};
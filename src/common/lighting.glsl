@@ -0,0 +1,147 @@
+// Phong lighting shared by the lit shaders. Feature bits (defined by the C++ side):
+//  DIFFUSE_MAP     - diffuse/ambient color comes from material.diffuse as a texture
+//  SPECULAR_MAP    - specular intensity comes from material.specular as a texture
+//  LAMBERT_ONLY    - shading LOD: no specular term at all
+//  VERTEX_LIGHTING - shading LOD: the light terms are computed per vertex (see phong.vs)
+//  TEXTURE_ARRAY   - the maps are layers of array textures (includes/texture_array.h): each map has
+//                    the layer and the uv rectangle of its image in the layer next to its sampler
+//  MATERIAL_BLOCK  - with TEXTURE_ARRAY: the layers and rectangles are per-object data read from the
+//                    MaterialParameters block, a range of the per-frame uniform ring bound at binding
+//                    point 2, and Material keeps only the samplers and the shininess
+// Without the map bits the material colors are plain vec3 uniforms.
+// A specialized program (Shader::enableSpecialization) defines FOLDED_material_shininess once the
+// shininess has kept its value, so pow() gets a constant exponent: Material holds samplers and can't
+// be folded as a whole. MATERIAL_SHININESS is the one to use.
+
+#ifdef FOLDED_material_shininess
+#define MATERIAL_SHININESS FOLDED_material_shininess
+#else
+#define MATERIAL_SHININESS material.shininess
+#endif
+
+struct Material {
+#ifdef DIFFUSE_MAP
+#ifdef TEXTURE_ARRAY
+    sampler2DArray diffuse;
+#ifndef MATERIAL_BLOCK
+    vec4 diffuseRect;
+    float diffuseLayer;
+#endif
+#else
+    sampler2D diffuse;
+#endif
+#else
+    vec3 ambient;
+    vec3 diffuse;
+#endif
+#ifdef SPECULAR_MAP
+#ifdef TEXTURE_ARRAY
+    sampler2DArray specular;
+#ifndef MATERIAL_BLOCK
+    vec4 specularRect;
+    float specularLayer;
+#endif
+#else
+    sampler2D specular;
+#endif
+#else
+    vec3 specular;
+#endif
+    float shininess;
+};
+
+#ifdef MATERIAL_BLOCK
+layout (std140) uniform MaterialParameters {
+    vec4 diffuseRect;
+    vec4 specularRect;
+    float diffuseLayer;
+    float specularLayer;
+} materialParameters;
+#define MATERIAL_DIFFUSE_RECT materialParameters.diffuseRect
+#define MATERIAL_DIFFUSE_LAYER materialParameters.diffuseLayer
+#define MATERIAL_SPECULAR_RECT materialParameters.specularRect
+#define MATERIAL_SPECULAR_LAYER materialParameters.specularLayer
+#else
+#define MATERIAL_DIFFUSE_RECT material.diffuseRect
+#define MATERIAL_DIFFUSE_LAYER material.diffuseLayer
+#define MATERIAL_SPECULAR_RECT material.specularRect
+#define MATERIAL_SPECULAR_LAYER material.specularLayer
+#endif
+
+struct Light {
+    vec3 position;
+
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+
+// light arriving at a point, before the material's colors are applied
+struct LightTerms {
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+
+LightTerms lightTerms(Light light, float shininess, vec3 normal, vec3 fragPos, vec3 viewPos)
+{
+    LightTerms terms;
+    // ambient
+    terms.ambient = light.ambient;
+
+    // diffuse
+    vec3 norm = normalize(normal);
+    vec3 lightDir = normalize(light.position - fragPos);
+    float diff = max(dot(norm, lightDir), 0.0);
+    terms.diffuse = light.diffuse * diff;
+
+    // specular
+#ifdef LAMBERT_ONLY
+    terms.specular = vec3(0.0);
+#else
+    vec3 viewDir = normalize(viewPos - fragPos);
+    vec3 reflectDir = reflect(-lightDir, norm);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
+    terms.specular = light.specular * spec;
+#endif
+    return terms;
+}
+
+#ifdef TEXTURE_ARRAY
+// rect is the uv offset (xy) and scale (zw) of the image within its layer
+vec4 sampleMap(sampler2DArray map, vec4 rect, float layer, vec2 texCoords)
+{
+    return texture(map, vec3(rect.xy + texCoords * rect.zw, layer));
+}
+#endif
+
+vec3 shade(Material material, LightTerms terms, vec2 texCoords)
+{
+#if defined(DIFFUSE_MAP) && defined(TEXTURE_ARRAY)
+    vec3 ambientColor = sampleMap(material.diffuse, MATERIAL_DIFFUSE_RECT, MATERIAL_DIFFUSE_LAYER, texCoords).rgb;
+    vec3 diffuseColor = ambientColor;
+#elif defined(DIFFUSE_MAP)
+    vec3 ambientColor = texture(material.diffuse, texCoords).rgb;
+    vec3 diffuseColor = ambientColor;
+#else
+    vec3 ambientColor = material.ambient;
+    vec3 diffuseColor = material.diffuse;
+#endif
+    vec3 result = terms.ambient * ambientColor + terms.diffuse * diffuseColor;
+#ifndef LAMBERT_ONLY
+#if defined(SPECULAR_MAP) && defined(TEXTURE_ARRAY)
+    vec3 specularColor = sampleMap(material.specular, MATERIAL_SPECULAR_RECT, MATERIAL_SPECULAR_LAYER, texCoords).rgb;
+#elif defined(SPECULAR_MAP)
+    vec3 specularColor = texture(material.specular, texCoords).rgb;
+#else
+    vec3 specularColor = material.specular;
+#endif
+    result += terms.specular * specularColor;
+#endif
+    return result;
+}
+
+vec3 phong(Material material, Light light, vec3 normal, vec3 fragPos, vec3 viewPos, vec2 texCoords)
+{
+    return shade(material, lightTerms(light, MATERIAL_SHININESS, normal, fragPos, viewPos), texCoords);
+}
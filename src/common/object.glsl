@@ -0,0 +1,10 @@
+// Per-object data. With OBJECT_BLOCK defined it is read from a range of the per-frame uniform ring
+// (includes/uniform_ring.h) bound at binding point 1, otherwise it is a plain uniform.
+
+#ifdef OBJECT_BLOCK
+layout (std140) uniform Object {
+    mat4 model;
+};
+#else
+uniform mat4 model;
+#endif
@@ -0,0 +1,21 @@
+// translate(position) * rotate(angle, axis) of one procedurally animated instance, the same matrix
+// glm::translate + glm::rotate build. positionSpeed is the xyz world position and the angular speed in
+// degrees per second, axisStart the normalized rotation axis and the start angle in degrees: the
+// AnimatedInstance layout of includes/procedural_animation.h. Shared by the vertex path
+// (animation.glsl) and the compute path (animate_instances.cs), it must stay in step with
+// ProceduralAnimation::modelMatrix().
+
+mat4 spinModel(vec4 positionSpeed, vec4 axisStart, float time)
+{
+    // wrapped to one turn so sin/cos stay accurate however long the program runs
+    float angle = radians(mod(positionSpeed.w * time + axisStart.w, 360.0));
+    float c = cos(angle);
+    float s = sin(angle);
+    vec3 axis = axisStart.xyz;
+    vec3 t = (1.0 - c) * axis;
+    return mat4(
+        vec4(c + t.x * axis.x,          t.x * axis.y + s * axis.z, t.x * axis.z - s * axis.y, 0.0),
+        vec4(t.y * axis.x - s * axis.z, c + t.y * axis.y,          t.y * axis.z + s * axis.x, 0.0),
+        vec4(t.z * axis.x + s * axis.y, t.z * axis.y - s * axis.x, c + t.z * axis.z,          0.0),
+        vec4(positionSpeed.xyz, 1.0));
+}
@@ -0,0 +1,24 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoord;
+
+// texture samplers: layers of array textures (includes/texture_array.h), each image at its own layer
+// and uv rectangle (offset xy, scale zw) within it
+uniform sampler2DArray texture1;
+uniform sampler2DArray texture2;
+uniform vec4 texture1Rect;
+uniform vec4 texture2Rect;
+uniform float texture1Layer;
+uniform float texture2Layer;
+
+vec4 sampleRegion(sampler2DArray textures, vec4 rect, float layer)
+{
+	return texture(textures, vec3(rect.xy + TexCoord * rect.zw, layer));
+}
+
+void main()
+{
+	// linearly interpolate between both textures (80% container, 20% awesomeface)
+	FragColor = mix(sampleRegion(texture1, texture1Rect, texture1Layer), sampleRegion(texture2, texture2Rect, texture2Layer), 0.2);
+}
\ No newline at end of file
@@ -0,0 +1,22 @@
+#version 330 core
+#include "common/camera.glsl"
+#ifdef PROCEDURAL_ANIMATION
+#include "common/animation.glsl"
+#else
+#define OBJECT_BLOCK
+#include "common/object.glsl"
+#endif
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoord;
+
+out vec2 TexCoord;
+
+void main()
+{
+#ifdef PROCEDURAL_ANIMATION
+	mat4 model = animatedModel();
+#endif
+	gl_Position = projection * view * model * vec4(aPos, 1.0);
+	TexCoord = vec2(aTexCoord.x, aTexCoord.y);
+}
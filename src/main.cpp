@@ -14,20 +14,27 @@
 #include <../includes/glm/glm/gtc/type_ptr.hpp>
 #include <../includes/MyError.h>
 #include <../includes/camera.h>
+#include <../includes/camera_buffer.h>
+#include <../includes/uniform_ring.h>
+#include <../includes/shader_uniforms_data.h>
+#include <../includes/procedural_animation.h>
+#include <../includes/texture_cache.h>
+#include <../includes/texture_array.h>
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void processInput(GLFWwindow *window);
-void createTexture(const char* imgPath, unsigned int &textureID, bool should_flip);
 void createGPUComponents(unsigned int &VBO, unsigned int &VAO, unsigned int &EBO,
                          const std::vector<float> &vertices, const std::vector<unsigned int> &indices);
-void renderLoop(GLFWwindow *window, Shader ourShader, unsigned int &texture1,
-                unsigned int &texture2, unsigned int &VAO, const glm::vec3 (&cubePositions) [10]);
+void renderLoop(GLFWwindow *window, Shader &ourShader, Shader &animatedShader, unsigned int &VAO,
+                const ProceduralAnimation &cubes);
+void useRegions(Shader &shader, const TextureRegion &texture1, const TextureRegion &texture2);
 
 GLFWwindow* createWindow(int width, int height);
 void checkForWindowError(GLFWwindow *window);
 void mouse_callback(GLFWwindow* window, double xposIn, double yposIn);
 void configureMouse(GLFWwindow *window);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
 
 // settings
 const unsigned int SCR_WIDTH = 800;
@@ -42,6 +49,9 @@ bool firstMouse = true;
 float deltaTime = 0.0f;
 float lastFrame = 0.0f;
 
+// C switches the cubes to the CPU-built matrices, to check the shader animation against them
+bool animateOnCpu = false;
+
 int main()
 {
     GLFWwindow* window = createWindow(800, 600);
@@ -57,99 +67,119 @@ int main()
 
     glEnable(GL_DEPTH_TEST);
 
-    Shader ourShader("../src/shader_10.vs", "../src/shader_10.fs");
-
-    std::vector<float> vertices = {
-            // Positions        // Texture Coords
-            -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
-            0.5f, -0.5f, -0.5f,  1.0f, 0.0f,
-            0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-            0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-            -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
-            -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
-
-            -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-            0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
-            0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
-            0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
-            -0.5f,  0.5f,  0.5f,  0.0f, 1.0f,
-            -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-
-            -0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-            -0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-            -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-            -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-            -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-            -0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-
-            0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-            0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-            0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-            0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-            0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-            0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-
-            -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-            0.5f, -0.5f, -0.5f,  1.0f, 1.0f,
-            0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
-            0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
-            -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
-            -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
-
-            -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
-            0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
-            0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-            0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-            -0.5f,  0.5f,  0.5f,  0.0f, 0.0f,
-            -0.5f,  0.5f, -0.5f,  0.0f, 1.0f
-    };
-
-    // world space positions of our cubes
-    glm::vec3 cubePositions[] = {
-            glm::vec3( 0.0f,  0.0f,  0.0f),
-            glm::vec3( 2.0f,  5.0f, -15.0f),
-            glm::vec3(-1.5f, -2.2f, -2.5f),
-            glm::vec3(-3.8f, -2.0f, -12.3f),
-            glm::vec3( 2.4f, -0.4f, -3.5f),
-            glm::vec3(-1.7f,  3.0f, -7.5f),
-            glm::vec3( 1.3f, -2.0f, -2.5f),
-            glm::vec3( 1.5f,  2.0f, -2.5f),
-            glm::vec3( 1.5f,  0.2f, -1.5f),
-            glm::vec3(-1.3f,  1.0f, -1.5f)
-    };
-
-    std::vector<unsigned int> indices = { 0, 1, 3, 1, 2, 3 };
-
-    unsigned int VBO, VAO, EBO;
-    createGPUComponents(VBO, VAO, EBO, vertices, indices);
-
-    // load and create a texture
-    // -------------------------
-    unsigned int texture1, texture2;
-
-    createTexture("../resources/container.jpg", texture1, true);
-    createTexture("../resources/awesomeface.png", texture2, false);
-
-
-    // tell opengl for each sampler to which texture unit it belongs to (only has to be done once)
-    // -------------------------------------------------------------------------------------------
-    ourShader.use();
-    ourShader.setInt("texture1", 0);
-    ourShader.setInt("texture2", 1);
-
-
-    // render loop
-    // -----------
-    renderLoop(window, ourShader, texture1, texture2, VAO, cubePositions);
-
-    // optional: de-allocate all resources once they've outlived their purpose:
-    // ------------------------------------------------------------------------
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
-    glDeleteBuffers(1, &EBO);
-
-    glDeleteTextures(1, &texture1);
-    glDeleteTextures(1, &texture2);
+    // the programs, the animation's instance buffer and the texture arrays are deleted when this block
+    // closes, while the context still exists
+    {
+        Shader ourShader(SHADER_CUBES_VS, SHADER_CUBES_FS);
+        Shader animatedShader(SHADER_CUBES_VS, SHADER_CUBES_FS, { "PROCEDURAL_ANIMATION" });
+
+        std::vector<float> vertices = {
+                // Positions        // Texture Coords
+                -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
+                0.5f, -0.5f, -0.5f,  1.0f, 0.0f,
+                0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+                0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+                -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
+                -0.5f, -0.5f, -0.5f,  0.0f, 0.0f,
+
+                -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+                0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+                0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
+                0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
+                -0.5f,  0.5f,  0.5f,  0.0f, 1.0f,
+                -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+
+                -0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+                -0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+                -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+                -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+                -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+                -0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+
+                0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+                0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+                0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+                0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+                0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+                0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+
+                -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+                0.5f, -0.5f, -0.5f,  1.0f, 1.0f,
+                0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+                0.5f, -0.5f,  0.5f,  1.0f, 0.0f,
+                -0.5f, -0.5f,  0.5f,  0.0f, 0.0f,
+                -0.5f, -0.5f, -0.5f,  0.0f, 1.0f,
+
+                -0.5f,  0.5f, -0.5f,  0.0f, 1.0f,
+                0.5f,  0.5f, -0.5f,  1.0f, 1.0f,
+                0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+                0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
+                -0.5f,  0.5f,  0.5f,  0.0f, 0.0f,
+                -0.5f,  0.5f, -0.5f,  0.0f, 1.0f
+        };
+
+        // world space positions of our cubes
+        glm::vec3 cubePositions[] = {
+                glm::vec3( 0.0f,  0.0f,  0.0f),
+                glm::vec3( 2.0f,  5.0f, -15.0f),
+                glm::vec3(-1.5f, -2.2f, -2.5f),
+                glm::vec3(-3.8f, -2.0f, -12.3f),
+                glm::vec3( 2.4f, -0.4f, -3.5f),
+                glm::vec3(-1.7f,  3.0f, -7.5f),
+                glm::vec3( 1.3f, -2.0f, -2.5f),
+                glm::vec3( 1.5f,  2.0f, -2.5f),
+                glm::vec3( 1.5f,  0.2f, -1.5f),
+                glm::vec3(-1.3f,  1.0f, -1.5f)
+        };
+
+        std::vector<unsigned int> indices = { 0, 1, 3, 1, 2, 3 };
+
+        unsigned int VBO, VAO, EBO;
+        createGPUComponents(VBO, VAO, EBO, vertices, indices);
+
+        // every cube spins about the same axis at 20 degrees per second, animated in the vertex shader
+        std::vector<AnimatedInstance> instances;
+        for (const glm::vec3 &position : cubePositions)
+            instances.push_back({ position, 20.0f, glm::vec3(1.0f, 0.3f, 0.5f), 0.0f });
+        ProceduralAnimation cubes;
+        cubes.setInstances(instances);
+        cubes.attach(VAO);
+        // the CPU path (C key) is the reference for the shader, so check its matrices against glm's first
+        for (float time : { 0.0f, 1.3f, 17.0f, 1000.5f })
+            if (cubes.modelMatrixError(time) > 1e-3f)
+                std::cout << "ERROR::PROCEDURAL_ANIMATION::MODEL_MATRIX: differs from glm::rotate at t=" << time << std::endl;
+
+        // load and create a texture - decoded and uploaded once, however many materials ask for it
+        // -------------------------
+        // both images are 512x512, so they become two layers of one RGBA8 array texture: bound once below,
+        // the shaders pick the layers by index
+        TextureArrays textures(2);
+        TextureOptions flipped;
+        flipped.flip = true; // tell stb_image.h to flip loaded texture's on the y-axis.
+        // a container.gltex made with texture_pack --flip is mapped and uploaded instead, without decoding
+        TextureRegion container = textures.load(TextureCache::prepared("../resources/container.jpg"), flipped);
+        TextureRegion face = textures.load(TextureCache::prepared("../resources/awesomeface.png"));
+
+
+        // tell opengl for each sampler to which texture unit it belongs to, and where its image is (only has
+        // to be done once)
+        // -------------------------------------------------------------------------------------------
+        useRegions(ourShader, container, face);
+        useRegions(animatedShader, container, face);
+        TextureArrays::bind(container, 0);
+        TextureArrays::bind(face, 1);
+
+
+        // render loop
+        // -----------
+        renderLoop(window, ourShader, animatedShader, VAO, cubes);
+
+        // optional: de-allocate all resources once they've outlived their purpose:
+        // ------------------------------------------------------------------------
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteBuffers(1, &EBO);
+    }
 
     // glfw: terminate, clearing all previously allocated GLFW resources.
     // ------------------------------------------------------------------
@@ -186,6 +216,7 @@ void configureMouse(GLFWwindow *window) {
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
     glfwSetCursorPosCallback(window, mouse_callback);
     glfwSetScrollCallback(window, scroll_callback);
+    glfwSetKeyCallback(window, key_callback);
 }
 
 GLFWwindow* createWindow(int width, int height) {
@@ -199,30 +230,6 @@ GLFWwindow* createWindow(int width, int height) {
     return glfwCreateWindow(width, height, "LearnOpenGL", NULL, NULL);
 }
 
-void createTexture(const char* imgPath, unsigned int &textureID, bool should_flip) {
-    glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    // set the texture wrapping parameters
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    // set texture filtering parameters
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    // load image, create texture and generate mipmaps
-    int width, height, nrChannels;
-    stbi_set_flip_vertically_on_load(should_flip); // tell stb_image.h to flip loaded texture's on the y-axis.
-    unsigned char *data = stbi_load(imgPath, &width, &height, &nrChannels, 0);
-    if (data) {
-        GLenum format = (nrChannels == 4) ? GL_RGBA : GL_RGB;  // Use correct format
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-    } else {
-        std::cout << "Failed to load texture" << std::endl;
-    }
-
-    stbi_image_free(data);
-}
-
 void createGPUComponents(unsigned int &VBO, unsigned int &VAO, unsigned int &EBO,
                          const std::vector<float> &vertices, const std::vector<unsigned int> &indices) {
 
@@ -246,10 +253,30 @@ void createGPUComponents(unsigned int &VBO, unsigned int &VAO, unsigned int &EBO
     glEnableVertexAttribArray(1);
 }
 
-void renderLoop(GLFWwindow *window, Shader ourShader,
-                unsigned int &texture1, unsigned int &texture2,
-                unsigned int &VAO, const glm::vec3 (&cubePositions)[10])
+// the layer and rectangle of each sampler's image, texture1 on unit 0 and texture2 on unit 1
+// ------------------------------------------------------------------------
+void useRegions(Shader &shader, const TextureRegion &texture1, const TextureRegion &texture2)
+{
+    shader.use();
+    shader.setInt("texture1", 0);
+    shader.setInt("texture2", 1);
+    shader.setVec4("texture1Rect", texture1.rect);
+    shader.setVec4("texture2Rect", texture2.rect);
+    shader.setFloat("texture1Layer", texture1.layer);
+    shader.setFloat("texture2Layer", texture2.layer);
+}
+
+void renderLoop(GLFWwindow *window, Shader &ourShader, Shader &animatedShader,
+                unsigned int &VAO, const ProceduralAnimation &cubes)
 {
+    // camera matrices, filled once per frame
+    CameraBuffer cameraBuffer;
+
+    // per-cube model matrices of the CPU path, written into a persistently mapped buffer and bound per draw
+    UniformRing objectRing;
+    // the animated program's only per-frame uniform
+    Uniform<float> animationTime = animatedShader.uniform<float>("time");
+
     while (!glfwWindowShouldClose(window))
     {
         // per-frame time logic
@@ -262,46 +289,34 @@ void renderLoop(GLFWwindow *window, Shader ourShader,
         // -----
         processInput(window);
 
+        // reuse the oldest ring region, waiting only if the GPU is still reading it
+        objectRing.beginFrame();
+
         // render
         // ------
         glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); // also clear the depth buffer now!
 
 
-        // bind textures on corresponding texture units
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, texture1);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, texture2);
-
-        // activate shader
-        ourShader.use();
-
-
-        glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
-        unsigned int projectionLoc  = glGetUniformLocation(ourShader.ID, "projection");
-        glUniformMatrix4fv(projectionLoc, 1, GL_FALSE, glm::value_ptr(projection));
-
-
-        // camera/view transformation
-        glm::mat4 view = camera.GetViewMatrix();
-        unsigned int viewLoc  = glGetUniformLocation(ourShader.ID, "view");
-        glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
+        // camera/view and projection transformations, uploaded once into the shared Camera block
+        cameraBuffer.update(camera, (float)SCR_WIDTH / (float)SCR_HEIGHT);
 
-        // render boxes
+        // render boxes: one instanced draw, the rotation is computed per vertex from the time
         glBindVertexArray(VAO);
-        for (unsigned int i = 0; i < 10; i++)
+        if (animateOnCpu)
         {
-            // calculate the model matrix for each object and pass it to shader before drawing
-            glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model, cubePositions[i]);
-            float angle = 20.0f * (float)glfwGetTime();
-            model = glm::rotate(model, glm::radians(angle), glm::vec3(1.0f, 0.3f, 0.5f));
-            unsigned int modelLoc = glGetUniformLocation(ourShader.ID, "model");
-            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-
-            glDrawArrays(GL_TRIANGLES, 0, 36);
+            ourShader.use();
+            cubes.drawOnCpu(objectRing, currentFrame, GL_TRIANGLES, 36);
         }
+        else
+        {
+            animatedShader.use();
+            cubes.draw(animatedShader, animationTime, currentFrame, GL_TRIANGLES, 36);
+        }
+        objectRing.endFrame();
+        // roll over the per-frame upload counters of both programs
+        ourShader.endFrame();
+        animatedShader.endFrame();
 
 
         // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
@@ -347,6 +362,12 @@ void mouse_callback(GLFWwindow* window, double xposIn, double yposIn) {
     camera.ProcessMouseMovement(xoffset, yoffset);
 }
 
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+    if (key == GLFW_KEY_C && action == GLFW_PRESS)
+        animateOnCpu = !animateOnCpu;
+}
+
 // glfw: whenever the mouse scroll wheel scrolls, this callback is called
 // ----------------------------------------------------------------------
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
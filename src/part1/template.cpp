@@ -19,7 +19,7 @@ void processInput(GLFWwindow *window);
 void createTexture(const char* imgPath, unsigned int &textureID, bool should_flip);
 void createGPUComponents(unsigned int &VBO, unsigned int &VAO, unsigned int &EBO,
                          const std::vector<float> &vertices, const std::vector<unsigned int> &indices);
-void renderLoop(GLFWwindow *window, Shader ourShader, unsigned int &texture1, unsigned int &texture2, unsigned int &VAO);
+void renderLoop(GLFWwindow *window, Shader &ourShader, unsigned int &texture1, unsigned int &texture2, unsigned int &VAO);
 
 GLFWwindow* createWindow(int width, int height);
 void checkForWindowError(GLFWwindow *window);
@@ -35,47 +35,50 @@ int main()
         return -1;
     }
 
-    Shader ourShader("../src/shader.vs", "../src/shader.fs");
+    // the shader deletes its program when this block closes, while the context still exists
+    {
+        Shader ourShader("../src/shader.vs", "../src/shader.fs");
 
-    std::vector<float> vertices = {
-            // Positions        // Texture Coords
-            0.5f,  0.5f, 0.0f,  1.0f, 1.0f, // top right 0
-            0.5f, -0.5f, 0.0f,  1.0f, 0.0f, // bottom right 1
-            -0.5f, -0.5f, 0.0f,  0.0f, 0.0f, // bottom left 2
-            -0.5f,  0.5f, 0.0f,  0.0f, 1.0f // top left 3
-    };
+        std::vector<float> vertices = {
+                // Positions        // Texture Coords
+                0.5f,  0.5f, 0.0f,  1.0f, 1.0f, // top right 0
+                0.5f, -0.5f, 0.0f,  1.0f, 0.0f, // bottom right 1
+                -0.5f, -0.5f, 0.0f,  0.0f, 0.0f, // bottom left 2
+                -0.5f,  0.5f, 0.0f,  0.0f, 1.0f // top left 3
+        };
 
-    std::vector<unsigned int> indices = { 0, 1, 3, 1, 2, 3 };
+        std::vector<unsigned int> indices = { 0, 1, 3, 1, 2, 3 };
 
-    unsigned int VBO, VAO, EBO;
-    createGPUComponents(VBO, VAO, EBO, vertices, indices);
+        unsigned int VBO, VAO, EBO;
+        createGPUComponents(VBO, VAO, EBO, vertices, indices);
 
-    // load and create a texture
-    // -------------------------
-    unsigned int texture1, texture2;
+        // load and create a texture
+        // -------------------------
+        unsigned int texture1, texture2;
 
-    createTexture("../resources/container.jpg", texture1, true);
-    createTexture("../resources/awesomeface.png", texture2, false);
+        createTexture("../resources/container.jpg", texture1, true);
+        createTexture("../resources/awesomeface.png", texture2, false);
 
 
-    // tell opengl for each sampler to which texture unit it belongs to (only has to be done once)
-    // -------------------------------------------------------------------------------------------
-    ourShader.use();
-    ourShader.setInt("texture1", 0);
-    ourShader.setInt("texture2", 1);
+        // tell opengl for each sampler to which texture unit it belongs to (only has to be done once)
+        // -------------------------------------------------------------------------------------------
+        ourShader.use();
+        ourShader.setInt("texture1", 0);
+        ourShader.setInt("texture2", 1);
 
-    // render loop
-    // -----------
-    renderLoop(window, ourShader, texture1, texture2, VAO);
+        // render loop
+        // -----------
+        renderLoop(window, ourShader, texture1, texture2, VAO);
 
-    // optional: de-allocate all resources once they've outlived their purpose:
-    // ------------------------------------------------------------------------
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
-    glDeleteBuffers(1, &EBO);
+        // optional: de-allocate all resources once they've outlived their purpose:
+        // ------------------------------------------------------------------------
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteBuffers(1, &EBO);
 
-    glDeleteTextures(1, &texture1);
-    glDeleteTextures(1, &texture2);
+        glDeleteTextures(1, &texture1);
+        glDeleteTextures(1, &texture2);
+    }
 
     // glfw: terminate, clearing all previously allocated GLFW resources.
     // ------------------------------------------------------------------
@@ -155,7 +158,7 @@ void createGPUComponents(unsigned int &VBO, unsigned int &VAO, unsigned int &EBO
     glEnableVertexAttribArray(1);
 }
 
-void renderLoop(GLFWwindow *window, Shader ourShader, unsigned int &texture1, unsigned int &texture2, unsigned int &VAO) {
+void renderLoop(GLFWwindow *window, Shader &ourShader, unsigned int &texture1, unsigned int &texture2, unsigned int &VAO) {
 
     while (!glfwWindowShouldClose(window))
     {
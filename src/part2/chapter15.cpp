@@ -4,9 +4,21 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include "../includes/stb_image.h"
 #include <../includes/shader_s.h>
+#include <../includes/shader_batch.h>
+#include <../includes/shader_variants.h>
+#include <../includes/camera_buffer.h>
+#include <../includes/shader_watcher.h>
+#include <../includes/shader_uniforms_data.h>
+#include <../includes/shading_lod.h>
+#include <../includes/uniform_ring.h>
+#include <../includes/autotuner.h>
+#include <../includes/texture_cache.h>
+#include <../includes/async_texture_loader.h>
+#include <../includes/texture_array.h>
 #include <iostream>
 #include <vector>
 #include <string>
+#include <map>
 #include <exception>
 
 #include <../includes/glm/glm/glm.hpp>
@@ -21,16 +33,16 @@ void processInput(GLFWwindow *window);
 void createGPUComponents(unsigned int &VBO, unsigned int &cubeVAO, unsigned int &lightCubeVAO,
                          const std::vector<float> &vertices);
 
-void renderLoop(GLFWwindow *window, Shader &lightingShader, Shader &lightCubeShader,
+void renderLoop(GLFWwindow *window, ShadingLod &lightingLod, Shader &lightCubeShader,
                 unsigned int &cubeVAO, unsigned int &lightCubeVAO);
+unsigned int tuneLighting(ShaderVariants &phong, unsigned int baseMask, unsigned int cubeVAO);
 
 GLFWwindow* createWindow(int width, int height);
 void checkForWindowError(GLFWwindow *window);
 void mouse_callback(GLFWwindow* window, double xposIn, double yposIn);
 void configureMouse(GLFWwindow *window);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
-
-unsigned int loadTexture(char const * path);
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
 
 // settings
 const unsigned int SCR_WIDTH = 800;
@@ -48,6 +60,9 @@ float lastFrame = 0.0f;
 // lighting
 glm::vec3 lightPos(1.2f, 1.0f, 2.0f);
 
+// L toggles the shading LOD debug view
+bool showShadingLod = false;
+
 
 int main()
 {
@@ -64,68 +79,84 @@ int main()
 
     glEnable(GL_DEPTH_TEST);
 
-    // build and compile our shader zprogram
-    // ------------------------------------
-    Shader lightingShader("../src/color_15.vs", "../src/color_15.fs");
-    Shader lightCubeShader("../src/light_cube_15.vs", "../src/light_cube_15.fs");
-
-    std::vector<float> vertices = {
-            // positions          // normals           // texture coords
-            -0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  0.0f,
-            0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  0.0f,
-            0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  1.0f,
-            0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  1.0f,
-            -0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  1.0f,
-            -0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  0.0f,
-
-            -0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  0.0f,
-            0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  0.0f,
-            0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  1.0f,
-            0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  1.0f,
-            -0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  1.0f,
-            -0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  0.0f,
-
-            -0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
-            -0.5f,  0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  1.0f,
-            -0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
-            -0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
-            -0.5f, -0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  0.0f,
-            -0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
-
-            0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
-            0.5f,  0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  1.0f,
-            0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
-            0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
-            0.5f, -0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  0.0f,
-            0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
-
-            -0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  1.0f,
-            0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  1.0f,
-            0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  0.0f,
-            0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  0.0f,
-            -0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  0.0f,
-            -0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  1.0f,
-
-            -0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  1.0f,
-            0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  1.0f,
-            0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  0.0f,
-            0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  0.0f,
-            -0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  0.0f,
-            -0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  1.0f
-    };
-
-    unsigned int VBO, cubeVAO, lightCubeVAO;
-    createGPUComponents(VBO, cubeVAO, lightCubeVAO, vertices);
-
-    // render loop
-    // -----------
-    renderLoop(window, lightingShader, lightCubeShader, cubeVAO, lightCubeVAO);
-
-    // optional: de-allocate all resources once they've outlived their purpose:
-    // ------------------------------------------------------------------------
-    glDeleteVertexArrays(1, &cubeVAO);
-    glDeleteVertexArrays(1, &lightCubeVAO);
-    glDeleteBuffers(1, &VBO);
+    // every object owning GL programs lives in this block and is gone before the window and its context
+    {
+        // build and compile our shader zprogram
+        // ------------------------------------
+        // the batch turns on parallel compilation, so both programs keep compiling while the vertex
+        // data and textures are set up below; each one is checked for errors on its first use(). the lamp
+        // comes from the registry, so every scene hosted next to this one draws it with the same program
+        ProgramRegistry programs;
+        ShaderBatch shaders;
+        // Phong specialized for a diffuse and a specular map in texture array layers, with cheaper variants for
+        // a small cube on screen
+        ShaderVariants phong(SHADER_PART2_PHONG_VS, SHADER_PART2_PHONG_FS,
+                             { "DIFFUSE_MAP", "SPECULAR_MAP", "OBJECT_BLOCK", "TEXTURE_ARRAY", "MATERIAL_BLOCK", "LAMBERT_ONLY", "VERTEX_LIGHTING", "LOD_DEBUG",
+                               "FRAGMENT_NORMAL_MATRIX" });
+        Shader &lightCubeShader = shaders.submit(programs, SHADER_PART2_LIGHT_CUBE_15_VS, SHADER_PART2_LIGHT_CUBE_15_FS);
+
+        std::vector<float> vertices = {
+                // positions          // normals           // texture coords
+                -0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  0.0f,
+                0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  0.0f,
+                0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  1.0f,
+                0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f,  1.0f,
+                -0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  1.0f,
+                -0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f,  0.0f,
+
+                -0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  0.0f,
+                0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  0.0f,
+                0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  1.0f,
+                0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  1.0f,  1.0f,
+                -0.5f,  0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  1.0f,
+                -0.5f, -0.5f,  0.5f,  0.0f,  0.0f,  1.0f,  0.0f,  0.0f,
+
+                -0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+                -0.5f,  0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  1.0f,
+                -0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+                -0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+                -0.5f, -0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  0.0f,  0.0f,
+                -0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+
+                0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+                0.5f,  0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  1.0f,
+                0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+                0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  1.0f,
+                0.5f, -0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  0.0f,  0.0f,
+                0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f,  0.0f,
+
+                -0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  1.0f,
+                0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  1.0f,
+                0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  0.0f,
+                0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f,  0.0f,
+                -0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  0.0f,
+                -0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f,  1.0f,
+
+                -0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  1.0f,
+                0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  1.0f,
+                0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  0.0f,
+                0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f,  0.0f,
+                -0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  0.0f,
+                -0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f,  1.0f
+        };
+
+        unsigned int VBO, cubeVAO, lightCubeVAO;
+        createGPUComponents(VBO, cubeVAO, lightCubeVAO, vertices);
+
+        // where the normal matrix is applied is measured on this GPU the first time, then read from autotune.txt
+        ShadingLod lightingLod(phong, tuneLighting(phong, phong.mask({ "DIFFUSE_MAP", "SPECULAR_MAP", "OBJECT_BLOCK", "TEXTURE_ARRAY", "MATERIAL_BLOCK" }), cubeVAO));
+        lightingLod.shader(SHADING_FULL); // start compiling the level the cube is drawn with at the start
+
+        // render loop
+        // -----------
+        renderLoop(window, lightingLod, lightCubeShader, cubeVAO, lightCubeVAO);
+
+        // optional: de-allocate all resources once they've outlived their purpose:
+        // ------------------------------------------------------------------------
+        glDeleteVertexArrays(1, &cubeVAO);
+        glDeleteVertexArrays(1, &lightCubeVAO);
+        glDeleteBuffers(1, &VBO);
+    }
 
     // glfw: terminate, clearing all previously allocated GLFW resources.
     // ------------------------------------------------------------------
@@ -162,6 +193,7 @@ void configureMouse(GLFWwindow *window) {
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
     glfwSetCursorPosCallback(window, mouse_callback);
     glfwSetScrollCallback(window, scroll_callback);
+    glfwSetKeyCallback(window, key_callback);
 }
 
 GLFWwindow* createWindow(int width, int height) {
@@ -175,30 +207,6 @@ GLFWwindow* createWindow(int width, int height) {
     return glfwCreateWindow(width, height, "LearnOpenGL", NULL, NULL);
 }
 
-void createTexture(const char* imgPath, unsigned int &textureID, bool should_flip) {
-    glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    // set the texture wrapping parameters
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    // set texture filtering parameters
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    // load image, create texture and generate mipmaps
-    int width, height, nrChannels;
-    stbi_set_flip_vertically_on_load(should_flip); // tell stb_image.h to flip loaded texture's on the y-axis.
-    unsigned char *data = stbi_load(imgPath, &width, &height, &nrChannels, 0);
-    if (data) {
-        GLenum format = (nrChannels == 4) ? GL_RGBA : GL_RGB;  // Use correct format
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-    } else {
-        std::cout << "Failed to load texture" << std::endl;
-    }
-
-    stbi_image_free(data);
-}
-
 void createGPUComponents(unsigned int &VBO, unsigned int &cubeVAO, unsigned int &lightCubeVAO,
                          const std::vector<float> &vertices) {
 
@@ -229,15 +237,88 @@ void createGPUComponents(unsigned int &VBO, unsigned int &cubeVAO, unsigned int
     glEnableVertexAttribArray(0);
 }
 
-void renderLoop(GLFWwindow *window, Shader &lightingShader, Shader &lightCubeShader,
-                unsigned int &cubeVAO, unsigned int &lightCubeVAO)
+// pick the faster place for the normal matrix: once per vertex, or once per fragment with a lighter
+// vertex stage. the benchmark draws the cube a few hundred times with each program where it stands in
+// the scene, into the first frame, which is cleared before anything is shown. the depth test is off
+// while it runs: every draw covers the same pixels, and with it on all but the first would be rejected
+// before any fragment was shaded
+// ------------------------------------------------------------------------
+unsigned int tuneLighting(ShaderVariants &phong, unsigned int baseMask, unsigned int cubeVAO)
 {
-    unsigned int diffuseMap = loadTexture("../resources/container2.png");
-    unsigned int specularMap = loadTexture("../resources/container2_specular.png");
+    const unsigned int candidates[] = { baseMask, baseMask | phong.mask({ "FRAGMENT_NORMAL_MATRIX" }) };
+
+    CameraBuffer cameraBuffer;
+    cameraBuffer.update(camera, (float)SCR_WIDTH / (float)SCR_HEIGHT);
+    UniformRing objectRing;
+    objectRing.beginFrame();
+    ObjectUniformBlock object;
+    object.model = glm::mat4(1.0f);
+    objectRing.push(OBJECT_BLOCK_BINDING, object);
+    objectRing.push(MATERIAL_BLOCK_BINDING, MaterialParametersUniformBlock());
+
+    glDisable(GL_DEPTH_TEST);
+    Autotuner tuner;
+    int chosen = tuner.choose("phong.normal_matrix", { "vertex", "fragment" }, [&](int candidate) {
+        Shader &shader = phong.get(candidates[candidate]);
+        shader.use();
+        glBindVertexArray(cubeVAO);
+        for (int i = 0; i < 256; i++)
+            glDrawArrays(GL_TRIANGLES, 0, 36);
+    });
+    objectRing.endFrame();
+    glEnable(GL_DEPTH_TEST);
+    return candidates[chosen];
+}
 
-    lightingShader.use();
-    lightingShader.setInt("material.diffuse", 0);
-    lightingShader.setInt("material.specular", 1);
+void renderLoop(GLFWwindow *window, ShadingLod &lightingLod, Shader &lightCubeShader,
+                unsigned int &cubeVAO, unsigned int &lightCubeVAO)
+{
+    // every material using container2.png gets this same layer, decoded and uploaded once. the maps are
+    // layers of texture arrays - both images are 500x500, so one array - and a material names its layers
+    // instead of binding textures. the files are decoded on worker threads, the scene starts drawing with
+    // grey placeholder layers right away. texture files or KTX2 copies made next to the images
+    // (tools/texture_pack.cpp, tools/texture_compress.cpp, --linear for the specular map) are used
+    // instead when they exist
+    TextureCache textures;
+    TextureArrays textureArrays(4);
+    AsyncTextureLoader textureLoader(textures);
+    TextureRegion diffuseMap = textureLoader.load(TextureCache::prepared("../resources/container2.png"), TextureOptions(), textureArrays);
+    TextureOptions specularData;
+    specularData.srgb = false; // specular intensities, not colors: mipmapped as plain numbers
+    TextureRegion specularMap = textureLoader.load(TextureCache::prepared("../resources/container2_specular.png"), specularData, textureArrays);
+
+    // camera matrices for every program, filled once per frame
+    CameraBuffer cameraBuffer;
+    // per-object model matrices and material parameters, one ring range of each bound per draw
+    UniformRing objectRing;
+
+    // edits to the shader sources are picked up while running. the programs come from the compiled-in
+    // pack, so this only has files to watch when SHADER_SOURCE_DIR points at the repository
+    ShaderWatcher watcher;
+    watcher.watch(lightCubeShader);
+
+    // resolve the uniform handles once, the loop below only indexes the shaders' uniform tables.
+    // the structs are generated from the GLSL (tools/uniform_structs.txt), a misspelled member doesn't compile
+    // every shading LOD is its own program with its own table, they're set up the first time one is drawn with
+    std::map<Shader *, UniformSet<PhongStreamedUniforms>> lightingUniforms;
+
+    PhongStreamedUniforms lighting = {};
+    lighting.material.diffuse = 0;
+    lighting.material.specular = 1;
+    lighting.material.shininess = 64.0f;
+    // where the cube's maps sit in the arrays, pushed through the ring with its model matrix
+    MaterialParametersUniformBlock cubeMaterial = {};
+    cubeMaterial.diffuseRect = diffuseMap.rect;
+    cubeMaterial.diffuseLayer = diffuseMap.layer;
+    cubeMaterial.specularRect = specularMap.rect;
+    cubeMaterial.specularLayer = specularMap.layer;
+    // the arrays stay bound for good, uploads into them don't disturb the binding
+    TextureArrays::bind(diffuseMap, 0);
+    TextureArrays::bind(specularMap, 1);
+    // light properties - these never change, the shader's shadow copy drops the repeated uploads
+    lighting.light.ambient = glm::vec3(0.2f, 0.2f, 0.2f);
+    lighting.light.diffuse = glm::vec3(0.5f, 0.5f, 0.5f);
+    lighting.light.specular = glm::vec3(1.0f, 1.0f, 1.0f);
 
     while (!glfwWindowShouldClose(window))
     {
@@ -251,40 +332,44 @@ void renderLoop(GLFWwindow *window, Shader &lightingShader, Shader &lightCubeSha
         // -----
         processInput(window);
 
+        // swap in any shader that was edited and has finished recompiling
+        watcher.update();
+        // upload the textures whose decode finished, a few megabytes per frame at most, straight from
+        // the staging ring the workers decoded into
+        textureLoader.update();
+
+        // reuse the oldest ring region, waiting only if the GPU is still reading it
+        objectRing.beginFrame();
+
         // render
         // ------
         glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
         // be sure to activate shader when setting uniforms/drawing objects
+        lightingLod.setDebugView(showShadingLod);
+        Shader &lightingShader = lightingLod.shaderFor(camera, glm::vec3(0.0f), 0.87f); // unit cube's bounding sphere
+        if (!lightingUniforms.count(&lightingShader))
+        {
+            watcher.watch(lightingShader);
+            // the light never changes here: after a couple of seconds the lighting program is
+            // recompiled with it folded in as constants
+            lightingShader.enableSpecialization();
+            lightingUniforms[&lightingShader] = lightingShader.uniformSet<PhongStreamedUniforms>();
+        }
         lightingShader.use();
-        lightingShader.setVec3("light.position", lightPos);
-        lightingShader.setVec3("viewPos", camera.Position);
+        lighting.light.position = lightPos;
 
-        // light properties
-        lightingShader.setVec3("light.ambient", 0.2f, 0.2f, 0.2f);
-        lightingShader.setVec3("light.diffuse", 0.5f, 0.5f, 0.5f);
-        lightingShader.setVec3("light.specular", 1.0f, 1.0f, 1.0f);
+        // view/projection transformations, one upload shared by both programs
+        cameraBuffer.update(camera, (float)SCR_WIDTH / (float)SCR_HEIGHT);
 
-        // material properties
-        lightingShader.setVec3("material.specular", 0.5f, 0.5f, 0.5f);
-        lightingShader.setFloat("material.shininess", 64.0f);
-
-        // view/projection transformations
-        glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
-        glm::mat4 view = camera.GetViewMatrix();
-        lightingShader.setMat4("projection", projection);
-        lightingShader.setMat4("view", view);
+        lightingShader.set(lightingUniforms[&lightingShader], lighting);
 
         // world transformation
-        glm::mat4 model = glm::mat4(1.0f);
-        lightingShader.setMat4("model", model);
-
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, diffuseMap);
-
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, specularMap);
+        ObjectUniformBlock object;
+        object.model = glm::mat4(1.0f);
+        objectRing.push(OBJECT_BLOCK_BINDING, object);
+        objectRing.push(MATERIAL_BLOCK_BINDING, cubeMaterial);
 
         // render the cube
         glBindVertexArray(cubeVAO);
@@ -293,22 +378,32 @@ void renderLoop(GLFWwindow *window, Shader &lightingShader, Shader &lightCubeSha
 
         // also draw the lamp object
         lightCubeShader.use();
-        lightCubeShader.setMat4("projection", projection);
-        lightCubeShader.setMat4("view", view);
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, lightPos);
-        model = glm::scale(model, glm::vec3(0.2f)); // a smaller cube
-        lightCubeShader.setMat4("model", model);
+        object.model = glm::mat4(1.0f);
+        object.model = glm::translate(object.model, lightPos);
+        object.model = glm::scale(object.model, glm::vec3(0.2f)); // a smaller cube
+        objectRing.push(OBJECT_BLOCK_BINDING, object);
 
         glBindVertexArray(lightCubeVAO);
         glDrawArrays(GL_TRIANGLES, 0, 36);
+        objectRing.endFrame();
 
+        for (auto &entry : lightingUniforms)
+            entry.first->endFrame();
+        lightCubeShader.endFrame();
+        lightingLod.endFrame();
 
         // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
         // -------------------------------------------------------------------------------
         glfwSwapBuffers(window);
         glfwPollEvents();
     }
+
+    // how the texture streaming went: upload rate through the staging ring, decodes that had to wait for it
+    AsyncTextureLoader::Stats loading = textureLoader.stats();
+    std::cout << "textures: " << loading.uploaded << " uploaded, " << loading.stalls << " stalled on staging memory";
+    if (textureLoader.stagingRing())
+        std::cout << ", " << textureLoader.stagingRing()->stats().megabytesPerSecond() << " MB/s";
+    std::cout << std::endl;
 }
 
 void checkForWindowError(GLFWwindow *window) {
@@ -354,39 +449,10 @@ void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
     camera.ProcessMouseScroll(static_cast<float>(yoffset));
 }
 
-unsigned int loadTexture(char const * path)
+// glfw: toggle the shading LOD debug view on L
+// ----------------------------------------------------------------------
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
 {
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
-
-    int width, height, nrComponents;
-    unsigned char *data = stbi_load(path, &width, &height, &nrComponents, 0);
-    if (data)
-    {
-        GLenum format;
-        if (nrComponents == 1)
-            format = GL_RED;
-        else if (nrComponents == 3)
-            format = GL_RGB;
-        else if (nrComponents == 4)
-            format = GL_RGBA;
-
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        stbi_image_free(data);
-    }
-    else
-    {
-        std::cout << "Texture failed to load at path: " << path << std::endl;
-        stbi_image_free(data);
-    }
-
-    return textureID;
+    if (key == GLFW_KEY_L && action == GLFW_PRESS)
+        showShadingLod = !showShadingLod;
 }
@@ -1,47 +0,0 @@
-#version 330 core
-
-struct Material {
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-    float shininess;
-};
-
-struct Light {
-    vec3 position;
-
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-};
-
-out vec4 FragColor;
-
-in vec3 Normal;
-in vec3 FragPos;
-
-uniform vec3 viewPos;
-uniform Material material;
-uniform Light light;
-
-void main()
-{
-   // ambient
-   vec3 ambient = light.ambient * material.ambient;
-
-   // diffuse
-   vec3 norm = normalize(Normal);
-   vec3 lightDir = normalize(light.position - FragPos);
-   float diff = max(dot(norm, lightDir), 0.0);
-   vec3 diffuse = light.specular * (diff * material.diffuse);
-
-   // specular
-   vec3 viewDir = normalize(viewPos - FragPos);
-   vec3 reflectDir = reflect(-lightDir, norm);
-   float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
-   vec3 specular = light.specular * (material.specular * spec);
-
-   // calculate final color
-   vec3 resultColor = ambient + diffuse + specular;
-   FragColor = vec4(resultColor, 1.0);
-}
\ No newline at end of file
@@ -0,0 +1,52 @@
+#version 330 core
+#include "../common/camera.glsl"
+#include "../common/lighting.glsl"
+#if defined(FRAGMENT_NORMAL_MATRIX) && !defined(VERTEX_LIGHTING)
+#include "../common/object.glsl"
+#endif
+
+out vec4 FragColor;
+
+in vec3 Normal;
+in vec3 FragPos;
+in vec2 TexCoords;
+#ifdef VERTEX_LIGHTING
+in vec3 AmbientTerm;
+in vec3 DiffuseTerm;
+in vec3 SpecularTerm;
+#endif
+
+uniform Material material;
+uniform Light light;
+
+void main()
+{
+#ifdef VERTEX_LIGHTING
+    LightTerms terms;
+    terms.ambient = AmbientTerm;
+    terms.diffuse = DiffuseTerm;
+    terms.specular = SpecularTerm;
+    vec3 result = shade(material, terms, TexCoords);
+#else
+#ifdef FRAGMENT_NORMAL_MATRIX
+    // per fragment instead of per vertex: less vertex work, more fragment work, see Autotuner
+    vec3 normal = mat3(transpose(inverse(model))) * Normal;
+#else
+    vec3 normal = Normal;
+#endif
+    vec3 result = phong(material, light, normal, FragPos, viewPos, TexCoords);
+#endif
+#ifdef LOD_DEBUG
+    // tint by shading LOD: green full Phong, yellow Lambert, red per-vertex
+#ifdef VERTEX_LIGHTING
+    result = mix(result, vec3(1.0, 0.2, 0.2), 0.5);
+#else
+#ifdef LAMBERT_ONLY
+    result = mix(result, vec3(1.0, 1.0, 0.2), 0.5);
+#else
+    result = mix(result, vec3(0.2, 1.0, 0.2), 0.5);
+#endif
+#endif
+#endif
+    FragColor = vec4(result, 1.0);
+}
@@ -0,0 +1,43 @@
+#version 330 core
+#include "../common/camera.glsl"
+#include "../common/object.glsl"
+#ifdef VERTEX_LIGHTING
+#include "../common/lighting.glsl"
+#endif
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoords;
+#ifdef VERTEX_LIGHTING
+// per-vertex light terms, the fragment stage only applies the material's colors
+out vec3 AmbientTerm;
+out vec3 DiffuseTerm;
+out vec3 SpecularTerm;
+
+uniform Material material;
+uniform Light light;
+#endif
+
+void main()
+{
+	FragPos = vec3(model * vec4(aPos, 1.0));
+#if defined(FRAGMENT_NORMAL_MATRIX) && !defined(VERTEX_LIGHTING)
+	// the fragment stage applies the normal matrix, see phong.fs
+	Normal = aNormal;
+#else
+	Normal = mat3(transpose(inverse(model))) * aNormal;
+#endif
+
+	gl_Position = projection * view * model * vec4(aPos, 1.0);
+	TexCoords = aTexCoords;
+#ifdef VERTEX_LIGHTING
+	LightTerms terms = lightTerms(light, MATERIAL_SHININESS, Normal, FragPos, viewPos);
+	AmbientTerm = terms.ambient;
+	DiffuseTerm = terms.diffuse;
+	SpecularTerm = terms.specular;
+#endif
+}
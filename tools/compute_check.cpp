@@ -0,0 +1,137 @@
+// Runs the procedural animation as a compute program (src/animate_instances.cs) and checks it against
+// ProceduralAnimation::modelMatrix(), exercising includes/compute_shader.h along the way:
+//   - the local size is read from the program and the group count derived from it
+//   - the instance buffer is read and the matrix buffer written through tracked storage bindings, and the
+//     read back and the next dispatch issue only the barriers MemoryBarriers says are missing
+//   - a dispatch past GL_MAX_COMPUTE_WORK_GROUP_COUNT is refused without reaching the driver
+// Needs GL 4.3. Build it against glad and GLFW from the repository root, it runs without any files:
+//
+//   g++ -std=c++17 -O2 -Isrc -Iglad/include tools/compute_check.cpp glad/src/glad.c -o compute_check -lglfw -ldl
+//   ./compute_check [instances]
+//
+// Exits with 1 if anything doesn't match.
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include "../includes/compute_shader.h"
+#include "../includes/procedural_animation.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+// largest difference between the matrices read back and modelMatrix() for every instance
+static float compare(const ProceduralAnimation &animation, const std::vector<glm::mat4> &models, float time)
+{
+    float error = 0.0f;
+    for (size_t i = 0; i < animation.size(); i++)
+    {
+        glm::mat4 reference = ProceduralAnimation::modelMatrix(animation.parameters()[i], time);
+        for (int column = 0; column < 4; column++)
+            for (int row = 0; row < 4; row++)
+                error = std::max(error, std::fabs(models[i][column][row] - reference[column][row]));
+    }
+    return error;
+}
+
+static bool check(bool passed, const char *what)
+{
+    std::printf("  %-52s %s\n", what, passed ? "ok" : "FAILED");
+    return passed;
+}
+
+int main(int argc, char **argv)
+{
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow *window = glfwCreateWindow(64, 64, "compute_check", NULL, NULL);
+    if (!window)
+    {
+        std::fprintf(stderr, "no OpenGL 4.3 context\n");
+        glfwTerminate();
+        return 1;
+    }
+    glfwMakeContextCurrent(window);
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::fprintf(stderr, "failed to initialize GLAD\n");
+        glfwTerminate();
+        return 1;
+    }
+    if (!ComputeShader::supported())
+    {
+        std::fprintf(stderr, "%s has no compute shaders\n", reinterpret_cast<const char *>(glGetString(GL_RENDERER)));
+        glfwTerminate();
+        return 1;
+    }
+    GLuint count = argc > 1 ? (GLuint)std::strtoul(argv[1], NULL, 10) : 1000;
+    std::printf("%s, %u instances\n", reinterpret_cast<const char *>(glGetString(GL_RENDERER)), count);
+
+    bool passed = true;
+    {
+        // the GL objects go before the context does
+        std::vector<AnimatedInstance> instances;
+        std::mt19937 random(1);
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        for (GLuint i = 0; i < count; i++)
+            instances.push_back({ glm::vec3(unit(random), unit(random), unit(random)) * 10.0f, unit(random) * 90.0f,
+                                  glm::vec3(unit(random), unit(random), 1.0f), unit(random) * 180.0f });
+        ProceduralAnimation animation;
+        animation.setInstances(instances);
+
+        GLuint modelBuffer;
+        glGenBuffers(1, &modelBuffer);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, modelBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, count * sizeof(glm::mat4), NULL, GL_DYNAMIC_COPY);
+
+        MemoryBarriers barriers;
+        ComputeShader animate(SHADER_ANIMATE_INSTANCES_CS, barriers);
+        Uniform<float> time = animate.uniform<float>("time");
+        Uniform<unsigned int> instanceCount = animate.uniform<unsigned int>("count");
+        animate.bindStorageBuffer(0, animation.ID, GL_READ_ONLY);
+        animate.bindStorageBuffer(1, modelBuffer, GL_WRITE_ONLY);
+        GLuint groups = animate.groupsFor(count);
+        std::printf("local size %d, %u groups\n", animate.localSize()[0], groups);
+
+        std::vector<glm::mat4> models(count);
+        for (float seconds : { 0.0f, 1.3f, 1000.5f })
+        {
+            unsigned int before = barriers.barrierCount();
+            animate.use();
+            animate.set(time, seconds);
+            animate.set(instanceCount, count);
+            passed &= check(animate.dispatch(groups), "dispatch");
+            // a write-only binding still orders the previous dispatch's writes, once
+            passed &= check(barriers.barrierCount() == before + (before ? 1u : 0u), "barrier before the dispatch only if written");
+            unsigned int dispatched = barriers.barrierCount();
+            barriers.read(bufferResource(modelBuffer), GL_BUFFER_UPDATE_BARRIER_BIT);
+            barriers.read(bufferResource(modelBuffer), GL_BUFFER_UPDATE_BARRIER_BIT);
+            passed &= check(barriers.barrierCount() == dispatched + 1 && barriers.lastBarrierBits() == GL_BUFFER_UPDATE_BARRIER_BIT,
+                            "one buffer update barrier for the read back");
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, modelBuffer);
+            glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, count * sizeof(glm::mat4), models.data());
+            float error = compare(animation, models, seconds);
+            std::printf("t=%g: largest difference %g, %u barriers so far\n", seconds, error, barriers.barrierCount());
+            passed &= check(error < 1e-3f, "matches ProceduralAnimation::modelMatrix");
+        }
+
+        GLint maxGroups;
+        glGetIntegeri_v(GL_MAX_COMPUTE_WORK_GROUP_COUNT, 0, &maxGroups);
+        passed &= check(!animate.dispatch((GLuint)maxGroups + 1), "dispatch over the work group count refused");
+        passed &= check(glGetError() == GL_NO_ERROR, "no GL errors");
+
+        glDeleteBuffers(1, &modelBuffer);
+    }
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    std::printf(passed ? "all checks passed\n" : "some checks FAILED\n");
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,164 @@
+// Times the CPU mip chain builder (includes/mip_chain.h) against glGenerateMipmap.
+// For every image it reports:
+//   - build: the CPU filter per kernel (scalar / sse2 / avx2), work that runs on loader threads
+//   - upload levels: glTexImage2D of every prebuilt level, what is left for the GL thread
+//   - glGenerateMipmap: level 0 upload plus driver mipmapping, wall time and GPU time of the mipmapping
+// Each time is the best of several runs. Build it against glad and GLFW from the repository root, run it
+// from a build directory so the default ../resources images are found, or name images as arguments:
+//
+//   g++ -std=c++17 -O2 -Isrc -Iglad/include tools/mip_benchmark.cpp glad/src/glad.c -o mip_benchmark -lglfw -ldl
+//   ./mip_benchmark [image ...]
+//
+// A generated 2048x2048 RGBA image is always measured as well, so there is something to time without files.
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "../includes/stb_image.h"
+#include "../includes/texture_cache.h"
+#include "../includes/mip_chain.h"
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+static const int RUNS = 5;
+
+struct Image
+{
+    std::string name;
+    int width, height, channels;
+    std::vector<unsigned char> pixels;
+};
+
+// best wall time in milliseconds of RUNS calls
+static double bestOf(const std::function<void()> &work)
+{
+    double best = 1e30;
+    for (int run = 0; run < RUNS; run++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        work();
+        best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    return best;
+}
+
+static GLenum formatFor(int channels)
+{
+    return channels == 1 ? GL_RED : channels == 2 ? GL_RG : channels == 3 ? GL_RGB : GL_RGBA;
+}
+
+static void measure(const Image &image)
+{
+    MipChain chain(image.width, image.height, image.channels);
+    std::vector<unsigned char> levels(chain.size);
+    double megapixels = image.width * (double)image.height / 1.0e6;
+    std::printf("%s: %dx%d, %d channels, %zu levels\n", image.name.c_str(), image.width, image.height, image.channels,
+                chain.levels.size());
+
+    MipKernel kernels[] = { MIP_KERNEL_SCALAR, MIP_KERNEL_SSE2, MIP_KERNEL_AVX2 };
+    for (MipKernel kernel : kernels)
+    {
+        if (!MipChain::supported(kernel))
+            continue;
+        MipOptions options;
+        options.kernel = kernel;
+        double ms = bestOf([&] { chain.build(image.pixels.data(), levels.data(), options); });
+        std::printf("  build %-8s %9.3f ms  %8.1f MP/s\n", MipChain::kernelName(kernel), ms, megapixels / (ms / 1000.0));
+    }
+
+    Texture texture;
+    double uploadMs = bestOf([&] {
+        texture.upload(levels.data(), chain);
+        glFinish();
+    });
+    std::printf("  upload levels   %9.3f ms\n", uploadMs);
+
+    GLenum format = formatFor(image.channels);
+    GLuint query;
+    glGenQueries(1, &query);
+    double gpuMs = 1e30;
+    double generateMs = bestOf([&] {
+        glBindTexture(GL_TEXTURE_2D, texture.ID);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, format, image.width, image.height, 0, format, GL_UNSIGNED_BYTE, image.pixels.data());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glBeginQuery(GL_TIME_ELAPSED, query);
+        glGenerateMipmap(GL_TEXTURE_2D);
+        glEndQuery(GL_TIME_ELAPSED);
+        glFinish();
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+        gpuMs = std::min(gpuMs, elapsed / 1.0e6);
+    });
+    glDeleteQueries(1, &query);
+    std::printf("  glGenerateMipmap %8.3f ms  (upload + mipmaps, %.3f ms GPU mipmapping)\n", generateMs, gpuMs);
+}
+
+int main(int argc, char **argv)
+{
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow *window = glfwCreateWindow(64, 64, "mip_benchmark", NULL, NULL);
+    if (!window)
+    {
+        std::fprintf(stderr, "no OpenGL context\n");
+        glfwTerminate();
+        return 1;
+    }
+    glfwMakeContextCurrent(window);
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::fprintf(stderr, "failed to initialize GLAD\n");
+        glfwTerminate();
+        return 1;
+    }
+    std::printf("%s, best kernel %s\n", reinterpret_cast<const char *>(glGetString(GL_RENDERER)),
+                MipChain::kernelName(MipChain::bestKernel()));
+
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++)
+        paths.push_back(argv[i]);
+    if (paths.empty())
+        paths = { "../resources/container.jpg", "../resources/container2.png", "../resources/awesomeface.png" };
+
+    {
+        std::vector<Image> images;
+        for (const std::string &path : paths)
+        {
+            Image image;
+            image.name = path;
+            unsigned char *data = stbi_load(path.c_str(), &image.width, &image.height, &image.channels, 0);
+            if (!data)
+            {
+                std::printf("%s: not loaded, skipped\n", path.c_str());
+                continue;
+            }
+            image.pixels.assign(data, data + (size_t)image.width * image.height * image.channels);
+            stbi_image_free(data);
+            images.push_back(image);
+        }
+        Image noise = { "generated noise", 2048, 2048, 4, {} };
+        noise.pixels.resize((size_t)2048 * 2048 * 4);
+        std::mt19937 random(1);
+        for (unsigned char &byte : noise.pixels)
+            byte = (unsigned char)random();
+        images.push_back(noise);
+
+        for (const Image &image : images)
+            measure(image);
+    }
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
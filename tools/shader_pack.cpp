@@ -0,0 +1,103 @@
+// Packs every .vs/.fs/.cs shader under the given directories into a C++ header, so the programs can be
+// built from compiled-in sources without touching the filesystem at startup.
+// #includes are expanded here, at pack time. Run it from the repository root whenever a shader changes:
+//
+//   g++ -std=c++17 -O2 tools/shader_pack.cpp -o shader_pack
+//   ./shader_pack includes/shader_pack_data.h src
+//
+// Each shader gets an enum id derived from its path (src/part2/phong.vs -> SHADER_PART2_PHONG_VS),
+// see includes/shader_pack.h for the runtime side.
+
+#include "../includes/hash.h"
+#include "../includes/shader_preprocessor.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+struct PackedShader
+{
+    std::string path;       // relative to the repository root, '/' separated
+    std::string identifier; // enum name
+    std::string source;     // includes expanded
+};
+
+// src/part2/phong.vs -> SHADER_PART2_PHONG_VS, the leading "src/" is dropped
+static std::string identifierFor(const std::string &path)
+{
+    std::string name = path;
+    if (name.compare(0, 4, "src/") == 0)
+        name.erase(0, 4);
+    std::string identifier = "SHADER_";
+    for (char c : name)
+        identifier += std::isalnum((unsigned char)c) ? (char)std::toupper((unsigned char)c) : '_';
+    return identifier;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        std::cout << "usage: shader_pack <output header> <directory>..." << std::endl;
+        return 1;
+    }
+
+    std::vector<PackedShader> shaders;
+    for (int i = 2; i < argc; i++)
+    {
+        for (const auto &entry : std::filesystem::recursive_directory_iterator(argv[i]))
+        {
+            std::string extension = entry.path().extension().string();
+            if (!entry.is_regular_file() || (extension != ".vs" && extension != ".fs" && extension != ".cs"))
+                continue;
+            PackedShader shader;
+            shader.path = entry.path().lexically_normal().generic_string();
+            shader.identifier = identifierFor(shader.path);
+            shader.source = ShaderPreprocessor::load(shader.path, {});
+            if (shader.source.find(")GLSL\"") != std::string::npos)
+            {
+                std::cout << "ERROR::SHADER_PACK::UNPACKABLE_SOURCE: " << shader.path << std::endl;
+                return 1;
+            }
+            shaders.push_back(shader);
+        }
+    }
+    // directory iteration order is unspecified, sort so the output (and the ids) are stable
+    std::sort(shaders.begin(), shaders.end(),
+              [](const PackedShader &a, const PackedShader &b) { return a.path < b.path; });
+
+    std::ofstream out(argv[1], std::ios::trunc);
+    if (!out)
+    {
+        std::cout << "ERROR::SHADER_PACK::CANNOT_WRITE: " << argv[1] << std::endl;
+        return 1;
+    }
+    out << "// generated by tools/shader_pack.cpp - do not edit, rerun the tool instead\n"
+           "#ifndef SHADER_PACK_DATA_H\n"
+           "#define SHADER_PACK_DATA_H\n\n"
+           "#include <cstdint>\n\n"
+           "enum ShaderPackId\n{\n";
+    for (const PackedShader &shader : shaders)
+        out << "    " << shader.identifier << ",\n";
+    out << "    SHADER_PACK_COUNT\n};\n\n"
+           "struct ShaderPackEntry\n{\n"
+           "    const char *path;\n"
+           "    const char *source;\n"
+           "    std::uint64_t hash; // hashString(source), see includes/hash.h\n"
+           "};\n\n"
+           "constexpr ShaderPackEntry SHADER_PACK[SHADER_PACK_COUNT] = {\n";
+    for (const PackedShader &shader : shaders)
+    {
+        char hash[32];
+        std::snprintf(hash, sizeof(hash), "0x%016llxull", (unsigned long long)hashString(shader.source));
+        out << "    { \"" << shader.path << "\", R\"GLSL(" << shader.source << ")GLSL\", " << hash << " },\n";
+    }
+    out << "};\n\n#endif\n";
+    std::cout << "packed " << shaders.size() << " shaders into " << argv[1] << std::endl;
+    return 0;
+}
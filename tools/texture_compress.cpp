@@ -0,0 +1,148 @@
+// Compresses images into KTX2 files of BC1/BC3/BC4/BC5/BC7 blocks with a full mip chain, for
+// TextureCache and AsyncTextureLoader to upload with glCompressedTexImage2D (includes/ktx2.h).
+// The mip chain is filtered like the runtime one (includes/mip_chain.h, in linear light unless --linear),
+// then every level is block compressed on all cores (includes/block_compression.h).
+//
+// The format follows the channels by default: 1 -> bc4, 2 -> bc5, 3 -> bc1, 4 -> bc3. bc7 is the
+// better looking choice for RGBA. --flip stores the image bottom row first, what loading the image with
+// TextureOptions::flip gives - a compressed texture can't be flipped at load time. --linear is for
+// data textures (specular and normal maps), loaded with TextureOptions::srgb = false.
+// Build it from the repository root, it needs neither GL nor GLFW:
+//
+//   g++ -std=c++17 -O2 -pthread -Isrc tools/texture_compress.cpp -o texture_compress
+//   ./texture_compress [--format bc1|bc3|bc4|bc5|bc7] [--linear] [--flip] [--threads n] input output.ktx2
+//
+// It prints the size against the uncompressed mip chain and the PSNR of level 0 after a round trip.
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "../includes/stb_image.h"
+#include "../includes/mip_chain.h"
+#include "../includes/block_compression.h"
+#include "../includes/ktx2.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static int usage()
+{
+    std::fprintf(stderr, "usage: texture_compress [--format bc1|bc3|bc4|bc5|bc7] [--linear] [--flip] [--threads n] input output.ktx2\n");
+    return 1;
+}
+
+static bool parseFormat(const std::string &name, BlockFormat &format)
+{
+    BlockFormat formats[] = { BLOCK_BC1, BLOCK_BC3, BLOCK_BC4, BLOCK_BC5, BLOCK_BC7 };
+    for (BlockFormat candidate : formats)
+    {
+        if (name == BlockCodec::name(candidate))
+        {
+            format = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+// PSNR over the channels the format keeps, of level 0 against its compressed blocks
+static double psnr(const unsigned char *pixels, int width, int height, int channels, BlockFormat format, const unsigned char *blocks)
+{
+    std::vector<unsigned char> decoded((size_t)width * height * 4);
+    BlockCodec::decodeImage(format, blocks, width, height, decoded.data());
+    int compared = std::min(channels, BlockCodec::channels(format));
+    double error = 0.0;
+    for (size_t texel = 0; texel < (size_t)width * height; texel++)
+    {
+        for (int c = 0; c < compared; c++)
+        {
+            double d = (double)pixels[texel * channels + c] - decoded[texel * 4 + c];
+            error += d * d;
+        }
+    }
+    error /= (double)width * height * compared;
+    return error == 0.0 ? INFINITY : 10.0 * std::log10(255.0 * 255.0 / error);
+}
+
+int main(int argc, char **argv)
+{
+    std::string input, output;
+    BlockFormat format = BLOCK_BC1;
+    bool formatGiven = false;
+    bool linear = false;
+    bool flip = false;
+    unsigned int threads = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        if (argument == "--format" && i + 1 < argc)
+        {
+            if (!parseFormat(argv[++i], format))
+                return usage();
+            formatGiven = true;
+        }
+        else if (argument == "--linear")
+            linear = true;
+        else if (argument == "--flip")
+            flip = true;
+        else if (argument == "--threads" && i + 1 < argc)
+            threads = (unsigned int)std::atoi(argv[++i]);
+        else if (input.empty())
+            input = argument;
+        else if (output.empty())
+            output = argument;
+        else
+            return usage();
+    }
+    if (input.empty() || output.empty())
+        return usage();
+
+    stbi_set_flip_vertically_on_load(flip);
+    int width, height, channels;
+    unsigned char *data = stbi_load(input.c_str(), &width, &height, &channels, 0);
+    if (!data)
+    {
+        std::fprintf(stderr, "%s: %s\n", input.c_str(), stbi_failure_reason());
+        return 1;
+    }
+    if (!formatGiven)
+    {
+        BlockFormat byChannels[] = { BLOCK_BC4, BLOCK_BC5, BLOCK_BC1, BLOCK_BC3 };
+        format = byChannels[channels - 1];
+    }
+    // BC4 and BC5 hold data channels, there is no sRGB variant of them
+    bool srgb = !linear && format != BLOCK_BC4 && format != BLOCK_BC5;
+
+    auto start = std::chrono::steady_clock::now();
+    MipChain chain(width, height, channels);
+    std::vector<unsigned char> mips(chain.size);
+    MipOptions mipOptions;
+    mipOptions.srgb = !linear;
+    chain.build(data, mips.data(), mipOptions);
+    stbi_image_free(data);
+    double mipMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    size_t size;
+    std::vector<MipLevel> levels = Ktx2File::layout(format, width, height, (int)chain.levels.size(), size);
+    std::vector<unsigned char> blocks(size);
+    for (size_t level = 0; level < levels.size(); level++)
+    {
+        const MipLevel &mip = chain.levels[level];
+        BlockCodec::encodeImage(format, mips.data() + mip.offset, mip.width, mip.height, channels, blocks.data() + levels[level].offset, threads);
+    }
+    double encodeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    if (!Ktx2File::write(output, format, srgb, flip, width, height, levels, blocks.data(), "texture_compress"))
+        return 1;
+    std::printf("%s: %dx%d, %d channels -> %s %s, %zu levels\n", input.c_str(), width, height, channels,
+                BlockCodec::name(format), srgb ? "srgb" : "linear", levels.size());
+    std::printf("  %zu bytes (uncompressed mip chain %zu, %.1fx smaller)\n", size, chain.size, (double)chain.size / size);
+    std::printf("  mips %.1f ms, encode %.1f ms (%.1f MP/s), level 0 PSNR %.2f dB\n", mipMs, encodeMs,
+                chain.size / (double)channels / 1.0e6 / (encodeMs / 1000.0),
+                psnr(mips.data(), width, height, channels, format, blocks.data()));
+    return 0;
+}
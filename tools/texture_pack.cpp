@@ -0,0 +1,143 @@
+// Converts images into texture files (includes/texture_file.h): decoded, flipped, mipmapped and row
+// padded once here, so loading them at startup is an mmap and the uploads - no decoder runs.
+// Each image.ext is written next to itself as image.gltex (or into --out). TextureCache::prepared()
+// picks the .gltex over the image, so the chapters use them as soon as they exist.
+//
+// --flip stores the image bottom row first: use it for textures loaded with TextureOptions::flip.
+// --linear filters the mips of data textures (specular maps) without the sRGB curve, for textures
+// loaded with TextureOptions::srgb off. A file written for other options than it is loaded with is
+// refused. --format bc1|bc3|bc4|bc5|bc7 stores block compressed levels
+// (includes/block_compression.h) instead of raw texels.
+// Build it from the repository root, it needs neither GL nor GLFW, and convert the resources:
+//
+//   g++ -std=c++17 -O2 -pthread -Isrc tools/texture_pack.cpp -o texture_pack
+//   ./texture_pack --flip resources/container.jpg
+//   ./texture_pack resources/container2.png resources/awesomeface.png
+//   ./texture_pack --linear resources/container2_specular.png
+//
+// For every image it prints the decode and mip time a load of the texture file no longer spends.
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "../includes/stb_image.h"
+#include "../includes/mip_chain.h"
+#include "../includes/block_compression.h"
+#include "../includes/ktx2.h"
+#include "../includes/texture_file.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+static int usage()
+{
+    std::fprintf(stderr, "usage: texture_pack [--flip] [--linear] [--format bc1|bc3|bc4|bc5|bc7] [--out dir] image ...\n");
+    return 1;
+}
+
+static double millisecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static bool pack(const std::string &input, const std::string &output, bool flip, bool linear, bool compress, BlockFormat format)
+{
+    auto start = std::chrono::steady_clock::now();
+    stbi_set_flip_vertically_on_load(flip);
+    int width, height, channels;
+    unsigned char *data = stbi_load(input.c_str(), &width, &height, &channels, 0);
+    if (!data)
+    {
+        std::fprintf(stderr, "%s: %s\n", input.c_str(), stbi_failure_reason());
+        return false;
+    }
+    double decodeMs = millisecondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    MipChain chain(width, height, channels);
+    std::vector<unsigned char> mips(chain.size);
+    MipOptions mipOptions;
+    mipOptions.srgb = !linear;
+    chain.build(data, mips.data(), mipOptions);
+    stbi_image_free(data);
+    double mipMs = millisecondsSince(start);
+
+    std::uint32_t flags = (flip ? TextureFile::FLIPPED : 0) | (linear ? 0 : TextureFile::SRGB);
+    bool written;
+    if (compress)
+    {
+        size_t size;
+        std::vector<MipLevel> levels = Ktx2File::layout(format, width, height, (int)chain.levels.size(), size);
+        std::vector<unsigned char> blocks(size);
+        for (size_t level = 0; level < levels.size(); level++)
+        {
+            const MipLevel &mip = chain.levels[level];
+            BlockCodec::encodeImage(format, mips.data() + mip.offset, mip.width, mip.height, channels, blocks.data() + levels[level].offset);
+        }
+        written = TextureFile::write(output, format, levels, blocks.data(), flags);
+    }
+    else
+        written = TextureFile::write(output, chain, mips.data(), flags);
+    if (!written)
+        return false;
+
+    std::error_code error;
+    std::printf("%s -> %s: %dx%d, %d channels%s%s, %zu levels, %ju bytes\n", input.c_str(), output.c_str(), width, height,
+                channels, compress ? ", " : "", compress ? BlockCodec::name(format) : "", chain.levels.size(),
+                (std::uintmax_t)std::filesystem::file_size(output, error));
+    std::printf("  saves decode %.1f ms + mips %.1f ms per load\n", decodeMs, mipMs);
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    bool flip = false, linear = false, compress = false;
+    BlockFormat format = BLOCK_BC1;
+    std::string outputDirectory;
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        if (argument == "--flip")
+            flip = true;
+        else if (argument == "--linear")
+            linear = true;
+        else if (argument == "--out" && i + 1 < argc)
+            outputDirectory = argv[++i];
+        else if (argument == "--format" && i + 1 < argc)
+        {
+            std::string name = argv[++i];
+            BlockFormat formats[] = { BLOCK_BC1, BLOCK_BC3, BLOCK_BC4, BLOCK_BC5, BLOCK_BC7 };
+            compress = false;
+            for (BlockFormat candidate : formats)
+            {
+                if (name == BlockCodec::name(candidate))
+                {
+                    format = candidate;
+                    compress = true;
+                }
+            }
+            if (!compress)
+                return usage();
+        }
+        else if (argument.size() > 1 && argument[0] == '-')
+            return usage();
+        else
+            inputs.push_back(argument);
+    }
+    if (inputs.empty())
+        return usage();
+
+    int failed = 0;
+    for (const std::string &input : inputs)
+    {
+        std::filesystem::path output = std::filesystem::path(input).replace_extension(".gltex");
+        if (!outputDirectory.empty())
+            output = std::filesystem::path(outputDirectory) / output.filename();
+        if (!pack(input, output.string(), flip, linear, compress, format))
+            failed++;
+    }
+    return failed ? 1 : 0;
+}
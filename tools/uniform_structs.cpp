@@ -0,0 +1,498 @@
+// Generates C++ structs mirroring the uniforms of GLSL programs, so a whole set of uniforms is
+// filled as plain C++ members and uploaded with one Shader::set() call (see includes/uniform_struct.h).
+// A misspelled or mistyped member is then a compile error instead of a silently ignored glUniform.
+//
+// The programs to generate are listed in tools/uniform_structs.txt, one per line:
+//
+//   <StructName> <shader file>... [-D<FEATURE>]...
+//
+// Run it from the repository root whenever one of those shaders changes:
+//
+//   g++ -std=c++17 -O2 tools/uniform_structs.cpp -o uniform_structs
+//   ./uniform_structs includes/shader_uniforms_data.h tools/uniform_structs.txt
+//
+// Default-block uniforms become members of <StructName>, GLSL structs become nested structs.
+// Uniform blocks become <BlockName>UniformBlock structs laid out by the std140 rules, for
+// filling uniform buffers directly.
+
+#include "../includes/shader_preprocessor.h"
+
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct GlslType
+{
+    const char *glsl;
+    const char *cpp;     // member type in the generated struct
+    const char *glEnum;  // what glGetActiveUniform reports
+    size_t align;        // std140 base alignment, 0 where a uniform block member isn't supported
+    size_t size;         // std140 size
+};
+
+// bools and samplers are set through glUniform1i, so they are ints on the C++ side
+static const GlslType TYPES[] = {
+    { "float", "float", "GL_FLOAT", 4, 4 },
+    { "int", "int", "GL_INT", 4, 4 },
+    { "bool", "int", "GL_BOOL", 4, 4 },
+    { "vec2", "glm::vec2", "GL_FLOAT_VEC2", 8, 8 },
+    { "vec3", "glm::vec3", "GL_FLOAT_VEC3", 16, 12 },
+    { "vec4", "glm::vec4", "GL_FLOAT_VEC4", 16, 16 },
+    { "mat3", "glm::mat3", "GL_FLOAT_MAT3", 0, 0 },
+    { "mat4", "glm::mat4", "GL_FLOAT_MAT4", 16, 64 },
+    { "sampler2D", "int", "GL_SAMPLER_2D", 0, 0 },
+    { "sampler3D", "int", "GL_SAMPLER_3D", 0, 0 },
+    { "samplerCube", "int", "GL_SAMPLER_CUBE", 0, 0 },
+    { "sampler2DArray", "int", "GL_SAMPLER_2D_ARRAY", 0, 0 },
+};
+
+static const GlslType *findType(const std::string &name)
+{
+    for (const GlslType &type : TYPES)
+        if (name == type.glsl)
+            return &type;
+    return nullptr;
+}
+
+struct Member
+{
+    std::string type;  // GLSL type name, a builtin or a struct
+    std::string name;
+    int count = 0;     // array length, 0 when not an array
+};
+
+struct UniformBlock
+{
+    std::string name;
+    std::vector<Member> members;
+    std::string origin;
+};
+
+struct ParsedProgram
+{
+    std::map<std::string, std::vector<Member>> structs;
+    std::vector<std::string> structOrder;
+    std::vector<Member> uniforms;
+    std::vector<UniformBlock> blocks;
+};
+
+static bool failed = false;
+
+static void error(const std::string &what, const std::string &where)
+{
+    std::cout << "ERROR::UNIFORM_STRUCTS::" << what << ": " << where << std::endl;
+    failed = true;
+}
+
+// keep only the lines the GLSL preprocessor would keep for these defines. handles #ifdef, #ifndef,
+// #if [!]defined(X) && ..., #else and #endif, which is all the shaders here use
+// ------------------------------------------------------------------------
+static std::string evaluateConditionals(const std::string &source, std::set<std::string> defines, const std::string &path)
+{
+    std::istringstream in(source);
+    std::ostringstream out;
+    std::vector<bool> active; // per nesting level: is the current branch taken
+    std::vector<bool> parent;
+    std::string line;
+    while (std::getline(in, line))
+    {
+        std::istringstream words(line);
+        std::string directive, name;
+        words >> directive >> name;
+        bool enabled = active.empty() || active.back();
+        if (directive == "#ifdef" || directive == "#ifndef" || directive == "#if")
+        {
+            bool taken = true;
+            if (directive == "#if")
+            {
+                // [!]defined(X) terms joined by &&
+                std::string term;
+                std::istringstream terms(line.substr(line.find("#if") + 3));
+                while (terms >> term)
+                {
+                    if (term == "&&")
+                        continue;
+                    bool negate = term.compare(0, 1, "!") == 0;
+                    std::string inner = term.substr(negate ? 1 : 0);
+                    if (inner.compare(0, 8, "defined(") != 0 || inner.back() != ')')
+                    {
+                        error("UNSUPPORTED_CONDITION", path + ": " + line);
+                        inner = "defined()";
+                    }
+                    taken = taken && defines.count(inner.substr(8, inner.size() - 9)) != (size_t)negate;
+                }
+            }
+            else
+                taken = defines.count(name) ? directive == "#ifdef" : directive == "#ifndef";
+            parent.push_back(enabled);
+            active.push_back(enabled && taken);
+        }
+        else if (directive == "#else" && !active.empty())
+            active.back() = parent.back() && !active.back();
+        else if (directive == "#endif" && !active.empty())
+        {
+            active.pop_back();
+            parent.pop_back();
+        }
+        else if (enabled)
+        {
+            if (directive == "#define")
+                defines.insert(name);
+            if (!directive.empty() && directive[0] != '#')
+                out << line;
+            out << "\n";
+        }
+    }
+    return out.str();
+}
+
+// ------------------------------------------------------------------------
+static std::vector<std::string> tokenize(const std::string &source)
+{
+    std::vector<std::string> tokens;
+    for (size_t i = 0; i < source.size();)
+    {
+        char c = source[i];
+        if (std::isspace((unsigned char)c))
+            i++;
+        else if (source.compare(i, 2, "//") == 0)
+            i = source.find('\n', i) == std::string::npos ? source.size() : source.find('\n', i);
+        else if (source.compare(i, 2, "/*") == 0)
+            i = source.find("*/", i) == std::string::npos ? source.size() : source.find("*/", i) + 2;
+        else if (std::isalnum((unsigned char)c) || c == '_')
+        {
+            size_t start = i;
+            while (i < source.size() && (std::isalnum((unsigned char)source[i]) || source[i] == '_' || source[i] == '.'))
+                i++;
+            tokens.push_back(source.substr(start, i - start));
+        }
+        else
+            tokens.push_back(std::string(1, source[i++]));
+    }
+    return tokens;
+}
+
+static bool isQualifier(const std::string &token)
+{
+    return token == "lowp" || token == "mediump" || token == "highp" || token == "flat" || token == "const";
+}
+
+// "type name[, name[N]]... ;" starting at tokens[i], appended to members. returns the index after the ';'
+// ------------------------------------------------------------------------
+static size_t parseDeclaration(const std::vector<std::string> &tokens, size_t i, std::vector<Member> &members)
+{
+    while (i < tokens.size() && isQualifier(tokens[i]))
+        i++;
+    if (i >= tokens.size())
+        return i;
+    std::string type = tokens[i++];
+    while (i < tokens.size() && tokens[i] != ";")
+    {
+        Member member;
+        member.type = type;
+        member.name = tokens[i++];
+        if (i + 2 < tokens.size() && tokens[i] == "[")
+        {
+            member.count = std::atoi(tokens[i + 1].c_str());
+            i += 3;
+        }
+        members.push_back(member);
+        if (i < tokens.size() && tokens[i] == ",")
+            i++;
+    }
+    return i + 1;
+}
+
+// skip a balanced (), {} or [] group starting at tokens[i]
+static size_t skipGroup(const std::vector<std::string> &tokens, size_t i)
+{
+    std::string open = tokens[i], close = open == "(" ? ")" : open == "{" ? "}" : "]";
+    int depth = 0;
+    for (; i < tokens.size(); i++)
+    {
+        if (tokens[i] == open)
+            depth++;
+        else if (tokens[i] == close && --depth == 0)
+            return i + 1;
+    }
+    return i;
+}
+
+// collect struct definitions, default-block uniforms and uniform blocks at global scope
+// ------------------------------------------------------------------------
+static void parse(const std::string &source, const std::string &path, ParsedProgram &program)
+{
+    std::vector<std::string> tokens = tokenize(source);
+    size_t i = 0;
+    while (i < tokens.size())
+    {
+        if (tokens[i] == "layout" && i + 1 < tokens.size() && tokens[i + 1] == "(")
+        {
+            i = skipGroup(tokens, i + 1);
+            continue;
+        }
+        if (tokens[i] == "struct" && i + 2 < tokens.size() && tokens[i + 2] == "{")
+        {
+            std::string name = tokens[i + 1];
+            std::vector<Member> members;
+            i += 3;
+            while (i < tokens.size() && tokens[i] != "}")
+                i = parseDeclaration(tokens, i, members);
+            i += 2; // "};"
+            if (!program.structs.count(name))
+                program.structOrder.push_back(name);
+            program.structs[name] = members;
+            continue;
+        }
+        if (tokens[i] == "uniform" && i + 2 < tokens.size())
+        {
+            if (tokens[i + 2] == "{")
+            {
+                UniformBlock block;
+                block.name = tokens[i + 1];
+                block.origin = path;
+                i += 3;
+                while (i < tokens.size() && tokens[i] != "}")
+                    i = parseDeclaration(tokens, i, block.members);
+                i++;
+                while (i < tokens.size() && tokens[i] != ";")
+                    i++; // optional instance name
+                i++;
+                program.blocks.push_back(block);
+            }
+            else
+                i = parseDeclaration(tokens, i + 1, program.uniforms);
+            continue;
+        }
+        // anything else (in/out variables, functions): skip to the end of the statement or body
+        while (i < tokens.size() && tokens[i] != ";" && tokens[i] != "{")
+            i = tokens[i] == "(" || tokens[i] == "[" ? skipGroup(tokens, i) : i + 1;
+        i = i < tokens.size() && tokens[i] == "{" ? skipGroup(tokens, i) : i + 1;
+    }
+}
+
+// ------------------------------------------------------------------------
+static std::string arraySuffix(const Member &member)
+{
+    return member.count ? "[" + std::to_string(member.count) + "]" : "";
+}
+
+// every leaf uniform under member, with the name glGetActiveUniform reports and an offsetof expression
+static void emitFields(std::ostream &out, const ParsedProgram &program, const Member &member, const std::string &owner,
+                       const std::string &prefix, const std::string &offset, const std::string &where)
+{
+    int elements = member.count ? member.count : 1;
+    for (int element = 0; element < elements; element++)
+    {
+        std::string name = prefix + member.name + (member.count ? "[" + std::to_string(element) + "]" : "");
+        std::string at = offset + "offsetof(" + owner + ", " + member.name + ")";
+        if (member.count)
+            at += " + " + std::to_string(element) + " * sizeof(" + owner + "::" + member.name + "[0])";
+        const GlslType *type = findType(member.type);
+        if (type)
+        {
+            out << "        { \"" << name << "\", " << type->glEnum << ", " << at << " },\n";
+            continue;
+        }
+        auto nested = program.structs.find(member.type);
+        if (nested == program.structs.end())
+        {
+            error("UNKNOWN_TYPE", where + ": " + member.type + " " + member.name);
+            continue;
+        }
+        std::string nestedOwner = owner.substr(0, owner.find("::")) + "::" + member.type;
+        for (const Member &field : nested->second)
+            emitFields(out, program, field, nestedOwner, name + ".", at + " + ", where);
+    }
+}
+
+// ------------------------------------------------------------------------
+static void emitProgram(std::ostream &out, const std::string &name, const ParsedProgram &program, const std::string &origin)
+{
+    // only the GLSL structs some uniform is made of, helper structs of the shader code are left out
+    std::set<std::string> used;
+    std::vector<std::string> pending;
+    for (const Member &uniform : program.uniforms)
+        pending.push_back(uniform.type);
+    while (!pending.empty())
+    {
+        std::string type = pending.back();
+        pending.pop_back();
+        auto found = program.structs.find(type);
+        if (found == program.structs.end() || !used.insert(type).second)
+            continue;
+        for (const Member &member : found->second)
+            pending.push_back(member.type);
+    }
+    out << "// " << origin << "\n"
+        << "struct " << name << "\n{\n";
+    for (const std::string &structName : program.structOrder)
+    {
+        if (!used.count(structName))
+            continue;
+        out << "    struct " << structName << "\n    {\n";
+        for (const Member &member : program.structs.at(structName))
+        {
+            const GlslType *type = findType(member.type);
+            out << "        " << (type ? type->cpp : member.type.c_str()) << " " << member.name << arraySuffix(member) << ";"
+                << (type && std::string(type->cpp) == "int" && member.type != "int" ? " // " + member.type : "") << "\n";
+        }
+        out << "    };\n";
+    }
+    for (const Member &uniform : program.uniforms)
+    {
+        const GlslType *type = findType(uniform.type);
+        out << "    " << (type ? type->cpp : uniform.type.c_str()) << " " << uniform.name << arraySuffix(uniform) << ";"
+            << (type && std::string(type->cpp) == "int" && uniform.type != "int" ? " // " + uniform.type : "") << "\n";
+    }
+    out << "};\n"
+        << "template<> struct UniformStruct<" << name << ">\n{\n"
+        << "    static constexpr UniformField fields[] = {\n";
+    for (const Member &uniform : program.uniforms)
+        emitFields(out, program, uniform, name, "", "", origin);
+    out << "    };\n};\n\n";
+}
+
+// std140: every member at a multiple of its base alignment, arrays and structs rounded up to vec4
+// ------------------------------------------------------------------------
+static void emitBlock(std::ostream &out, const UniformBlock &block)
+{
+    std::string name = block.name + "UniformBlock";
+    std::ostringstream members, checks;
+    size_t offset = 0;
+    int padding = 0;
+    for (const Member &member : block.members)
+    {
+        const GlslType *type = findType(member.type);
+        if (!type || type->align == 0)
+        {
+            error("UNSUPPORTED_BLOCK_MEMBER", block.origin + ": " + member.type + " " + member.name);
+            continue;
+        }
+        // array elements are padded to a vec4, use a vec4 array for anything smaller
+        bool widened = member.count && type->size < 16;
+        size_t align = member.count ? 16 : type->align;
+        size_t size = member.count ? member.count * (widened ? 16 : type->size) : type->size;
+        size_t aligned = (offset + align - 1) / align * align;
+        for (; offset < aligned; offset += 4)
+            members << "    float pad" << padding++ << ";\n";
+        members << "    " << (widened ? "glm::vec4" : type->cpp) << " " << member.name << arraySuffix(member) << ";"
+                << (widened ? " // " + member.type + "[], std140 pads elements to 16 bytes" : "") << "\n";
+        checks << "static_assert(offsetof(" << name << ", " << member.name << ") == " << offset
+               << ", \"std140 offset of " << block.name << "." << member.name << "\");\n";
+        offset += size;
+    }
+    for (size_t end = (offset + 15) / 16 * 16; offset < end; offset += 4)
+        members << "    float pad" << padding++ << ";\n";
+    out << "// std140 layout of uniform block " << block.name << " (" << block.origin << ")\n"
+        << "struct " << name << "\n{\n" << members.str() << "};\n"
+        << checks.str()
+        << "static_assert(sizeof(" << name << ") == " << offset << ", \"std140 size of " << block.name << "\");\n\n";
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        std::cout << "usage: uniform_structs <output header> <list file>" << std::endl;
+        return 1;
+    }
+    std::ifstream list(argv[2]);
+    if (!list)
+    {
+        std::cout << "ERROR::UNIFORM_STRUCTS::CANNOT_READ: " << argv[2] << std::endl;
+        return 1;
+    }
+
+    std::ostringstream programs, blocks;
+    std::map<std::string, std::string> blockLayouts; // name -> member list, a block must be declared alike everywhere
+    std::string line;
+    int generated = 0;
+    while (std::getline(list, line))
+    {
+        std::istringstream words(line);
+        std::string name, word;
+        if (!(words >> name) || name[0] == '#')
+            continue;
+        std::vector<std::string> files;
+        std::set<std::string> defines;
+        while (words >> word)
+        {
+            if (word.compare(0, 2, "-D") == 0)
+                defines.insert(word.substr(2));
+            else
+                files.push_back(word);
+        }
+
+        ParsedProgram program;
+        for (const std::string &file : files)
+        {
+            ParsedProgram stage;
+            std::string source = ShaderPreprocessor::load(file, {});
+            parse(evaluateConditionals(source, defines, file), file, stage);
+            for (const std::string &structName : stage.structOrder)
+            {
+                if (!program.structs.count(structName))
+                    program.structOrder.push_back(structName);
+                program.structs[structName] = stage.structs[structName];
+            }
+            // a uniform declared in several stages is one uniform of the program
+            for (const Member &uniform : stage.uniforms)
+            {
+                bool known = false;
+                for (const Member &existing : program.uniforms)
+                {
+                    if (existing.name != uniform.name)
+                        continue;
+                    known = true;
+                    if (existing.type != uniform.type || existing.count != uniform.count)
+                        error("CONFLICTING_UNIFORM", file + ": " + uniform.name);
+                }
+                if (!known)
+                    program.uniforms.push_back(uniform);
+            }
+            for (const UniformBlock &block : stage.blocks)
+            {
+                std::string layout;
+                for (const Member &member : block.members)
+                    layout += member.type + " " + member.name + arraySuffix(member) + ";";
+                if (blockLayouts.count(block.name))
+                {
+                    if (blockLayouts[block.name] != layout)
+                        error("CONFLICTING_BLOCK", file + ": " + block.name);
+                    continue;
+                }
+                blockLayouts[block.name] = layout;
+                emitBlock(blocks, block);
+            }
+        }
+        std::string origin = line.substr(line.find(name) + name.size() + 1);
+        emitProgram(programs, name, program, origin);
+        generated++;
+    }
+    if (failed)
+        return 1;
+
+    std::ofstream out(argv[1], std::ios::trunc);
+    if (!out)
+    {
+        std::cout << "ERROR::UNIFORM_STRUCTS::CANNOT_WRITE: " << argv[1] << std::endl;
+        return 1;
+    }
+    out << "// generated by tools/uniform_structs.cpp from tools/uniform_structs.txt - do not edit, rerun the tool instead\n"
+           "#ifndef SHADER_UNIFORMS_DATA_H\n"
+           "#define SHADER_UNIFORMS_DATA_H\n\n"
+           "#include <glad/glad.h>\n"
+           "#include <../includes/glm/glm/glm.hpp>\n"
+           "#include <../includes/uniform_struct.h>\n\n"
+           "#include <cstddef>\n\n"
+        << blocks.str() << programs.str() << "#endif\n";
+    std::cout << "generated " << generated << " uniform structs and " << blockLayouts.size() << " uniform blocks into "
+              << argv[1] << std::endl;
+    return 0;
+}